@@ -31,6 +31,7 @@
 #include "kernel/json.h"
 #include "kernel/yw.h"
 #include "kernel/utils.h"
+#include "kernel/strash.h"
 #include <string>
 
 USING_YOSYS_NAMESPACE
@@ -45,6 +46,7 @@ struct BtorWorker
 	bool single_bad;
 	bool cover_mode;
 	bool print_internal_names;
+	bool coi_mode;
 
 	int next_nid = 1;
 	int initstate_nid = -1;
@@ -67,6 +69,9 @@ struct BtorWorker
 	// bit to driving cell
 	dict<SigBit, Cell*> bit_cell;
 
+	// cells that duplicate another cell (-coi)
+	pool<Cell*> strash_duplicates;
+
 	// nids for constants
 	dict<Const, int> consts;
 
@@ -82,6 +87,9 @@ struct BtorWorker
 	vector<Mem> memories;
 	dict<Cell*, Mem*> mem_cells;
 
+	// output is collected here and written in large chunks
+	string buffer;
+
 	string indent, info_filename;
 	vector<string> info_lines;
 	dict<int, int> info_clocks;
@@ -102,11 +110,25 @@ struct BtorWorker
 
 	PrettyJson ywmap_json;
 
+	void flush_buffer()
+	{
+		f.write(buffer.data(), buffer.size());
+		buffer.clear();
+	}
+
+	void write_line(const string &str)
+	{
+		buffer += indent;
+		buffer += str;
+		if (buffer.size() >= (1 << 20))
+			flush_buffer();
+	}
+
 	void btorf(const char *fmt, ...) YS_ATTRIBUTE(format(printf, 2, 3))
 	{
 		va_list ap;
 		va_start(ap, fmt);
-		f << indent << vstringf(fmt, ap);
+		write_line(vstringf(fmt, ap));
 		va_end(ap);
 	}
 
@@ -192,7 +214,7 @@ struct BtorWorker
 	void btorf_push(const string &id)
 	{
 		if (verbose) {
-			f << indent << stringf("  ; begin %s\n", id.c_str());
+			write_line(stringf("  ; begin %s\n", id.c_str()));
 			indent += "    ";
 		}
 	}
@@ -201,7 +223,7 @@ struct BtorWorker
 	{
 		if (verbose) {
 			indent = indent.substr(4);
-			f << indent << stringf("  ; end %s\n", id.c_str());
+			write_line(stringf("  ; end %s\n", id.c_str()));
 		}
 	}
 
@@ -231,7 +253,7 @@ struct BtorWorker
 	void add_nid_sig(int nid, const SigSpec &sig)
 	{
 		if (verbose)
-			f << indent << stringf("; %d %s\n", nid, log_signal(sig));
+			write_line(stringf("; %d %s\n", nid, log_signal(sig)));
 
 		for (int i = 0; i < GetSize(sig); i++)
 			bit_nid[sig[i]] = make_pair(nid, i);
@@ -1163,9 +1185,49 @@ struct BtorWorker
 		return nid;
 	}
 
-	BtorWorker(std::ostream &f, RTLIL::Module *module, bool verbose, bool single_bad, bool cover_mode, bool print_internal_names, string info_filename, string ywmap_filename) :
-			f(f), sigmap(module), module(module), verbose(verbose), single_bad(single_bad), cover_mode(cover_mode), print_internal_names(print_internal_names), info_filename(info_filename)
+	// true if all bits of sig have already been exported
+	bool sig_exported(const SigSpec &sig)
+	{
+		for (auto bit : sigmap(sig))
+			if (bit.wire != nullptr && bit_nid.count(bit) == 0)
+				return false;
+		return true;
+	}
+
+	void export_output(Wire *wire)
 	{
+		btorf_push(stringf("output %s", log_id(wire)));
+
+		int nid = get_sig_nid(wire);
+		btorf("%d output %d%s\n", next_nid++, nid, getinfo(wire).c_str());
+
+		btorf_pop(stringf("output %s", log_id(wire)));
+	}
+
+	void export_wire(Wire *wire)
+	{
+		btorf_push(stringf("wire %s", log_id(wire)));
+
+		int sid = get_bv_sid(GetSize(wire));
+		int nid = get_sig_nid(sigmap(wire));
+
+		if (statewires.count(wire))
+			return;
+
+		int this_nid = next_nid++;
+		btorf("%d uext %d %d %d%s\n", this_nid, sid, nid, 0, getinfo(wire).c_str());
+		if (info_clocks.count(nid))
+			info_clocks[this_nid] |= info_clocks[nid];
+
+		btorf_pop(stringf("wire %s", log_id(wire)));
+	}
+
+	BtorWorker(std::ostream &f, RTLIL::Module *module, bool verbose, bool single_bad, bool cover_mode, bool print_internal_names, bool coi_mode, string info_filename, string ywmap_filename) :
+			f(f), sigmap(module), module(module), verbose(verbose), single_bad(single_bad), cover_mode(cover_mode), print_internal_names(print_internal_names), coi_mode(coi_mode), info_filename(info_filename)
+	{
+		if (coi_mode)
+			strash_duplicates = strash_cells(module, sigmap);
+
 		if (!info_filename.empty())
 			infof("name %s\n", log_id(module));
 
@@ -1245,25 +1307,19 @@ struct BtorWorker
 		for (auto cell : module->cells())
 		for (auto &conn : cell->connections())
 		{
-			if (!cell->output(conn.first))
+			if (!cell->output(conn.first) || strash_duplicates.count(cell))
 				continue;
 
 			for (auto bit : sigmap(conn.second))
 				bit_cell[bit] = cell;
 		}
 
-		for (auto wire : module->wires())
-		{
-			if (!wire->port_id || !wire->port_output)
-				continue;
-
-			btorf_push(stringf("output %s", log_id(wire)));
-
-			int nid = get_sig_nid(wire);
-			btorf("%d output %d%s\n", next_nid++, nid, getinfo(wire).c_str());
-
-			btorf_pop(stringf("output %s", log_id(wire)));
-		}
+		// with -coi, outputs and named wires are only exported further
+		// below if the properties already pulled in their drivers
+		if (!coi_mode)
+			for (auto wire : module->wires())
+				if (wire->port_id && wire->port_output)
+					export_output(wire);
 
 		for (auto cell : module->cells())
 		{
@@ -1334,27 +1390,10 @@ struct BtorWorker
 			}
 		}
 
-		for (auto wire : module->wires())
-		{
-			if (wire->port_id || wire->name[0] == '$')
-				continue;
-
-			btorf_push(stringf("wire %s", log_id(wire)));
-
-			int sid = get_bv_sid(GetSize(wire));
-			int nid = get_sig_nid(sigmap(wire));
-
-			if (statewires.count(wire))
-				continue;
-
-			int this_nid = next_nid++;
-			btorf("%d uext %d %d %d%s\n", this_nid, sid, nid, 0, getinfo(wire).c_str());
-			if (info_clocks.count(nid))
-				info_clocks[this_nid] |= info_clocks[nid];
-
-			btorf_pop(stringf("wire %s", log_id(wire)));
-			continue;
-		}
+		if (!coi_mode)
+			for (auto wire : module->wires())
+				if (!wire->port_id && wire->name[0] != '$')
+					export_wire(wire);
 
 		while (!ff_todo.empty() || !mem_todo.empty())
 		{
@@ -1436,6 +1475,17 @@ struct BtorWorker
 			}
 		}
 
+		if (coi_mode)
+		{
+			for (auto wire : module->wires())
+				if (wire->port_id && wire->port_output && sig_exported(wire))
+					export_output(wire);
+
+			for (auto wire : module->wires())
+				if (!wire->port_id && wire->name[0] != '$' && sig_exported(wire))
+					export_wire(wire);
+		}
+
 		while (!bad_properties.empty())
 		{
 			vector<int> todo;
@@ -1466,6 +1516,8 @@ struct BtorWorker
 			}
 		}
 
+		flush_buffer();
+
 		if (!info_filename.empty())
 		{
 			for (auto &it : info_clocks)
@@ -1561,10 +1613,15 @@ struct BtorBackend : public Backend {
 		log("  -ywmap <filename>\n");
 		log("    Create a map file for conversion to and from Yosys witness traces\n");
 		log("\n");
+		log("  -coi\n");
+		log("    Only output the logic in the cone of influence of the asserts, assumes\n");
+		log("    and covers, and share identical combinational cells. Outputs and named\n");
+		log("    wires are only included if their value is computed anyway.\n");
+		log("\n");
 	}
 	void execute(std::ostream *&f, std::string filename, std::vector<std::string> args, RTLIL::Design *design) override
 	{
-		bool verbose = false, single_bad = false, cover_mode = false, print_internal_names = false;
+		bool verbose = false, single_bad = false, cover_mode = false, print_internal_names = false, coi_mode = false;
 		string info_filename;
 		string ywmap_filename;
 
@@ -1603,6 +1660,10 @@ struct BtorBackend : public Backend {
 				ywmap_filename = args[++argidx];
 				continue;
 			}
+			if (args[argidx] == "-coi") {
+				coi_mode = true;
+				continue;
+			}
 			break;
 		}
 		extra_args(f, filename, args, argidx);
@@ -1615,7 +1676,7 @@ struct BtorBackend : public Backend {
 		*f << stringf("; BTOR description generated by %s for module %s.\n",
 				yosys_maybe_version(), log_id(topmod));
 
-		BtorWorker(*f, topmod, verbose, single_bad, cover_mode, print_internal_names, info_filename, ywmap_filename);
+		BtorWorker(*f, topmod, verbose, single_bad, cover_mode, print_internal_names, coi_mode, info_filename, ywmap_filename);
 
 		*f << stringf("; end of yosys output\n");
 	}
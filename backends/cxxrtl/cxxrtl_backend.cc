@@ -712,6 +712,14 @@ bool is_valid_clock(const RTLIL::SigSpec& sig) {
 	return sig.is_chunk() && sig.is_bit() && sig[0].wire;
 }
 
+// A contiguous range of the schedule that is evaluated by a separate function, together with the wires its nodes refer to.
+// Only the partition with side effects calls into submodules and the performer; the others may run on worker threads.
+struct EvalPartition {
+	int begin, end;
+	bool effects;
+	pool<const RTLIL::Wire*> wires;
+};
+
 struct CxxrtlWorker {
 	bool split_intf = false;
 	std::string intf_filename;
@@ -738,6 +746,8 @@ struct CxxrtlWorker {
 	bool debug_alias = false;
 	bool debug_eval = false;
 
+	int parallel_eval_nodes = 0;
+
 	std::ostringstream f;
 	std::string indent;
 	int temporary = 0;
@@ -753,6 +763,8 @@ struct CxxrtlWorker {
 	dict<RTLIL::SigBit, bool> bit_has_state;
 	dict<const RTLIL::Module*, pool<std::string>> blackbox_specializations;
 	dict<const RTLIL::Module*, bool> eval_converges;
+	dict<const RTLIL::Module*, std::vector<EvalPartition>> eval_partitions;
+	pool<std::string> used_edge_flags;
 
 	void inc_indent() {
 		indent += "\t";
@@ -859,6 +871,13 @@ struct CxxrtlWorker {
 		return mangle(sigbit.wire) + "_" + std::to_string(sigbit.offset);
 	}
 
+	std::string edge_flag(bool posedge, RTLIL::SigBit sigbit)
+	{
+		std::string flag = (posedge ? "posedge_" : "negedge_") + mangle(sigbit);
+		used_edge_flags.insert(flag);
+		return flag;
+	}
+
 	std::vector<std::string> template_param_names(const RTLIL::Module *module)
 	{
 		if (!module->has_attribute(ID(cxxrtl_template)))
@@ -1425,8 +1444,7 @@ struct CxxrtlWorker {
 				RTLIL::SigBit clk_bit = cell->getPort(ID::CLK)[0];
 				clk_bit = sigmaps[clk_bit.wire->module](clk_bit);
 				if (clk_bit.wire) {
-					f << indent << "if (" << (cell->getParam(ID::CLK_POLARITY).as_bool() ? "posedge_" : "negedge_")
-					            << mangle(clk_bit) << ") {\n";
+					f << indent << "if (" << edge_flag(cell->getParam(ID::CLK_POLARITY).as_bool(), clk_bit) << ") {\n";
 				} else {
 					f << indent << "if (false) {\n";
 				}
@@ -1734,16 +1752,16 @@ struct CxxrtlWorker {
 			switch (sync->type) {
 				case RTLIL::STp:
 					log_assert(sync_bit.wire != nullptr);
-					events.insert("posedge_" + mangle(sync_bit));
+					events.insert(edge_flag(true, sync_bit));
 					break;
 				case RTLIL::STn:
 					log_assert(sync_bit.wire != nullptr);
-					events.insert("negedge_" + mangle(sync_bit));
+					events.insert(edge_flag(false, sync_bit));
 					break;
 				case RTLIL::STe:
 					log_assert(sync_bit.wire != nullptr);
-					events.insert("posedge_" + mangle(sync_bit));
-					events.insert("negedge_" + mangle(sync_bit));
+					events.insert(edge_flag(true, sync_bit));
+					events.insert(edge_flag(false, sync_bit));
 					break;
 
 				case RTLIL::STa:
@@ -1810,11 +1828,7 @@ struct CxxrtlWorker {
 			if (i != 0)
 				f << " || ";
 
-			if (trg_polarity[i] == State::S1)
-				f << "posedge_";
-			else
-				f << "negedge_";
-			f << mangle(trg_bit);
+			f << edge_flag(trg_polarity[i] == State::S1, trg_bit);
 		}
 		f << ") {\n";
 		inc_indent();
@@ -1846,8 +1860,7 @@ struct CxxrtlWorker {
 			RTLIL::SigBit clk_bit = port.clk[0];
 			clk_bit = sigmaps[clk_bit.wire->module](clk_bit);
 			if (clk_bit.wire) {
-				f << indent << "if (" << (port.clk_polarity ? "posedge_" : "negedge_")
-					    << mangle(clk_bit) << ") {\n";
+				f << indent << "if (" << edge_flag(port.clk_polarity, clk_bit) << ") {\n";
 			} else {
 				f << indent << "if (false) {\n";
 			}
@@ -1992,8 +2005,7 @@ struct CxxrtlWorker {
 				RTLIL::SigBit clk_bit = port.clk[0];
 				clk_bit = sigmaps[clk_bit.wire->module](clk_bit);
 				if (clk_bit.wire) {
-					f << indent << "if (" << (port.clk_polarity ? "posedge_" : "negedge_")
-					            << mangle(clk_bit) << ") {\n";
+					f << indent << "if (" << edge_flag(port.clk_polarity, clk_bit) << ") {\n";
 				} else {
 					f << indent << "if (false) {\n";
 				}
@@ -2172,62 +2184,106 @@ struct CxxrtlWorker {
 		dec_indent();
 	}
 
+	void dump_edge_flags(RTLIL::Module *module, const pool<std::string> *used_flags = nullptr)
+	{
+		for (auto wire : module->wires()) {
+			if (edge_wires[wire]) {
+				for (auto edge_type : edge_types) {
+					if (edge_type.first.wire == wire) {
+						std::string posedge_flag = "posedge_" + mangle(edge_type.first);
+						std::string negedge_flag = "negedge_" + mangle(edge_type.first);
+						if (edge_type.second != RTLIL::STn && (!used_flags || used_flags->count(posedge_flag))) {
+							f << indent << "bool " << posedge_flag << " = ";
+							f << "this->" << posedge_flag << "();\n";
+						}
+						if (edge_type.second != RTLIL::STp && (!used_flags || used_flags->count(negedge_flag))) {
+							f << indent << "bool " << negedge_flag << " = ";
+							f << "this->" << negedge_flag << "();\n";
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void dump_eval_node(FlowGraph::Node node)
+	{
+		switch (node.type) {
+			case FlowGraph::Node::Type::CONNECT:
+				dump_connect(node.connect);
+				break;
+			case FlowGraph::Node::Type::CELL_SYNC:
+				dump_cell_sync(node.cell);
+				break;
+			case FlowGraph::Node::Type::CELL_EVAL:
+				dump_cell_eval(node.cell);
+				break;
+			case FlowGraph::Node::Type::EFFECT_SYNC:
+				dump_cell_effect_sync(node.cells);
+				break;
+			case FlowGraph::Node::Type::PROCESS_CASE:
+				dump_process_case(node.process);
+				break;
+			case FlowGraph::Node::Type::PROCESS_SYNC:
+				dump_process_syncs(node.process);
+				break;
+			case FlowGraph::Node::Type::MEM_RDPORT:
+				dump_mem_rdport(node.mem, node.portidx);
+				break;
+			case FlowGraph::Node::Type::MEM_WRPORTS:
+				dump_mem_wrports(node.mem);
+				break;
+		}
+	}
+
 	void dump_eval_method(RTLIL::Module *module)
 	{
 		inc_indent();
 			f << indent << "bool converged = " << (eval_converges.at(module) ? "true" : "false") << ";\n";
 			if (!module->get_bool_attribute(ID(cxxrtl_blackbox))) {
-				for (auto wire : module->wires()) {
-					if (edge_wires[wire]) {
-						for (auto edge_type : edge_types) {
-							if (edge_type.first.wire == wire) {
-								if (edge_type.second != RTLIL::STn) {
-									f << indent << "bool posedge_" << mangle(edge_type.first) << " = ";
-									f << "this->posedge_" << mangle(edge_type.first) << "();\n";
-								}
-								if (edge_type.second != RTLIL::STp) {
-									f << indent << "bool negedge_" << mangle(edge_type.first) << " = ";
-									f << "this->negedge_" << mangle(edge_type.first) << "();\n";
-								}
-							}
-						}
-					}
-				}
-				for (auto wire : module->wires())
-					dump_wire(wire, /*is_local=*/true);
-				for (auto node : schedule[module]) {
-					switch (node.type) {
-						case FlowGraph::Node::Type::CONNECT:
-							dump_connect(node.connect);
-							break;
-						case FlowGraph::Node::Type::CELL_SYNC:
-							dump_cell_sync(node.cell);
-							break;
-						case FlowGraph::Node::Type::CELL_EVAL:
-							dump_cell_eval(node.cell);
-							break;
-						case FlowGraph::Node::Type::EFFECT_SYNC:
-							dump_cell_effect_sync(node.cells);
-							break;
-						case FlowGraph::Node::Type::PROCESS_CASE:
-							dump_process_case(node.process);
-							break;
-						case FlowGraph::Node::Type::PROCESS_SYNC:
-							dump_process_syncs(node.process);
-							break;
-						case FlowGraph::Node::Type::MEM_RDPORT:
-							dump_mem_rdport(node.mem, node.portidx);
-							break;
-						case FlowGraph::Node::Type::MEM_WRPORTS:
-							dump_mem_wrports(node.mem);
-							break;
-					}
+				if (!eval_partitions[module].empty()) {
+					// The partition with side effects (if any) is the first one, which the pool runs on the calling thread.
+					f << indent << "cxxrtl::worker_pool::shared().run(" << GetSize(eval_partitions[module]) << ", [&](size_t index) {\n";
+					inc_indent();
+						f << indent << "switch (index) {\n";
+						inc_indent();
+							for (int index = 0; index < GetSize(eval_partitions[module]); index++)
+								f << indent << "case " << index << ": eval_part_" << index << "(performer, converged); break;\n";
+						dec_indent();
+						f << indent << "}\n";
+					dec_indent();
+					f << indent << "});\n";
+				} else {
+					dump_edge_flags(module);
+					for (auto wire : module->wires())
+						dump_wire(wire, /*is_local=*/true);
+					for (auto &node : schedule[module])
+						dump_eval_node(node);
 				}
 			}
 			f << indent << "return converged;\n";
 		dec_indent();
 	}
 
+	void dump_eval_part_method(RTLIL::Module *module, int index)
+	{
+		const EvalPartition &partition = eval_partitions[module][index];
+		inc_indent();
+			// Only the edge flags that the nodes refer to are known after they are emitted.
+			std::ostringstream body;
+			f.swap(body);
+			used_edge_flags.clear();
+			for (auto wire : module->wires())
+				if (partition.wires.count(wire))
+					dump_wire(wire, /*is_local=*/true);
+			for (int i = partition.begin; i < partition.end; i++)
+				dump_eval_node(schedule[module][i]);
+			f.swap(body);
+			dump_edge_flags(module, &used_edge_flags);
+			f << body.str();
+		dec_indent();
+	}
+
 	void dump_debug_eval_method(RTLIL::Module *module)
 	{
 		inc_indent();
@@ -2724,6 +2780,8 @@ struct CxxrtlWorker {
 				f << indent << "void reset() override;\n";
 				f << "\n";
 				f << indent << "bool eval(performer *performer = nullptr) override;\n";
+				for (int index = 0; index < GetSize(eval_partitions[module]); index++)
+					f << indent << "void eval_part_" << index << "(performer *performer, bool &converged);\n";
 				f << "\n";
 				f << indent << "template<class ObserverT>\n";
 				f << indent << "bool commit(ObserverT &observer) {\n";
@@ -2766,6 +2824,12 @@ struct CxxrtlWorker {
 		f << indent << "bool " << mangle(module) << "::eval(performer *performer) {\n";
 		dump_eval_method(module);
 		f << indent << "}\n";
+		for (int index = 0; index < GetSize(eval_partitions[module]); index++) {
+			f << "\n";
+			f << indent << "void " << mangle(module) << "::eval_part_" << index << "(performer *performer, bool &converged) {\n";
+			dump_eval_part_method(module, index);
+			f << indent << "}\n";
+		}
 		if (debug_info) {
 			if (debug_eval) {
 				f << "\n";
@@ -2858,6 +2922,8 @@ struct CxxrtlWorker {
 			f << "#include \"" << basename(intf_filename) << "\"\n";
 		else
 			f << "#include <cxxrtl/cxxrtl.h>\n";
+		if (parallel_eval_nodes > 0)
+			f << "#include <cxxrtl/cxxrtl_threads.h>\n";
 		f << "\n";
 		f << "#if defined(CXXRTL_INCLUDE_CAPI_IMPL) || \\\n";
 		f << "    defined(CXXRTL_INCLUDE_VCD_CAPI_IMPL)\n";
@@ -3131,6 +3197,82 @@ struct CxxrtlWorker {
 					log("  %s\n", log_id(wire));
 			}
 
+			// Partition the flow graph into regions that have no driven wires, memories, or side effects in common. All arcs
+			// of the flow graph, feedback or not, are within a single region, and so the regions can be evaluated in any
+			// order or at the same time, each by its own function. Nodes that are dead or inlined still contribute their wires,
+			// since they may end up evaluated as a part of some other node.
+			dict<FlowGraph::Node*, int> node_regions;
+			int effects_region = -1;
+			if (parallel_eval_nodes > 0) {
+				std::vector<int> regions(node_order.size());
+				for (int i = 0; i < GetSize(regions); i++)
+					regions[i] = i;
+				auto find_region = [&](int i) {
+					while (regions[i] != i)
+						i = regions[i] = regions[regions[i]];
+					return i;
+				};
+				// The representative of a region is always its earliest node.
+				auto merge_regions = [&](int i, int j) {
+					i = find_region(i);
+					j = find_region(j);
+					if (i != j)
+						regions[max(i, j)] = min(i, j);
+				};
+
+				dict<const RTLIL::Wire*, int> wire_regions;
+				dict<RTLIL::IdString, int> memory_regions;
+				int effect_region = -1;
+				auto add_wire = [&](int i, const RTLIL::Wire *wire) {
+					// Wires that are only read (such as primary inputs) do not tie regions together.
+					if (!flow.wire_comb_defs.count(wire) && !flow.wire_sync_defs.count(wire))
+						return;
+					if (wire_regions.count(wire))
+						merge_regions(i, wire_regions[wire]);
+					else
+						wire_regions[wire] = i;
+				};
+				auto add_memory = [&](int i, RTLIL::IdString memid) {
+					if (memory_regions.count(memid))
+						merge_regions(i, memory_regions[memid]);
+					else
+						memory_regions[memid] = i;
+				};
+				for (int i = 0; i < GetSize(node_order); i++) {
+					FlowGraph::Node *node = node_order[i];
+					for (auto wire : flow.node_uses[node])
+						add_wire(i, wire);
+					for (auto wire : flow.node_comb_defs[node])
+						add_wire(i, wire);
+					for (auto wire : flow.node_sync_defs[node])
+						add_wire(i, wire);
+					if (node->mem != nullptr)
+						add_memory(i, node->mem->memid);
+					if (node->type == FlowGraph::Node::Type::PROCESS_SYNC)
+						for (auto sync : node->process->syncs) {
+							// Edge flags are sampled when a region starts evaluating, so a driven clock must be in the same region.
+							for (auto bit : sync->signal)
+								if (bit.wire != nullptr)
+									add_wire(i, bit.wire);
+							for (auto &memwr : sync->mem_write_actions)
+								add_memory(i, memwr.memid);
+						}
+					// Side effects (including those of submodules) must happen in the original order, and submodules (which may be
+					// black boxes) are only ever accessed from the thread that calls eval().
+					if ((node->type == FlowGraph::Node::Type::CELL_EVAL || node->type == FlowGraph::Node::Type::CELL_SYNC) &&
+							(!is_internal_cell(node->cell->type) || is_effectful_cell(node->cell->type))) {
+						if (effect_region != -1)
+							merge_regions(i, effect_region);
+						else
+							effect_region = i;
+					}
+				}
+				for (int i = 0; i < GetSize(node_order); i++)
+					node_regions[node_order[i]] = find_region(i);
+				if (effect_region != -1)
+					effects_region = find_region(effect_region);
+			}
+
 			// Conservatively assign wire types. Assignment of types BUFFERED and MEMBER is final, but assignment
 			// of type LOCAL may be further refined to UNUSED or INLINE.
 			for (auto wire : module->wires()) {
@@ -3219,21 +3361,60 @@ struct CxxrtlWorker {
 			// Emit reachable nodes in eval().
 			// Accumulate sync effectful cells per trigger condition.
 			dict<std::pair<RTLIL::SigSpec, RTLIL::Const>, std::vector<const RTLIL::Cell*>> effect_sync_cells;
+			std::vector<std::pair<int, FlowGraph::Node*>> region_schedule;
 			for (auto node : node_order)
 				if (live_nodes[node]) {
 					if (node->type == FlowGraph::Node::Type::CELL_EVAL &&
 							is_effectful_cell(node->cell->type) &&
 							node->cell->getParam(ID::TRG_ENABLE).as_bool() &&
-							node->cell->getParam(ID::TRG_WIDTH).as_int() != 0)
+							node->cell->getParam(ID::TRG_WIDTH).as_int() != 0) {
 						effect_sync_cells[make_pair(node->cell->getPort(ID::TRG), node->cell->getParam(ID::TRG_POLARITY))].push_back(node->cell);
-					else
-						schedule[module].push_back(*node);
+					} else
+						region_schedule.push_back({node_regions[node], node});
 				}
 
 			for (auto &it : effect_sync_cells) {
 				auto node = flow.add_effect_sync_node(it.second);
-				schedule[module].push_back(*node);
+				region_schedule.push_back({effects_region, node});
+			}
+
+			// Group the regions into tasks of roughly `parallel_eval_nodes` nodes each, keeping the order within a region.
+			// The region with side effects comes first and is the only region of its task, which runs on the calling thread.
+			if (parallel_eval_nodes > 0) {
+				std::stable_sort(region_schedule.begin(), region_schedule.end(),
+					[&](const std::pair<int, FlowGraph::Node*> &a, const std::pair<int, FlowGraph::Node*> &b) {
+						return std::make_pair(a.first != effects_region, a.first) < std::make_pair(b.first != effects_region, b.first);
+					});
+				dict<int, int> region_partitions;
+				std::vector<EvalPartition> partitions;
+				for (int i = 0; i < GetSize(region_schedule); i++) {
+					int region = region_schedule[i].first;
+					if (partitions.empty() || (region != region_schedule[i - 1].first &&
+							(partitions.back().effects || partitions.back().end - partitions.back().begin >= parallel_eval_nodes)))
+						partitions.push_back({i, i, region == effects_region, {}});
+					partitions.back().end = i + 1;
+					region_partitions[region] = GetSize(partitions) - 1;
+				}
+				if (GetSize(partitions) > 1) {
+					// Every function declares all of the local wires that are used or defined by any node of its regions.
+					for (auto node : flow.nodes) {
+						if (!node_regions.count(node) || !region_partitions.count(node_regions[node]))
+							continue;
+						auto &wires = partitions[region_partitions[node_regions[node]]].wires;
+						for (auto wire : flow.node_uses[node])
+							wires.insert(wire);
+						for (auto wire : flow.node_comb_defs[node])
+							wires.insert(wire);
+						for (auto wire : flow.node_sync_defs[node])
+							wires.insert(wire);
+					}
+					log("Module `%s' evaluates %d independent regions in %d parallel tasks.\n",
+					    log_id(module), GetSize(region_partitions), GetSize(partitions));
+					eval_partitions[module] = std::move(partitions);
+				}
 			}
+			for (auto &it : region_schedule)
+				schedule[module].push_back(*it.second);
 
 			// For maximum performance, the state of the simulation (which is the same as the set of its double buffered
 			// wires, since using a singly buffered wire for any kind of state introduces a race condition) should contain
@@ -3675,6 +3856,16 @@ struct CxxrtlBackend : public Backend {
 		log("        processes significantly improves evaluation performance at the cost of\n");
 		log("        slight increase in compilation time.\n");
 		log("\n");
+		log("    -parallel <nodes>\n");
+		log("        evaluate each module on a pool of worker threads, in tasks of about\n");
+		log("        <nodes> scheduled nodes each. only logic with no driven wires, memories,\n");
+		log("        or side effects in common is placed into different tasks, and all tasks\n");
+		log("        finish before the design is committed, so delta cycles are unchanged.\n");
+		log("        submodules, black boxes, and cells with side effects are evaluated on\n");
+		log("        the thread that calls eval(). this speeds up flattened designs made of\n");
+		log("        large independent blocks; the worker pool is declared in\n");
+		log("        <cxxrtl/cxxrtl_threads.h>, and has one thread per CPU by default.\n");
+		log("\n");
 		log("    -O <level>\n");
 		log("        set the optimization level. the default is -O%d. higher optimization\n", DEFAULT_OPT_LEVEL);
 		log("        levels dramatically decrease compile and run time, and highest level\n");
@@ -3789,6 +3980,10 @@ struct CxxrtlBackend : public Backend {
 				debug_level = std::stoi(args[argidx].substr(2));
 				continue;
 			}
+			if (args[argidx] == "-parallel" && argidx+1 < args.size()) {
+				worker.parallel_eval_nodes = std::stoi(args[++argidx]);
+				continue;
+			}
 			if (args[argidx] == "-header") {
 				worker.split_intf = true;
 				continue;
@@ -96,6 +96,10 @@ namespace cxxrtl {
 // clobbered results in simpler generated code.
 typedef uint32_t chunk_t;
 typedef uint64_t wide_chunk_t;
+#if defined(__SIZEOF_INT128__)
+// Used by multiplication of wide values, which processes two chunks at a time where the platform supports it.
+__extension__ typedef unsigned __int128 double_wide_chunk_t;
+#endif
 
 template<typename T>
 struct chunk_traits {
@@ -432,11 +436,14 @@ struct value : public expr_base<value<Bits>> {
 		if (shift_chunks >= chunks)
 			return {};
 		value<Bits> result;
-		chunk::type carry = 0;
-		for (size_t n = 0; n < chunks - shift_chunks; n++) {
-			result.data[shift_chunks + n] = (data[n] << shift_bits) | carry;
-			carry = (shift_bits == 0) ? 0
-				: data[n] >> (chunk::bits - shift_bits);
+		// Each chunk of the result only depends on the input, which lets the compiler vectorize these loops.
+		if (shift_bits == 0) {
+			for (size_t n = 0; n < chunks - shift_chunks; n++)
+				result.data[shift_chunks + n] = data[n];
+		} else {
+			result.data[shift_chunks] = data[0] << shift_bits;
+			for (size_t n = 1; n < chunks - shift_chunks; n++)
+				result.data[shift_chunks + n] = (data[n] << shift_bits) | (data[n - 1] >> (chunk::bits - shift_bits));
 		}
 		result.data[result.chunks - 1] &= result.msb_mask;
 		return result;
@@ -456,11 +463,14 @@ struct value : public expr_base<value<Bits>> {
 		if (shift_chunks >= chunks)
 			return (Signed && is_neg()) ? value<Bits>().bit_not() : value<Bits>();
 		value<Bits> result;
-		chunk::type carry = 0;
-		for (size_t n = 0; n < chunks - shift_chunks; n++) {
-			result.data[chunks - shift_chunks - 1 - n] = carry | (data[chunks - 1 - n] >> shift_bits);
-			carry = (shift_bits == 0) ? 0
-				: data[chunks - 1 - n] << (chunk::bits - shift_bits);
+		// See shl() above.
+		if (shift_bits == 0) {
+			for (size_t n = 0; n < chunks - shift_chunks; n++)
+				result.data[n] = data[shift_chunks + n];
+		} else {
+			for (size_t n = 0; n < chunks - shift_chunks - 1; n++)
+				result.data[n] = (data[shift_chunks + n] >> shift_bits) | (data[shift_chunks + n + 1] << (chunk::bits - shift_bits));
+			result.data[chunks - shift_chunks - 1] = data[chunks - 1] >> shift_bits;
 		}
 		if (Signed && is_neg()) {
 			size_t top_chunk_idx  = amount.data[0] > Bits ? 0 : (Bits - amount.data[0]) / chunk::bits;
@@ -551,15 +561,20 @@ struct value : public expr_base<value<Bits>> {
 	template<bool Invert, bool CarryIn>
 	std::pair<value<Bits>, bool /*CarryOut*/> alu(const value<Bits> &other) const {
 		value<Bits> result;
-		bool carry = CarryIn;
+		// The carry is taken from the wide sum instead of being recovered from comparisons, which keeps the dependency
+		// chain between chunks down to a single addition and a shift.
+		constexpr size_t msb_bits = (Bits % chunk::bits == 0) ? chunk::bits : Bits % chunk::bits;
+		wide_chunk_t carry = CarryIn;
 		for (size_t n = 0; n < result.chunks; n++) {
-			result.data[n] = data[n] + (Invert ? ~other.data[n] : other.data[n]) + carry;
+			chunk::type other_data = Invert ? ~other.data[n] : other.data[n];
 			if (result.chunks - 1 == n)
-				result.data[result.chunks - 1] &= result.msb_mask;
-			carry = (result.data[n] <  data[n]) ||
-			        (result.data[n] == data[n] && carry);
+				other_data &= msb_mask;
+			wide_chunk_t sum = wide_chunk_t(data[n]) + wide_chunk_t(other_data) + carry;
+			result.data[n] = chunk::type(sum);
+			carry = sum >> (result.chunks - 1 == n ? msb_bits : chunk::bits);
 		}
-		return {result, carry};
+		result.data[result.chunks - 1] &= result.msb_mask;
+		return {result, bool(carry)};
 	}
 
 	value<Bits> add(const value<Bits> &other) const {
@@ -575,32 +590,59 @@ struct value : public expr_base<value<Bits>> {
 	}
 
 	bool ucmp(const value<Bits> &other) const {
-		bool carry;
-		std::tie(std::ignore, carry) = alu</*Invert=*/true, /*CarryIn=*/true>(other);
-		return !carry; // a.ucmp(b) ≡ a u< b
+		// The most significant differing chunk decides the comparison, so there is no need to subtract.
+		for (size_t n = chunks; n-- > 0;)
+			if (data[n] != other.data[n])
+				return data[n] < other.data[n];
+		return false; // a.ucmp(b) ≡ a u< b
 	}
 
 	bool scmp(const value<Bits> &other) const {
-		value<Bits> result;
-		bool carry;
-		std::tie(result, carry) = alu</*Invert=*/true, /*CarryIn=*/true>(other);
-		bool overflow = (is_neg() == !other.is_neg()) && (is_neg() != result.is_neg());
-		return result.is_neg() ^ overflow; // a.scmp(b) ≡ a s< b
+		if (is_neg() != other.is_neg())
+			return is_neg();
+		return ucmp(other); // a.scmp(b) ≡ a s< b
 	}
 
 	template<size_t ResultBits>
 	value<ResultBits> mul(const value<Bits> &other) const {
 		value<ResultBits> result;
-		wide_chunk_t wide_result[result.chunks + 1] = {};
-		for (size_t n = 0; n < chunks; n++) {
-			for (size_t m = 0; m < chunks && n + m < result.chunks; m++) {
-				wide_result[n + m] += wide_chunk_t(data[n]) * wide_chunk_t(other.data[m]);
-				wide_result[n + m + 1] += wide_result[n + m] >> chunk::bits;
-				wide_result[n + m] &= chunk::mask;
+		// Schoolbook multiplication that accumulates each partial product row directly into the result. The carry
+		// never overflows: (2^k - 1) * (2^k - 1) + 2 * (2^k - 1) = 2^2k - 1.
+#if defined(__SIZEOF_INT128__)
+		if (chunks > 2) {
+			// Multiplying pairs of chunks at once needs a quarter as many multiplications.
+			constexpr size_t limbs = (chunks + 1) / 2;
+			constexpr size_t result_limbs = (value<ResultBits>::chunks + 1) / 2;
+			wide_chunk_t a[limbs] = {}, b[limbs] = {}, r[result_limbs] = {};
+			for (size_t n = 0; n < chunks; n++) {
+				a[n / 2] |= wide_chunk_t(data[n]) << (chunk::bits * (n % 2));
+				b[n / 2] |= wide_chunk_t(other.data[n]) << (chunk::bits * (n % 2));
+			}
+			for (size_t n = 0; n < limbs && n < result_limbs; n++) {
+				double_wide_chunk_t carry = 0;
+				for (size_t m = 0; m < limbs && n + m < result_limbs; m++) {
+					carry += double_wide_chunk_t(r[n + m]) + double_wide_chunk_t(a[n]) * double_wide_chunk_t(b[m]);
+					r[n + m] = wide_chunk_t(carry);
+					carry >>= 2 * chunk::bits;
+				}
+				if (n + limbs < result_limbs)
+					r[n + limbs] = wide_chunk_t(carry);
 			}
+			for (size_t n = 0; n < result.chunks; n++)
+				result.data[n] = chunk::type(r[n / 2] >> (chunk::bits * (n % 2)));
+			result.data[result.chunks - 1] &= result.msb_mask;
+			return result;
 		}
-		for (size_t n = 0; n < result.chunks; n++) {
-			result.data[n] = wide_result[n];
+#endif
+		for (size_t n = 0; n < chunks && n < result.chunks; n++) {
+			wide_chunk_t carry = 0;
+			for (size_t m = 0; m < chunks && n + m < result.chunks; m++) {
+				carry += wide_chunk_t(result.data[n + m]) + wide_chunk_t(data[n]) * wide_chunk_t(other.data[m]);
+				result.data[n + m] = chunk::type(carry);
+				carry >>= chunk::bits;
+			}
+			if (n + chunks < result.chunks)
+				result.data[n + chunks] = chunk::type(carry);
 		}
 		result.data[result.chunks - 1] &= result.msb_mask;
 		return result;
@@ -0,0 +1,191 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2019-2020  whitequark <whitequark@whitequark.org>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+// This file is included by the designs generated with `write_cxxrtl -parallel`. It is not used in Yosys itself.
+//
+// The worker pool runs the independent regions of a module's eval() on several threads at once. It is built for
+// dispatching many short batches of tasks (one batch per delta cycle), so idle workers spin for a while before
+// going to sleep.
+
+#ifndef CXXRTL_THREADS_H
+#define CXXRTL_THREADS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include <type_traits>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+namespace cxxrtl {
+
+class worker_pool {
+	// The current batch is described by a single word, so that a worker that wakes up late can never claim a task
+	// from a batch that has already finished. The generation is in the upper 32 bits, the number of tasks in the next
+	// 16 bits, and the index of the next unclaimed task in the lower 16 bits.
+	std::atomic<uint64_t> batch { 0 };
+	std::atomic<size_t> finished { 0 };
+	std::atomic<bool> running { false };
+	void (*task_fn)(void *, size_t) = nullptr;
+	void *task_data = nullptr;
+
+	std::vector<std::thread> threads;
+	std::mutex mutex;
+	std::condition_variable wakeup;
+	size_t sleeping = 0;
+	std::atomic<bool> stopping { false };
+
+	static constexpr unsigned spin_limit = 1 << 14;
+
+	bool claim(size_t &index) {
+		uint64_t state = batch.load(std::memory_order_acquire);
+		while ((state & 0xffff) < ((state >> 16) & 0xffff)) {
+			if (batch.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel)) {
+				index = state & 0xffff;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void work() {
+		size_t index;
+		while (claim(index)) {
+			task_fn(task_data, index);
+			finished.fetch_add(1, std::memory_order_release);
+		}
+	}
+
+	void worker() {
+		uint64_t generation = 0;
+		while (true) {
+			for (unsigned spin = 0; (batch.load(std::memory_order_acquire) >> 32) == generation; spin++) {
+				if (stopping.load(std::memory_order_relaxed))
+					return;
+				if (spin < spin_limit) {
+					std::this_thread::yield();
+					continue;
+				}
+				std::unique_lock<std::mutex> lock(mutex);
+				sleeping++;
+				wakeup.wait(lock, [&] { return stopping || (batch.load(std::memory_order_acquire) >> 32) != generation; });
+				sleeping--;
+				if (stopping)
+					return;
+			}
+			generation = batch.load(std::memory_order_acquire) >> 32;
+			work();
+		}
+	}
+
+	void start(size_t workers) {
+		stopping.store(false);
+		for (size_t i = 0; i < workers; i++)
+			threads.emplace_back(&worker_pool::worker, this);
+	}
+
+	void stop() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping.store(true);
+		}
+		wakeup.notify_all();
+		for (auto &thread : threads)
+			thread.join();
+		threads.clear();
+	}
+
+	template<class F>
+	static void call(void *data, size_t index) {
+		(*static_cast<F *>(data))(index);
+	}
+
+public:
+	explicit worker_pool(size_t workers) {
+		start(workers);
+	}
+
+	~worker_pool() {
+		stop();
+	}
+
+	worker_pool(const worker_pool &) = delete;
+	worker_pool &operator=(const worker_pool &) = delete;
+
+	// The pool used by the generated code. It has one worker per hardware thread, not counting the thread that runs
+	// the simulation, which also takes part in evaluating the design.
+	static worker_pool &shared() {
+		static worker_pool pool(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0);
+		return pool;
+	}
+
+	size_t workers() const {
+		return threads.size();
+	}
+
+	// Changes the number of worker threads. Must not be called while the pool is running tasks.
+	void resize(size_t workers) {
+		stop();
+		start(workers);
+	}
+
+	// Calls `task(0)`, ..., `task(count - 1)` and returns once all of them have returned. Task 0 is always run first
+	// and on the calling thread, so it is the place for anything that must not run on a worker thread. The other tasks
+	// may run in any order, on any thread, at the same time as each other and as task 0.
+	//
+	// If the pool is already running tasks (for example, because task 0 evaluates a submodule that is itself evaluated
+	// in parallel), the tasks are run one after another on the calling thread instead.
+	template<class F>
+	void run(size_t count, F &&task) {
+		if (count == 0)
+			return;
+		if (count == 1 || threads.empty() || running.exchange(true, std::memory_order_acquire)) {
+			for (size_t index = 0; index < count; index++)
+				task(index);
+			return;
+		}
+		assert(count <= 0xffff);
+
+		task_fn = &call<typename std::remove_reference<F>::type>;
+		task_data = static_cast<void *>(&task);
+		finished.store(0, std::memory_order_relaxed);
+		uint64_t generation = (batch.load(std::memory_order_relaxed) >> 32) + 1;
+		bool wake;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			batch.store((generation << 32) | (uint64_t(count) << 16) | 1, std::memory_order_release);
+			wake = sleeping > 0;
+		}
+		if (wake)
+			wakeup.notify_all();
+
+		task(0);
+		finished.fetch_add(1, std::memory_order_release);
+		work();
+		while (finished.load(std::memory_order_acquire) != count)
+			std::this_thread::yield();
+		running.store(false, std::memory_order_release);
+	}
+};
+
+} // namespace cxxrtl
+
+#endif
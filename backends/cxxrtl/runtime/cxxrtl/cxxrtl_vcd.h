@@ -120,16 +120,39 @@ class vcd_writer {
 		buffer += '\n';
 	}
 
+	struct digit_table {
+		char digits[256][8];
+
+		digit_table() {
+			for (size_t byte = 0; byte < 256; byte++)
+				for (size_t bit = 0; bit < 8; bit++)
+					digits[byte][bit] = '0' + ((byte >> (7 - bit)) & 1);
+		}
+	};
+
+	static const digit_table &byte_digits() {
+		static const digit_table table;
+		return table;
+	}
+
 	void emit_vector(const variable &var) {
 		assert(streaming);
-		buffer += 'b';
-		for (size_t bit = var.width - 1; bit != (size_t)-1; bit--) {
-			bool bit_curr = var.curr[bit / (8 * sizeof(chunk_t))] & (1 << (bit % (8 * sizeof(chunk_t))));
-			buffer += (bit_curr ? '1' : '0');
+		// Grow the buffer once and fill in the digits directly; appending them one by one is much slower.
+		size_t offset = buffer.size();
+		buffer.resize(offset + 1 + std::max<size_t>(var.width, 1) + 1);
+		char *digits = &buffer[offset];
+		*digits++ = 'b';
+		size_t bit = var.width;
+		for (; bit % 8 != 0; bit--)
+			*digits++ = '0' + ((var.curr[(bit - 1) / (8 * sizeof(chunk_t))] >> ((bit - 1) % (8 * sizeof(chunk_t)))) & 1);
+		for (; bit != 0; bit -= 8) {
+			uint8_t byte = var.curr[(bit - 8) / (8 * sizeof(chunk_t))] >> ((bit - 8) % (8 * sizeof(chunk_t)));
+			memcpy(digits, byte_digits().digits[byte], 8);
+			digits += 8;
 		}
 		if (var.width == 0)
-			buffer += '0';
-		buffer += ' ';
+			*digits++ = '0';
+		*digits++ = ' ';
 		emit_ident(var.ident);
 		buffer += '\n';
 	}
@@ -266,7 +289,7 @@ public:
 		}
 		reset_outlines();
 		emit_time(timestamp);
-		for (auto var : variables)
+		for (auto &var : variables)
 			if (test_variable(var) || first_sample) {
 				if (var.width == 1)
 					emit_scalar(var);
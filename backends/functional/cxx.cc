@@ -56,11 +56,11 @@ template<typename Id> struct CxxScope : public Functional::Scope<Id> {
 struct CxxType {
 	Functional::Sort sort;
 	CxxType(Functional::Sort sort) : sort(sort) {}
-	std::string to_string() const {
+	std::string to_string(bool batch = false) const {
 		if(sort.is_memory()) {
-			return stringf("Memory<%d, %d>", sort.addr_width(), sort.data_width());
+			return stringf("%sMemory<%d, %d>", batch ? "Batch" : "", sort.addr_width(), sort.data_width());
 		} else if(sort.is_signal()) {
-			return stringf("Signal<%d>", sort.width());
+			return stringf("%sSignal<%d>", batch ? "Batch" : "", sort.width());
 		} else {
 			log_error("unknown sort");
 		}
@@ -82,10 +82,10 @@ struct CxxStruct {
 		scope(name, name);
 		types.insert({name, type});
 	}
-	void print(CxxWriter &f) {
-		f.print("\tstruct {} {{\n", name);
+	void print(CxxWriter &f, bool batch = false) {
+		f.print("\tstruct {}{} {{\n", batch ? "Batch" : "", name);
 		for (auto p : types) {
-			f.print("\t\t{} {};\n", p.second.to_string(), scope(p.first, p.first));
+			f.print("\t\t{} {};\n", p.second.to_string(batch), scope(p.first, p.first));
 		}
 		f.print("\n\t\ttemplate <typename T> void visit(T &&fn) {{\n");
 		for (auto p : types) {
@@ -118,7 +118,8 @@ template<class NodePrinter> struct CxxPrintVisitor : public Functional::Abstract
 	NodePrinter np;
 	CxxStruct &input_struct;
 	CxxStruct &state_struct;
-	CxxPrintVisitor(CxxWriter &f, NodePrinter np, CxxStruct &input_struct, CxxStruct &state_struct) : f(f), np(np), input_struct(input_struct), state_struct(state_struct) { }
+	bool batch;
+	CxxPrintVisitor(CxxWriter &f, NodePrinter np, CxxStruct &input_struct, CxxStruct &state_struct, bool batch) : f(f), np(np), input_struct(input_struct), state_struct(state_struct), batch(batch) { }
 	template<typename... Args> void print(const char *fmt, Args&&... args) {
 		f.print_with(np, fmt, std::forward<Args>(args)...);
 	}
@@ -149,7 +150,12 @@ template<class NodePrinter> struct CxxPrintVisitor : public Functional::Abstract
 	void logical_shift_left(Node, Node a, Node b) override { print("{} << {}", a, b); }
 	void logical_shift_right(Node, Node a, Node b) override { print("{} >> {}", a, b); }
 	void arithmetic_shift_right(Node, Node a, Node b) override { print("{}.arithmetic_shift_right({})", a, b); }
-	void mux(Node, Node a, Node b, Node s) override { print("{2}.any() ? {1} : {0}", a, b, s); }
+	void mux(Node, Node a, Node b, Node s) override {
+		if (batch)
+			print("mux({0}, {1}, {2})", a, b, s);
+		else
+			print("{2}.any() ? {1} : {0}", a, b, s);
+	}
 	void constant(Node, RTLIL::Const const & value) override { print("{}", cxx_const(value)); }
 	void input(Node, IdString name, IdString kind) override { log_assert(kind == ID($input)); print("input.{}", input_struct[name]); }
 	void state(Node, IdString name, IdString kind) override { log_assert(kind == ID($state)); print("current_state.{}", state_struct[name]); }
@@ -184,20 +190,29 @@ struct CxxModule {
 			state_struct.insert(state->name, state->sort);
 		module_name = CxxScope<int>().unique_name(module->name);
 	}
-	void write_header(CxxWriter &f) {
-		f.print("#include \"sim.h\"\n\n");
+	void write_header(CxxWriter &f, bool batch) {
+		f.print("#include \"{}\"\n\n", batch ? "sim_batch.h" : "sim.h");
 	}
-	void write_struct_def(CxxWriter &f) {
+	void write_struct_def(CxxWriter &f, bool batch) {
 		f.print("struct {} {{\n", module_name);
 		input_struct.print(f);
 		output_struct.print(f);
 		state_struct.print(f);
+		if (batch) {
+			input_struct.print(f, true);
+			output_struct.print(f, true);
+			state_struct.print(f, true);
+		}
 		f.print("\tstatic void eval(Inputs const &, Outputs &, State const &, State &);\n");
 		f.print("\tstatic void initialize(State &);\n");
+		if (batch) {
+			f.print("\tstatic void eval(BatchInputs const &, BatchOutputs &, BatchState const &, BatchState &);\n");
+			f.print("\tstatic void initialize(BatchState &);\n");
+		}
 		f.print("}};\n\n");
 	}
-	void write_initial_def(CxxWriter &f) {
-		f.print("void {0}::initialize({0}::State &state)\n{{\n", module_name);
+	void write_initial_def(CxxWriter &f, bool batch = false) {
+		f.print("void {0}::initialize({0}::{1}State &state)\n{{\n", module_name, batch ? "Batch" : "");
 		for (auto state : ir.states()) {
 			if (state->sort.is_signal())
 				f.print("\tstate.{} = {};\n", state_struct[state->name], cxx_const(state->initial_value_signal()));
@@ -216,17 +231,18 @@ struct CxxModule {
 		}
 		f.print("}}\n\n");
 	}
-	void write_eval_def(CxxWriter &f) {
-		f.print("void {0}::eval({0}::Inputs const &input, {0}::Outputs &output, {0}::State const &current_state, {0}::State &next_state)\n{{\n", module_name);
+	void write_eval_def(CxxWriter &f, bool batch = false) {
+		f.print("void {0}::eval({0}::{1}Inputs const &input, {0}::{1}Outputs &output, {0}::{1}State const &current_state, {0}::{1}State &next_state)\n{{\n",
+			module_name, batch ? "Batch" : "");
 		CxxScope<int> locals;
 		locals.reserve("input");
 		locals.reserve("output");
 		locals.reserve("current_state");
 		locals.reserve("next_state");
 		auto node_name = [&](Functional::Node n) { return locals(n.id(), n.name()); };
-		CxxPrintVisitor printVisitor(f, node_name, input_struct, state_struct);
+		CxxPrintVisitor printVisitor(f, node_name, input_struct, state_struct, batch);
 		for (auto node : ir) {
-			f.print("\t{} {} = ", CxxType(node.sort()).to_string(), node_name(node));
+			f.print("\t{} {} = ", CxxType(node.sort()).to_string(batch), node_name(node));
 			node.visit(printVisitor);
 			f.print(";\n");
 		}
@@ -246,30 +262,54 @@ struct FunctionalCxxBackend : public Backend
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
 		log("\n");
-		log("TODO: add help message\n");
+		log("    write_functional_cxx [options] [filename]\n");
+		log("\n");
+		log("Write the selected modules as C++ code using the functional backend. The\n");
+		log("generated code requires the runtime in backends/functional/cxx_runtime.\n");
+		log("\n");
+		log("    -batch\n");
+		log("        also emit BatchInputs, BatchOutputs and BatchState structs with an\n");
+		log("        eval() and initialize() for them that simulate 64 independent\n");
+		log("        instances of the design at once. the signals are bit-sliced, so\n");
+		log("        each operation handles all of the instances with word operations.\n");
+		log("        the BatchSignal::lane() and set_lane() methods convert between\n");
+		log("        batched and per-instance signals.\n");
 		log("\n");
     }
 
-	void printCxx(std::ostream &stream, std::string, Module *module)
+	void printCxx(std::ostream &stream, std::string, Module *module, bool batch)
 	{
 		CxxWriter f(stream);
 		CxxModule mod(module);
-		mod.write_header(f);
-		mod.write_struct_def(f);
+		mod.write_header(f, batch);
+		mod.write_struct_def(f, batch);
 		mod.write_eval_def(f);
 		mod.write_initial_def(f);
+		if (batch) {
+			mod.write_eval_def(f, true);
+			mod.write_initial_def(f, true);
+		}
 	}
 
 	void execute(std::ostream *&f, std::string filename, std::vector<std::string> args, RTLIL::Design *design) override
 	{
         log_header(design, "Executing Functional C++ backend.\n");
 
-		size_t argidx = 1;
+		bool batch = false;
+		size_t argidx;
+		for (argidx = 1; argidx < args.size(); argidx++)
+		{
+			if (args[argidx] == "-batch") {
+				batch = true;
+				continue;
+			}
+			break;
+		}
 		extra_args(f, filename, args, argidx, design);
 
 		for (auto module : design->selected_modules()) {
             log("Dumping module `%s'.\n", module->name.c_str());
-			printCxx(*f, filename, module);
+			printCxx(*f, filename, module, batch);
 		}
 	}
 } FunctionalCxxBackend;
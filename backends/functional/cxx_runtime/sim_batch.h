@@ -0,0 +1,377 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2024  Emily Schmidt <emily@yosyshq.com>
+ *  Copyright (C) 2024 National Technology and Engineering Solutions of Sandia, LLC
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef SIM_BATCH_H
+#define SIM_BATCH_H
+
+#include <cstdint>
+#include "sim.h"
+
+// The batched counterparts of `Signal` and `Memory` evaluate `batch_lanes` independent instances of a design at once.
+// They are bit-sliced: a `BatchSignal<n>` holds n lane masks, where bit l of mask i is bit i of the signal in lane l.
+// Each operation of `Signal` then becomes the same sequence of operations on whole lane masks, which does the work
+// of every lane at once and leaves loops over the bits that the compiler can vectorize further.
+
+typedef uint64_t lane_mask;
+constexpr size_t batch_lanes = 64;
+
+template<size_t n>
+class BatchSignal {
+    template<size_t m> friend class BatchSignal;
+    std::array<lane_mask, n> _bits;
+public:
+    BatchSignal() { }
+    BatchSignal(Signal<n> const &val)
+    {
+        for(size_t i = 0; i < n; i++)
+            _bits[i] = val[i] ? ~(lane_mask)0 : 0;
+    }
+    BatchSignal(uint32_t val) : BatchSignal(Signal<n>(val)) { }
+    BatchSignal(std::initializer_list<uint32_t> vals) : BatchSignal(Signal<n>(vals)) { }
+
+    // Returns a signal with every bit equal to the lane's bit of `mask`.
+    static BatchSignal repeat(lane_mask mask)
+    {
+        BatchSignal<n> ret;
+        for(size_t i = 0; i < n; i++)
+            ret._bits[i] = mask;
+        return ret;
+    }
+
+    Signal<n> lane(size_t l) const
+    {
+        assert(l < batch_lanes);
+        std::array<uint32_t, (n + 31) / 32> words{};
+        for(size_t i = 0; i < n; i++)
+            words[i / 32] |= (uint32_t)((_bits[i] >> l) & 1) << (i % 32);
+        return Signal<n>::from_array(words);
+    }
+
+    void set_lane(size_t l, Signal<n> const &val)
+    {
+        assert(l < batch_lanes);
+        for(size_t i = 0; i < n; i++)
+            _bits[i] = (_bits[i] & ~((lane_mask)1 << l)) | ((lane_mask)val[i] << l);
+    }
+
+    int size() const { return n; }
+    lane_mask operator[](int i) const { assert(n >= 0 && i < n); return _bits[i]; }
+
+    template<size_t m>
+    BatchSignal<m> slice(size_t offset) const
+    {
+        BatchSignal<m> ret;
+
+        assert(offset + m <= n);
+        std::copy(_bits.begin() + offset, _bits.begin() + offset + m, ret._bits.begin());
+        return ret;
+    }
+
+    BatchSignal<1> any() const
+    {
+        BatchSignal<1> ret;
+        ret._bits[0] = 0;
+        for(size_t i = 0; i < n; i++)
+            ret._bits[0] |= _bits[i];
+        return ret;
+    }
+
+    BatchSignal<1> all() const
+    {
+        BatchSignal<1> ret;
+        ret._bits[0] = ~(lane_mask)0;
+        for(size_t i = 0; i < n; i++)
+            ret._bits[0] &= _bits[i];
+        return ret;
+    }
+
+    BatchSignal<1> parity() const
+    {
+        BatchSignal<1> ret;
+        ret._bits[0] = 0;
+        for(size_t i = 0; i < n; i++)
+            ret._bits[0] ^= _bits[i];
+        return ret;
+    }
+
+    lane_mask sign() const { return _bits[n-1]; }
+
+    BatchSignal<n> operator ~() const
+    {
+        BatchSignal<n> ret;
+        for(size_t i = 0; i < n; i++)
+            ret._bits[i] = ~_bits[i];
+        return ret;
+    }
+
+    BatchSignal<n> operator -() const
+    {
+        return BatchSignal<n>(0u) - *this;
+    }
+
+    BatchSignal<n> operator +(BatchSignal<n> const &b) const
+    {
+        BatchSignal<n> ret;
+        lane_mask carry = 0;
+        for(size_t i = 0; i < n; i++){
+            lane_mask half = _bits[i] ^ b._bits[i];
+            ret._bits[i] = half ^ carry;
+            carry = (_bits[i] & b._bits[i]) | (half & carry);
+        }
+        return ret;
+    }
+
+    BatchSignal<n> operator -(BatchSignal<n> const &b) const
+    {
+        BatchSignal<n> ret;
+        lane_mask carry = ~(lane_mask)0;
+        for(size_t i = 0; i < n; i++){
+            lane_mask half = _bits[i] ^ ~b._bits[i];
+            ret._bits[i] = half ^ carry;
+            carry = (_bits[i] & ~b._bits[i]) | (half & carry);
+        }
+        return ret;
+    }
+
+    BatchSignal<n> operator *(BatchSignal<n> const &b) const
+    {
+        BatchSignal<n> ret = 0u;
+        for(size_t i = 0; i < n; i++){
+            // Add `*this << i` in the lanes where bit i of `b` is set.
+            BatchSignal<n> partial = 0u;
+            for(size_t j = i; j < n; j++)
+                partial._bits[j] = _bits[j - i] & b._bits[i];
+            ret = ret + partial;
+        }
+        return ret;
+    }
+
+private:
+    BatchSignal<n> divmod(BatchSignal<n> const &b, bool modulo) const
+    {
+        BatchSignal<n> q = 0u;
+        BatchSignal<n> r = 0u;
+        for(size_t i = n; i-- != 0; ){
+            for(size_t j = n; j-- > 1; )
+                r._bits[j] = r._bits[j - 1];
+            r._bits[0] = _bits[i];
+            lane_mask ge = (r >= b)._bits[0];
+            r = select(ge, r - b, r);
+            q._bits[i] = ge;
+        }
+        // Division by zero results in zero, like in `Signal`.
+        return select(b.any()._bits[0], modulo ? r : q, 0u);
+    }
+public:
+
+    BatchSignal<n> operator /(BatchSignal<n> const &b) const { return divmod(b, false); }
+    BatchSignal<n> operator %(BatchSignal<n> const &b) const { return divmod(b, true); }
+
+    BatchSignal<1> operator ==(BatchSignal<n> const &b) const { return ~(*this != b); }
+
+    BatchSignal<1> operator !=(BatchSignal<n> const &b) const { return (*this ^ b).any(); }
+
+private:
+    // Compares from the most significant bit down; a lane is decided by the first bit that differs in it.
+    BatchSignal<1> compare(BatchSignal<n> const &b, bool or_equal, bool is_signed) const
+    {
+        lane_mask decided = 0, greater = 0;
+        for(size_t i = n; i-- != 0; ){
+            lane_mask a_bit = _bits[i], b_bit = b._bits[i];
+            if(is_signed && i == n - 1)
+                std::swap(a_bit, b_bit);
+            lane_mask differs = (a_bit ^ b_bit) & ~decided;
+            greater |= differs & a_bit;
+            decided |= differs;
+        }
+        BatchSignal<1> ret;
+        ret._bits[0] = or_equal ? greater | ~decided : greater;
+        return ret;
+    }
+public:
+
+    BatchSignal<1> operator >=(BatchSignal<n> const &b) const { return compare(b, true, false); }
+    BatchSignal<1> operator >(BatchSignal<n> const &b) const { return compare(b, false, false); }
+    BatchSignal<1> operator <=(BatchSignal<n> const &b) const { return b >= *this; }
+    BatchSignal<1> operator <(BatchSignal<n> const &b) const { return b > *this; }
+
+    BatchSignal<1> signed_greater_than(BatchSignal<n> const &b) const { return compare(b, false, true); }
+    BatchSignal<1> signed_greater_equal(BatchSignal<n> const &b) const { return compare(b, true, true); }
+
+    BatchSignal<n> operator &(BatchSignal<n> const &b) const
+    {
+        BatchSignal<n> ret;
+        for(size_t i = 0; i < n; i++)
+            ret._bits[i] = _bits[i] & b._bits[i];
+        return ret;
+    }
+
+    BatchSignal<n> operator |(BatchSignal<n> const &b) const
+    {
+        BatchSignal<n> ret;
+        for(size_t i = 0; i < n; i++)
+            ret._bits[i] = _bits[i] | b._bits[i];
+        return ret;
+    }
+
+    BatchSignal<n> operator ^(BatchSignal<n> const &b) const
+    {
+        BatchSignal<n> ret;
+        for(size_t i = 0; i < n; i++)
+            ret._bits[i] = _bits[i] ^ b._bits[i];
+        return ret;
+    }
+
+    // Per lane, `mask ? a : b`.
+    static BatchSignal<n> select(lane_mask mask, BatchSignal<n> const &a, BatchSignal<n> const &b)
+    {
+        BatchSignal<n> ret;
+        for(size_t i = 0; i < n; i++)
+            ret._bits[i] = (a._bits[i] & mask) | (b._bits[i] & ~mask);
+        return ret;
+    }
+
+private:
+    // Shifts every lane by its own amount with a barrel shifter: stage k shifts the lanes that have bit k of
+    // the amount set by 2^k positions. Lanes that shift by n or more bits end up filled with `fill`.
+    template<size_t nb>
+    BatchSignal<n> shift(BatchSignal<nb> const &b, bool right, lane_mask fill) const
+    {
+        BatchSignal<n> ret = *this;
+        lane_mask overflow = 0;
+        for(size_t k = 0; k < nb; k++){
+            if(k >= 8 * sizeof(size_t) - 1 || ((size_t)1 << k) >= n) {
+                overflow |= b._bits[k];
+                continue;
+            }
+            size_t amount = (size_t)1 << k;
+            BatchSignal<n> shifted;
+            for(size_t i = 0; i < n; i++)
+                if(right)
+                    shifted._bits[i] = i + amount < n ? ret._bits[i + amount] : fill;
+                else
+                    shifted._bits[i] = i >= amount ? ret._bits[i - amount] : 0;
+            ret = select(b._bits[k], shifted, ret);
+        }
+        return select(overflow, BatchSignal<n>::repeat(right ? fill : 0), ret);
+    }
+public:
+
+    template<size_t nb>
+    BatchSignal<n> operator <<(BatchSignal<nb> const &b) const { return shift(b, false, 0); }
+
+    template<size_t nb>
+    BatchSignal<n> operator >>(BatchSignal<nb> const &b) const { return shift(b, true, 0); }
+
+    template<size_t nb>
+    BatchSignal<n> arithmetic_shift_right(BatchSignal<nb> const &b) const { return shift(b, true, sign()); }
+
+    template<size_t m>
+    BatchSignal<n+m> concat(BatchSignal<m> const& b) const
+    {
+        BatchSignal<n + m> ret;
+        std::copy(_bits.begin(), _bits.end(), ret._bits.begin());
+        std::copy(b._bits.begin(), b._bits.end(), ret._bits.begin() + n);
+        return ret;
+    }
+
+    template<size_t m>
+    BatchSignal<m> zero_extend() const
+    {
+        assert(m >= n);
+        BatchSignal<m> ret = 0u;
+        std::copy(_bits.begin(), _bits.end(), ret._bits.begin());
+        return ret;
+    }
+
+    template<size_t m>
+    BatchSignal<m> sign_extend() const
+    {
+        assert(m >= n);
+        BatchSignal<m> ret = BatchSignal<m>::repeat(sign());
+        std::copy(_bits.begin(), _bits.end(), ret._bits.begin());
+        return ret;
+    }
+};
+
+// Per lane, `s ? b : a`.
+template<size_t n>
+BatchSignal<n> mux(BatchSignal<n> const &a, BatchSignal<n> const &b, BatchSignal<1> const &s)
+{
+    return BatchSignal<n>::select(s[0], b, a);
+}
+
+template<size_t a, size_t d>
+class BatchMemory {
+    std::array<BatchSignal<d>, 1<<a> _contents;
+public:
+    BatchMemory() {}
+    BatchMemory(std::array<Signal<d>, 1<<a> const &contents)
+    {
+        for(size_t i = 0; i < contents.size(); i++)
+            _contents[i] = contents[i];
+    }
+
+    // Lanes read and write different addresses. Small memories compare the address with every index using whole
+    // lane masks; larger ones go through the lanes one at a time, which is cheaper than visiting every word.
+    BatchSignal<d> read(BatchSignal<a> const &addr) const
+    {
+        BatchSignal<d> ret = 0u;
+        if((1<<a) <= batch_lanes) {
+            for(size_t i = 0; i < _contents.size(); i++)
+                ret = BatchSignal<d>::select(address_match(addr, i), _contents[i], ret);
+        } else {
+            for(size_t l = 0; l < batch_lanes; l++)
+                ret = BatchSignal<d>::select((lane_mask)1 << l, _contents[lane_address(addr, l)], ret);
+        }
+        return ret;
+    }
+    BatchMemory write(BatchSignal<a> const &addr, BatchSignal<d> const &data) const
+    {
+        BatchMemory ret = *this;
+        if((1<<a) <= batch_lanes) {
+            for(size_t i = 0; i < _contents.size(); i++)
+                ret._contents[i] = BatchSignal<d>::select(address_match(addr, i), data, ret._contents[i]);
+        } else {
+            for(size_t l = 0; l < batch_lanes; l++) {
+                size_t index = lane_address(addr, l);
+                ret._contents[index] = BatchSignal<d>::select((lane_mask)1 << l, data, ret._contents[index]);
+            }
+        }
+        return ret;
+    }
+private:
+    static lane_mask address_match(BatchSignal<a> const &addr, size_t index)
+    {
+        lane_mask ret = ~(lane_mask)0;
+        for(size_t i = 0; i < a; i++)
+            ret &= (index >> i) & 1 ? addr[i] : ~addr[i];
+        return ret;
+    }
+    static size_t lane_address(BatchSignal<a> const &addr, size_t l)
+    {
+        size_t ret = 0;
+        for(size_t i = 0; i < a; i++)
+            ret |= (size_t)((addr[i] >> l) & 1) << i;
+        return ret;
+    }
+};
+
+#endif
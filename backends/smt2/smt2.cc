@@ -23,6 +23,7 @@
 #include "kernel/celltypes.h"
 #include "kernel/log.h"
 #include "kernel/mem.h"
+#include "kernel/strash.h"
 #include "libs/json11/json11.hpp"
 #include "kernel/utils.h"
 #include <string>
@@ -35,14 +36,14 @@ struct Smt2Worker
 	CellTypes ct;
 	SigMap sigmap;
 	RTLIL::Module *module;
-	bool bvmode, memmode, wiresmode, verbose, statebv, statedt, forallmode;
+	bool bvmode, memmode, wiresmode, verbose, statebv, statedt, forallmode, coimode;
 	dict<IdString, int> &mod_stbv_width;
 	int idcounter = 0, statebv_width = 0;
 
 	std::vector<std::string> decls, trans, hier, dtmembers;
 	std::map<RTLIL::SigBit, RTLIL::Cell*> bit_driver;
 	std::set<RTLIL::Cell*> exported_cells, hiercells, hiercells_queue;
-	pool<Cell*> recursive_cells, registers;
+	pool<Cell*> recursive_cells, registers, strash_duplicates;
 	std::vector<Mem> memories;
 	dict<Cell*, Mem*> mem_cells;
 	std::set<Mem*> memory_queue;
@@ -115,14 +116,17 @@ struct Smt2Worker
 			decls.push_back(decl_str + "\n");
 	}
 
-	Smt2Worker(RTLIL::Module *module, bool bvmode, bool memmode, bool wiresmode, bool verbose, bool statebv, bool statedt, bool forallmode,
+	Smt2Worker(RTLIL::Module *module, bool bvmode, bool memmode, bool wiresmode, bool verbose, bool statebv, bool statedt, bool forallmode, bool coimode,
 		   dict<IdString, int> &mod_stbv_width, dict<IdString, dict<IdString, pair<bool, bool>>> &mod_clk_cache)
 	    : ct(module->design), sigmap(module), module(module), bvmode(bvmode), memmode(memmode), wiresmode(wiresmode), verbose(verbose),
-	      statebv(statebv), statedt(statedt), forallmode(forallmode), mod_stbv_width(mod_stbv_width),
+	      statebv(statebv), statedt(statedt), forallmode(forallmode), coimode(coimode && !module->has_attribute(ID::smtlib2_module)), mod_stbv_width(mod_stbv_width),
 	      is_smtlib2_module(module->has_attribute(ID::smtlib2_module))
 	{
 		pool<SigBit> noclock;
 
+		if (this->coimode)
+			strash_duplicates = strash_cells(module, sigmap);
+
 		makebits(stringf("%s_is", get_id(module)));
 
 		dict<IdString, Mem*> mem_dict;
@@ -196,6 +200,10 @@ struct Smt2Worker
 				continue;
 			}
 
+			// Computed by the cell it duplicates.
+			if (strash_duplicates.count(cell))
+				continue;
+
 			bool is_input = ct.cell_input(cell->type, conn.first);
 			bool is_output = ct.cell_output(cell->type, conn.first);
 
@@ -979,6 +987,84 @@ struct Smt2Worker
 			}
 		}
 
+		// with -coi, registers and the outputs of the top module are only
+		// exported below if the properties pulled in the logic driving them
+		bool is_top = module->design->top_module() == module;
+		vector<pair<Wire*, bool>> coi_wires;
+
+		auto export_wire = [&](RTLIL::Wire *wire, bool is_register, bool contains_clock) {
+			bool is_smtlib2_comb_expr = wire->has_attribute(ID::smtlib2_comb_expr);
+			RTLIL::SigSpec sig = sigmap(wire);
+			std::vector<std::string> comments;
+			if (wire->port_input)
+				comments.push_back(stringf("; yosys-smt2-input %s %d\n", get_id(wire), wire->width));
+			if (wire->port_output)
+				comments.push_back(stringf("; yosys-smt2-output %s %d\n", get_id(wire), wire->width));
+			if (is_register)
+				comments.push_back(stringf("; yosys-smt2-register %s %d\n", get_id(wire), wire->width));
+			if (wire->get_bool_attribute(ID::keep) || (wiresmode && wire->name.isPublic()))
+				comments.push_back(stringf("; yosys-smt2-wire %s %d\n", get_id(wire), wire->width));
+			if (contains_clock && GetSize(wire) == 1 && (clock_posedge.count(sig) || clock_negedge.count(sig)))
+				comments.push_back(stringf("; yosys-smt2-clock %s%s%s\n", get_id(wire),
+						clock_posedge.count(sig) ? " posedge" : "", clock_negedge.count(sig) ? " negedge" : ""));
+			if (wire->port_input && contains_clock) {
+				for (int i = 0; i < GetSize(sig); i++) {
+					bool is_posedge = clock_posedge.count(sig[i]);
+					bool is_negedge = clock_negedge.count(sig[i]);
+					if (is_posedge != is_negedge)
+						comments.push_back(witness_signal(
+								is_posedge ? "posedge" : "negedge", 1, i, get_id(wire), -1, wire));
+				}
+			}
+			if (wire->port_input)
+				comments.push_back(witness_signal("input", wire->width, 0, get_id(wire), -1, wire));
+			std::string smtlib2_comb_expr;
+			if (is_smtlib2_comb_expr) {
+				smtlib2_comb_expr =
+				  "(let (\n" + smtlib2_inputs + ")\n" + wire->get_string_attribute(ID::smtlib2_comb_expr) + "\n)";
+				if (wire->port_input || !wire->port_output)
+					log_error("smtlib2_comb_expr is only valid on output: wire %s.%s", log_id(module), log_id(wire));
+				if (!bvmode && GetSize(sig) > 1)
+					log_error("smtlib2_comb_expr is unsupported on multi-bit wires when -nobv is specified: wire %s.%s",
+						  log_id(module), log_id(wire));
+
+				comments.push_back(witness_signal("blackbox", wire->width, 0, get_id(wire), -1, wire));
+			}
+			auto &out_decls = is_smtlib2_comb_expr ? smtlib2_decls : decls;
+			if (bvmode && GetSize(sig) > 1) {
+				std::string sig_bv = is_smtlib2_comb_expr ? smtlib2_comb_expr : get_bv(sig);
+				if (!comments.empty())
+					out_decls.insert(out_decls.end(), comments.begin(), comments.end());
+				out_decls.push_back(stringf("(define-fun |%s_n %s| ((state |%s_s|)) (_ BitVec %d) %s)\n",
+						get_id(module), get_id(wire), get_id(module), GetSize(sig), sig_bv.c_str()));
+				if (wire->port_input)
+					ex_input_eq.push_back(stringf("  (= (|%s_n %s| state) (|%s_n %s| other_state))",
+							get_id(module), get_id(wire), get_id(module), get_id(wire)));
+			} else {
+				std::vector<std::string> sig_bool;
+				for (int i = 0; i < GetSize(sig); i++) {
+					sig_bool.push_back(is_smtlib2_comb_expr ? smtlib2_comb_expr : get_bool(sig[i]));
+				}
+				if (!comments.empty())
+					out_decls.insert(out_decls.end(), comments.begin(), comments.end());
+				for (int i = 0; i < GetSize(sig); i++) {
+					if (GetSize(sig) > 1) {
+						out_decls.push_back(stringf("(define-fun |%s_n %s %d| ((state |%s_s|)) Bool %s)\n",
+								get_id(module), get_id(wire), i, get_id(module), sig_bool[i].c_str()));
+						if (wire->port_input)
+							ex_input_eq.push_back(stringf("  (= (|%s_n %s %d| state) (|%s_n %s %d| other_state))",
+									get_id(module), get_id(wire), i, get_id(module), get_id(wire), i));
+					} else {
+						out_decls.push_back(stringf("(define-fun |%s_n %s| ((state |%s_s|)) Bool %s)\n",
+								get_id(module), get_id(wire), get_id(module), sig_bool[i].c_str()));
+						if (wire->port_input)
+							ex_input_eq.push_back(stringf("  (= (|%s_n %s| state) (|%s_n %s| other_state))",
+									get_id(module), get_id(wire), get_id(module), get_id(wire)));
+					}
+				}
+			}
+		};
+
 		for (auto wire : module->wires()) {
 			bool is_register = false;
 			bool contains_clock = false;
@@ -993,112 +1079,67 @@ struct Smt2Worker
 			if (is_smtlib2_comb_expr && !is_smtlib2_module)
 				log_error("smtlib2_comb_expr is only valid in a module with the smtlib2_module attribute: wire %s.%s", log_id(module),
 					  log_id(wire));
-			if (wire->port_id || is_register || contains_clock || wire->get_bool_attribute(ID::keep) || (wiresmode && wire->name.isPublic())) {
-				RTLIL::SigSpec sig = sigmap(wire);
-				std::vector<std::string> comments;
-				if (wire->port_input)
-					comments.push_back(stringf("; yosys-smt2-input %s %d\n", get_id(wire), wire->width));
-				if (wire->port_output)
-					comments.push_back(stringf("; yosys-smt2-output %s %d\n", get_id(wire), wire->width));
-				if (is_register)
-					comments.push_back(stringf("; yosys-smt2-register %s %d\n", get_id(wire), wire->width));
-				if (wire->get_bool_attribute(ID::keep) || (wiresmode && wire->name.isPublic()))
-					comments.push_back(stringf("; yosys-smt2-wire %s %d\n", get_id(wire), wire->width));
-				if (contains_clock && GetSize(wire) == 1 && (clock_posedge.count(sig) || clock_negedge.count(sig)))
-					comments.push_back(stringf("; yosys-smt2-clock %s%s%s\n", get_id(wire),
-							clock_posedge.count(sig) ? " posedge" : "", clock_negedge.count(sig) ? " negedge" : ""));
-				if (wire->port_input && contains_clock) {
-					for (int i = 0; i < GetSize(sig); i++) {
-						bool is_posedge = clock_posedge.count(sig[i]);
-						bool is_negedge = clock_negedge.count(sig[i]);
-						if (is_posedge != is_negedge)
-							comments.push_back(witness_signal(
-									is_posedge ? "posedge" : "negedge", 1, i, get_id(wire), -1, wire));
-					}
-				}
-				if (wire->port_input)
-					comments.push_back(witness_signal("input", wire->width, 0, get_id(wire), -1, wire));
-				std::string smtlib2_comb_expr;
-				if (is_smtlib2_comb_expr) {
-					smtlib2_comb_expr =
-					  "(let (\n" + smtlib2_inputs + ")\n" + wire->get_string_attribute(ID::smtlib2_comb_expr) + "\n)";
-					if (wire->port_input || !wire->port_output)
-						log_error("smtlib2_comb_expr is only valid on output: wire %s.%s", log_id(module), log_id(wire));
-					if (!bvmode && GetSize(sig) > 1)
-						log_error("smtlib2_comb_expr is unsupported on multi-bit wires when -nobv is specified: wire %s.%s",
-							  log_id(module), log_id(wire));
-
-					comments.push_back(witness_signal("blackbox", wire->width, 0, get_id(wire), -1, wire));
-				}
-				auto &out_decls = is_smtlib2_comb_expr ? smtlib2_decls : decls;
-				if (bvmode && GetSize(sig) > 1) {
-					std::string sig_bv = is_smtlib2_comb_expr ? smtlib2_comb_expr : get_bv(sig);
-					if (!comments.empty())
-						out_decls.insert(out_decls.end(), comments.begin(), comments.end());
-					out_decls.push_back(stringf("(define-fun |%s_n %s| ((state |%s_s|)) (_ BitVec %d) %s)\n",
-							get_id(module), get_id(wire), get_id(module), GetSize(sig), sig_bv.c_str()));
-					if (wire->port_input)
-						ex_input_eq.push_back(stringf("  (= (|%s_n %s| state) (|%s_n %s| other_state))",
-								get_id(module), get_id(wire), get_id(module), get_id(wire)));
-				} else {
-					std::vector<std::string> sig_bool;
-					for (int i = 0; i < GetSize(sig); i++) {
-						sig_bool.push_back(is_smtlib2_comb_expr ? smtlib2_comb_expr : get_bool(sig[i]));
-					}
-					if (!comments.empty())
-						out_decls.insert(out_decls.end(), comments.begin(), comments.end());
-					for (int i = 0; i < GetSize(sig); i++) {
-						if (GetSize(sig) > 1) {
-							out_decls.push_back(stringf("(define-fun |%s_n %s %d| ((state |%s_s|)) Bool %s)\n",
-									get_id(module), get_id(wire), i, get_id(module), sig_bool[i].c_str()));
-							if (wire->port_input)
-								ex_input_eq.push_back(stringf("  (= (|%s_n %s %d| state) (|%s_n %s %d| other_state))",
-										get_id(module), get_id(wire), i, get_id(module), get_id(wire), i));
-						} else {
-							out_decls.push_back(stringf("(define-fun |%s_n %s| ((state |%s_s|)) Bool %s)\n",
-									get_id(module), get_id(wire), get_id(module), sig_bool[i].c_str()));
-							if (wire->port_input)
-								ex_input_eq.push_back(stringf("  (= (|%s_n %s| state) (|%s_n %s| other_state))",
-										get_id(module), get_id(wire), get_id(module), get_id(wire)));
-						}
-					}
-				}
-			}
+			if (!wire->port_id && !is_register && !contains_clock && !wire->get_bool_attribute(ID::keep) && !(wiresmode && wire->name.isPublic()))
+				continue;
+			if (coimode && !wire->port_input && !contains_clock && !wire->get_bool_attribute(ID::keep) && !(wiresmode && wire->name.isPublic()) &&
+					(!wire->port_output || is_top))
+				coi_wires.push_back(std::make_pair(wire, is_register));
+			else
+				export_wire(wire, is_register, contains_clock);
 		}
 
 		decls.insert(decls.end(), smtlib2_decls.begin(), smtlib2_decls.end());
 
-		if (verbose) log("=> export logic associated with the initial state\n");
-
 		vector<string> init_list;
-		for (auto wire : module->wires())
-			if (wire->attributes.count(ID::init)) {
-				if (is_smtlib2_module)
-					log_error("init attribute not allowed on wires in module with smtlib2_module attribute: wire %s.%s",
-						  log_id(module), log_id(wire));
+		auto export_init = [&]() {
+			if (verbose) log("=> export logic associated with the initial state\n");
 
-				RTLIL::SigSpec sig = sigmap(wire);
-				Const val = wire->attributes.at(ID::init);
-				val.bits().resize(GetSize(sig), State::Sx);
-				if (bvmode && GetSize(sig) > 1) {
-					Const mask(State::S1, GetSize(sig));
-					bool use_mask = false;
-					for (int i = 0; i < GetSize(sig); i++)
-						if (val[i] != State::S0 && val[i] != State::S1) {
-							val.bits()[i] = State::S0;
-							mask.bits()[i] = State::S0;
-							use_mask = true;
-						}
-					if (use_mask)
-						init_list.push_back(stringf("(= (bvand %s #b%s) #b%s) ; %s", get_bv(sig).c_str(), mask.as_string().c_str(), val.as_string().c_str(), get_id(wire)));
-					else
-						init_list.push_back(stringf("(= %s #b%s) ; %s", get_bv(sig).c_str(), val.as_string().c_str(), get_id(wire)));
-				} else {
-					for (int i = 0; i < GetSize(sig); i++)
-						if (val[i] == State::S0 || val[i] == State::S1)
-							init_list.push_back(stringf("(= %s %s) ; %s", get_bool(sig[i]).c_str(), val[i] == State::S1 ? "true" : "false", get_id(wire)));
+			for (auto wire : module->wires())
+				if (wire->attributes.count(ID::init)) {
+					if (is_smtlib2_module)
+						log_error("init attribute not allowed on wires in module with smtlib2_module attribute: wire %s.%s",
+							  log_id(module), log_id(wire));
+
+					RTLIL::SigSpec sig = sigmap(wire);
+					Const val = wire->attributes.at(ID::init);
+					val.bits().resize(GetSize(sig), State::Sx);
+					if (coimode) {
+						// leave out the bits outside of the exported logic
+						RTLIL::SigSpec coi_sig;
+						Const coi_val;
+						for (int i = 0; i < GetSize(sig); i++)
+							if (sig[i].wire == nullptr || fcache.count(sig[i])) {
+								coi_sig.append(sig[i]);
+								coi_val.bits().push_back(val[i]);
+							}
+						if (GetSize(coi_sig) == 0)
+							continue;
+						sig = coi_sig;
+						val = coi_val;
+					}
+					if (bvmode && GetSize(sig) > 1) {
+						Const mask(State::S1, GetSize(sig));
+						bool use_mask = false;
+						for (int i = 0; i < GetSize(sig); i++)
+							if (val[i] != State::S0 && val[i] != State::S1) {
+								val.bits()[i] = State::S0;
+								mask.bits()[i] = State::S0;
+								use_mask = true;
+							}
+						if (use_mask)
+							init_list.push_back(stringf("(= (bvand %s #b%s) #b%s) ; %s", get_bv(sig).c_str(), mask.as_string().c_str(), val.as_string().c_str(), get_id(wire)));
+						else
+							init_list.push_back(stringf("(= %s #b%s) ; %s", get_bv(sig).c_str(), val.as_string().c_str(), get_id(wire)));
+					} else {
+						for (int i = 0; i < GetSize(sig); i++)
+							if (val[i] == State::S0 || val[i] == State::S1)
+								init_list.push_back(stringf("(= %s %s) ; %s", get_bool(sig[i]).c_str(), val[i] == State::S1 ? "true" : "false", get_id(wire)));
+					}
 				}
-			}
+		};
+
+		if (!coimode)
+			export_init();
 
 		if (verbose) log("=> export logic driving asserts\n");
 
@@ -1381,6 +1422,20 @@ struct Smt2Worker
 			}
 		}
 
+		if (coimode)
+		{
+			for (auto &it : coi_wires) {
+				bool exported = true;
+				for (auto bit : sigmap(it.first))
+					if (bit.wire != nullptr && fcache.count(bit) == 0)
+						exported = false;
+				if (exported)
+					export_wire(it.first, it.second, false);
+			}
+
+			export_init();
+		}
+
 		if (verbose) log("=> finalizing SMT2 representation of %s.\n", log_id(module));
 
 		for (auto c : hiercells) {
@@ -1465,47 +1520,59 @@ struct Smt2Worker
 
 	void write(std::ostream &f)
 	{
-		f << stringf("; yosys-smt2-module %s\n", get_id(module));
+		// collect the output and hand it to the stream in large chunks
+		std::string buffer;
+		auto emit = [&](const std::string &str) {
+			buffer += str;
+			if (buffer.size() >= (1 << 20)) {
+				f.write(buffer.data(), buffer.size());
+				buffer.clear();
+			}
+		};
+
+		emit(stringf("; yosys-smt2-module %s\n", get_id(module)));
 
 		if (statebv) {
-			f << stringf("(define-sort |%s_s| () (_ BitVec %d))\n", get_id(module), statebv_width);
+			emit(stringf("(define-sort |%s_s| () (_ BitVec %d))\n", get_id(module), statebv_width));
 			mod_stbv_width[module->name] = statebv_width;
 		} else
 		if (statedt) {
-			f << stringf("(declare-datatype |%s_s| ((|%s_mk|\n", get_id(module), get_id(module));
-			for (auto it : dtmembers)
-				f << it;
-			f << stringf(")))\n");
+			emit(stringf("(declare-datatype |%s_s| ((|%s_mk|\n", get_id(module), get_id(module)));
+			for (auto &it : dtmembers)
+				emit(it);
+			emit(stringf(")))\n"));
 		} else
-			f << stringf("(declare-sort |%s_s| 0)\n", get_id(module));
+			emit(stringf("(declare-sort |%s_s| 0)\n", get_id(module)));
 
-		for (auto it : decls)
-			f << it;
+		for (auto &it : decls)
+			emit(it);
 
-		f << stringf("(define-fun |%s_h| ((state |%s_s|)) Bool ", get_id(module), get_id(module));
+		emit(stringf("(define-fun |%s_h| ((state |%s_s|)) Bool ", get_id(module), get_id(module)));
 		if (GetSize(hier) > 1) {
-			f << "(and\n";
-			for (auto it : hier)
-				f << it;
-			f << "))\n";
+			emit("(and\n");
+			for (auto &it : hier)
+				emit(it);
+			emit("))\n");
 		} else
 		if (GetSize(hier) == 1)
-			f << "\n" + hier.front() + ")\n";
+			emit("\n" + hier.front() + ")\n");
 		else
-			f << "true)\n";
+			emit("true)\n");
 
-		f << stringf("(define-fun |%s_t| ((state |%s_s|) (next_state |%s_s|)) Bool ", get_id(module), get_id(module), get_id(module));
+		emit(stringf("(define-fun |%s_t| ((state |%s_s|) (next_state |%s_s|)) Bool ", get_id(module), get_id(module), get_id(module)));
 		if (GetSize(trans) > 1) {
-			f << "(and\n";
-			for (auto it : trans)
-				f << it;
-			f << "))";
+			emit("(and\n");
+			for (auto &it : trans)
+				emit(it);
+			emit("))");
 		} else
 		if (GetSize(trans) == 1)
-			f << "\n" + trans.front() + ")";
+			emit("\n" + trans.front() + ")");
 		else
-			f << "true)";
-		f << stringf(" ; end of module %s\n", get_id(module));
+			emit("true)");
+		emit(stringf(" ; end of module %s\n", get_id(module)));
+
+		f.write(buffer.data(), buffer.size());
 	}
 
 	template<class T> static std::vector<std::string> witness_path(T *obj) {
@@ -1699,6 +1766,12 @@ struct Smt2Backend : public Backend {
 		log("        create '<mod>_n' functions for all public wires. by default only ports,\n");
 		log("        registers, and wires with the 'keep' attribute are exported.\n");
 		log("\n");
+		log("    -coi\n");
+		log("        only export the logic in the cone of influence of the asserts,\n");
+		log("        assumes and covers (and of the ports and hierarchical cells of\n");
+		log("        non-top modules), and share identical combinational cells. registers\n");
+		log("        and top-level outputs outside of that cone are not exported.\n");
+		log("\n");
 		log("    -tpl <template_file>\n");
 		log("        use the given template file. the line containing only the token '%%%%'\n");
 		log("        is replaced with the regular output of this command.\n");
@@ -1760,7 +1833,7 @@ struct Smt2Backend : public Backend {
 	{
 		std::ifstream template_f;
 		bool bvmode = true, memmode = true, wiresmode = false, verbose = false, statebv = false, statedt = false;
-		bool forallmode = false;
+		bool forallmode = false, coimode = false;
 		dict<std::string, std::string> solver_options;
 
 		log_header(design, "Executing SMT2 backend.\n");
@@ -1810,6 +1883,10 @@ struct Smt2Backend : public Backend {
 				verbose = true;
 				continue;
 			}
+			if (args[argidx] == "-coi") {
+				coimode = true;
+				continue;
+			}
 			if (args[argidx] == "-solver-option" && argidx+2 < args.size()) {
 				solver_options.emplace(args[argidx+1], args[argidx+2]);
 				argidx += 2;
@@ -1827,7 +1904,7 @@ struct Smt2Backend : public Backend {
 					indent++;
 				if (line.compare(indent, 2, "%%") == 0)
 					break;
-				*f << line << std::endl;
+				*f << line << "\n";
 			}
 		}
 
@@ -1904,7 +1981,7 @@ struct Smt2Backend : public Backend {
 
 			log("Creating SMT-LIBv2 representation of module %s.\n", log_id(module));
 
-			Smt2Worker worker(module, bvmode, memmode, wiresmode, verbose, statebv, statedt, forallmode, mod_stbv_width, mod_clk_cache);
+			Smt2Worker worker(module, bvmode, memmode, wiresmode, verbose, statebv, statedt, forallmode, coimode, mod_stbv_width, mod_clk_cache);
 			worker.run();
 			worker.write(*f);
 
@@ -1920,7 +1997,7 @@ struct Smt2Backend : public Backend {
 		if (template_f.is_open()) {
 			std::string line;
 			while (std::getline(template_f, line))
-				*f << line << std::endl;
+				*f << line << "\n";
 		}
 	}
 } Smt2Backend;
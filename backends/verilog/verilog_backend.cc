@@ -39,6 +39,7 @@ PRIVATE_NAMESPACE_BEGIN
 bool verbose, norename, noattr, attr2comment, noexpr, nodec, nohex, nostr, extmem, defparam, decimal, siminit, systemverilog, simple_lhs, noparallelcase;
 int auto_name_counter, auto_name_offset, auto_name_digits, extmem_counter;
 dict<RTLIL::IdString, int> auto_name_map;
+dict<RTLIL::IdString, std::string> escaped_id_cache;
 std::set<RTLIL::IdString> reg_wires;
 std::string auto_prefix, extmem_prefix;
 
@@ -97,19 +98,40 @@ void reset_auto_counter(RTLIL::Module *module)
 			log("  renaming `%s' to `%s_%0*d_'.\n", it->first.c_str(), auto_prefix.c_str(), auto_name_digits, auto_name_offset + it->second);
 }
 
+std::string auto_id(int num)
+{
+	std::string digits = std::to_string(num);
+	std::string str = auto_prefix;
+	str += '_';
+	if (GetSize(digits) < auto_name_digits)
+		str.append(auto_name_digits - GetSize(digits), '0');
+	str += digits;
+	str += '_';
+	return str;
+}
+
 std::string next_auto_id()
 {
-	return stringf("%s_%0*d_", auto_prefix.c_str(), auto_name_digits, auto_name_offset + auto_name_counter++);
+	return auto_id(auto_name_offset + auto_name_counter++);
 }
 
 std::string id(RTLIL::IdString internal_id, bool may_rename = true)
 {
+	if (may_rename) {
+		auto it = auto_name_map.find(internal_id);
+		if (it != auto_name_map.end())
+			return auto_id(auto_name_offset + it->second);
+	}
+
+	// The escaped form only depends on the name itself, and the same names
+	// are looked up over and over again when dumping large netlists.
+	auto it = escaped_id_cache.find(internal_id);
+	if (it != escaped_id_cache.end())
+		return it->second;
+
 	const char *str = internal_id.c_str();
 	bool do_escape = false;
 
-	if (may_rename && auto_name_map.count(internal_id) != 0)
-		return stringf("%s_%0*d_", auto_prefix.c_str(), auto_name_digits, auto_name_offset + auto_name_map[internal_id]);
-
 	if (*str == '\\')
 		str++;
 
@@ -157,9 +179,12 @@ std::string id(RTLIL::IdString internal_id, bool may_rename = true)
 	if (keywords.count(str))
 		do_escape = true;
 
+	std::string &escaped = escaped_id_cache[internal_id];
 	if (do_escape)
-		return "\\" + std::string(str) + " ";
-	return std::string(str);
+		escaped = "\\" + std::string(str) + " ";
+	else
+		escaped = str;
+	return escaped;
 }
 
 bool is_reg_wire(RTLIL::SigSpec sig, std::string &reg_name)
@@ -210,11 +235,11 @@ void dump_const(std::ostream &f, const RTLIL::Const &data, int width = -1, int o
 					val |= 1 << (i - offset);
 			}
 			if (decimal)
-				f << stringf("%d", val);
+				f << val;
 			else if (set_signed && val < 0)
-				f << stringf("-32'sd%u", -val);
+				f << "-32'sd" << -(uint32_t)val;
 			else
-				f << stringf("32'%sd%u", set_signed ? "s" : "", val);
+				f << (set_signed ? "32'sd" : "32'd") << (uint32_t)val;
 		} else {
 	dump_hex:
 			if (nohex)
@@ -273,41 +298,41 @@ void dump_const(std::ostream &f, const RTLIL::Const &data, int width = -1, int o
 	dump_bin:
 			f << stringf("%d'%sb", width, set_signed ? "s" : "");
 			if (width == 0)
-				f << stringf("0");
+				f << "0";
 			for (int i = offset+width-1; i >= offset; i--) {
 				log_assert(i < (int)data.size());
 				switch (data[i]) {
-				case State::S0: f << stringf("0"); break;
-				case State::S1: f << stringf("1"); break;
-				case RTLIL::Sx: f << stringf("x"); break;
-				case RTLIL::Sz: f << stringf("z"); break;
-				case RTLIL::Sa: f << stringf("?"); break;
+				case State::S0: f << "0"; break;
+				case State::S1: f << "1"; break;
+				case RTLIL::Sx: f << "x"; break;
+				case RTLIL::Sz: f << "z"; break;
+				case RTLIL::Sa: f << "?"; break;
 				case RTLIL::Sm: log_error("Found marker state in final netlist.");
 				}
 			}
 		}
 	} else {
 		if ((data.flags & RTLIL::CONST_FLAG_REAL) == 0)
-			f << stringf("\"");
+			f << "\"";
 		std::string str = data.decode_string();
 		for (size_t i = 0; i < str.size(); i++) {
 			if (str[i] == '\n')
-				f << stringf("\\n");
+				f << "\\n";
 			else if (str[i] == '\t')
-				f << stringf("\\t");
+				f << "\\t";
 			else if (str[i] < 32)
 				f << stringf("\\%03o", str[i]);
 			else if (str[i] == '"')
-				f << stringf("\\\"");
+				f << "\\\"";
 			else if (str[i] == '\\')
-				f << stringf("\\\\");
+				f << "\\\\";
 			else if (str[i] == '/' && escape_comment && i > 0 && str[i-1] == '*')
-				f << stringf("\\/");
+				f << "\\/";
 			else
 				f << str[i];
 		}
 		if ((data.flags & RTLIL::CONST_FLAG_REAL) == 0)
-			f << stringf("\"");
+			f << "\"";
 	}
 }
 
@@ -336,22 +361,21 @@ void dump_sigchunk(std::ostream &f, const RTLIL::SigChunk &chunk, bool no_decima
 	if (chunk.wire == NULL) {
 		dump_const(f, chunk.data, chunk.width, chunk.offset, no_decimal);
 	} else {
-		if (chunk.width == chunk.wire->width && chunk.offset == 0) {
-			f << stringf("%s", id(chunk.wire->name).c_str());
-		} else if (chunk.width == 1) {
+		f << id(chunk.wire->name);
+		if (chunk.width == chunk.wire->width && chunk.offset == 0)
+			return;
+		if (chunk.width == 1) {
 			if (chunk.wire->upto)
-				f << stringf("%s[%d]", id(chunk.wire->name).c_str(), (chunk.wire->width - chunk.offset - 1) + chunk.wire->start_offset);
+				f << '[' << (chunk.wire->width - chunk.offset - 1) + chunk.wire->start_offset << ']';
 			else
-				f << stringf("%s[%d]", id(chunk.wire->name).c_str(), chunk.offset + chunk.wire->start_offset);
+				f << '[' << chunk.offset + chunk.wire->start_offset << ']';
 		} else {
 			if (chunk.wire->upto)
-				f << stringf("%s[%d:%d]", id(chunk.wire->name).c_str(),
-						(chunk.wire->width - (chunk.offset + chunk.width - 1) - 1) + chunk.wire->start_offset,
-						(chunk.wire->width - chunk.offset - 1) + chunk.wire->start_offset);
+				f << '[' << (chunk.wire->width - (chunk.offset + chunk.width - 1) - 1) + chunk.wire->start_offset
+						<< ':' << (chunk.wire->width - chunk.offset - 1) + chunk.wire->start_offset << ']';
 			else
-				f << stringf("%s[%d:%d]", id(chunk.wire->name).c_str(),
-						(chunk.offset + chunk.width - 1) + chunk.wire->start_offset,
-						chunk.offset + chunk.wire->start_offset);
+				f << '[' << (chunk.offset + chunk.width - 1) + chunk.wire->start_offset
+						<< ':' << chunk.offset + chunk.wire->start_offset << ']';
 		}
 	}
 }
@@ -366,13 +390,13 @@ void dump_sigspec(std::ostream &f, const RTLIL::SigSpec &sig)
 	if (sig.is_chunk()) {
 		dump_sigchunk(f, sig.as_chunk());
 	} else {
-		f << stringf("{ ");
+		f << "{ ";
 		for (auto it = sig.chunks().rbegin(); it != sig.chunks().rend(); ++it) {
 			if (it != sig.chunks().rbegin())
-				f << stringf(", ");
+				f << ", ";
 			dump_sigchunk(f, *it, true);
 		}
-		f << stringf(" }");
+		f << " }";
 	}
 }
 
@@ -386,11 +410,11 @@ void dump_attributes(std::ostream &f, std::string indent, dict<RTLIL::IdString,
 		if (it->first == ID::single_bit_vector) continue;
 		if (it->first == ID::init && regattr) continue;
 		f << stringf("%s" "%s %s", indent.c_str(), as_comment ? "/*" : "(*", id(it->first).c_str());
-		f << stringf(" = ");
+		f << " = ";
 		if (modattr && (it->second == State::S0 || it->second == Const(0)))
-			f << stringf(" 0 ");
+			f << " 0 ";
 		else if (modattr && (it->second == State::S1 || it->second == Const(1)))
-			f << stringf(" 1 ");
+			f << " 1 ";
 		else
 			dump_const(f, it->second, -1, 0, false, as_comment);
 		f << stringf(" %s%s", as_comment ? "*/" : "*)", term.c_str());
@@ -433,10 +457,10 @@ void dump_wire(std::ostream &f, std::string indent, RTLIL::Wire *wire)
 	if (reg_wires.count(wire->name)) {
 		f << stringf("%s" "reg%s %s", indent.c_str(), range.c_str(), id(wire->name).c_str());
 		if (wire->attributes.count(ID::init)) {
-			f << stringf(" = ");
+			f << " = ";
 			dump_const(f, wire->attributes.at(ID::init));
 		}
-		f << stringf(";\n");
+		f << ";\n";
 	} else
 		f << stringf("%s" "wire%s %s;\n", indent.c_str(), range.c_str(), id(wire->name).c_str());
 #endif
@@ -527,7 +551,7 @@ void dump_memory(std::ostream &f, std::string indent, Mem &mem)
 							f << stringf("%s" "  %s[%d][%d:%d] = ", indent.c_str(), mem_id.c_str(), i + start, j, start_j);
 						}
 						dump_const(f, init.data.extract(i*mem.width+start_j, width));
-						f << stringf(";\n");
+						f << ";\n";
 					}
 				}
 			}
@@ -595,9 +619,9 @@ void dump_memory(std::ostream &f, std::string indent, Mem &mem)
 
 				if (port.srst != State::S0 && !port.ce_over_srst) {
 					std::ostringstream os;
-					os << stringf("if (");
+					os << "if (";
 					dump_sigspec(os, port.srst);
-					os << stringf(")\n");
+					os << ")\n";
 					clk_to_lof_body[clk_domain_str].push_back(os.str());
 					std::ostringstream os2;
 					os2 << stringf("%s" "%s <= ", indent.c_str(), temp_id.c_str());
@@ -616,9 +640,9 @@ void dump_memory(std::ostream &f, std::string indent, Mem &mem)
 					has_indent = true;
 				} else if (port.en != State::S1) {
 					std::ostringstream os;
-					os << stringf("if (");
+					os << "if (";
 					dump_sigspec(os, port.en);
-					os << stringf(") begin\n");
+					os << ") begin\n";
 					clk_to_lof_body[clk_domain_str].push_back(os.str());
 					has_indent = true;
 				}
@@ -634,7 +658,7 @@ void dump_memory(std::ostream &f, std::string indent, Mem &mem)
 						os << stringf("[%d:%d]", (sub + 1) * mem.width - 1, sub * mem.width);
 					os << stringf(" <= %s[", mem_id.c_str());
 					dump_sigspec(os, addr);
-					os << stringf("];\n");
+					os << "];\n";
 					clk_to_lof_body[clk_domain_str].push_back(os.str());
 				}
 
@@ -700,9 +724,9 @@ void dump_memory(std::ostream &f, std::string indent, Mem &mem)
 					std::ostringstream os;
 					if (has_indent)
 						os << indent;
-					os << stringf("if (");
+					os << "if (";
 					dump_sigspec(os, port.srst);
-					os << stringf(")\n");
+					os << ")\n";
 					clk_to_lof_body[clk_domain_str].push_back(os.str());
 					std::ostringstream os2;
 					if (has_indent)
@@ -868,19 +892,19 @@ void dump_memory(std::ostream &f, std::string indent, Mem &mem)
 					f << stringf("%s%s", indent.c_str(), indent.c_str());
 					if (wen_bit != State::S1)
 					{
-						f << stringf("if (");
+						f << "if (";
 						dump_sigspec(f, wen_bit);
-						f << stringf(")\n");
+						f << ")\n";
 						f << stringf("%s%s%s", indent.c_str(), indent.c_str(), indent.c_str());
 					}
 					f << stringf("%s[", mem_id.c_str());
 					dump_sigspec(f, addr);
 					if (width == GetSize(port.en))
-						f << stringf("] <= ");
+						f << "] <= ";
 					else
 						f << stringf("][%d:%d] <= ", i, start_i);
 					dump_sigspec(f, port.data.extract(sub * mem.width + start_i, width));
-					f << stringf(";\n");
+					f << ";\n";
 				}
 			}
 		}
@@ -945,9 +969,9 @@ void dump_memory(std::ostream &f, std::string indent, Mem &mem)
 void dump_cell_expr_port(std::ostream &f, RTLIL::Cell *cell, std::string port, bool gen_signed = true)
 {
 	if (gen_signed && cell->parameters.count("\\" + port + "_SIGNED") > 0 && cell->parameters["\\" + port + "_SIGNED"].as_bool()) {
-		f << stringf("$signed(");
+		f << "$signed(";
 		dump_sigspec(f, cell->getPort("\\" + port));
-		f << stringf(")");
+		f << ")";
 	} else
 		dump_sigspec(f, cell->getPort("\\" + port));
 }
@@ -995,19 +1019,19 @@ void dump_cell_expr_uniop(std::ostream &f, std::string indent, RTLIL::Cell *cell
 	f << stringf(" = %s ", op.c_str());
 	dump_attributes(f, "", cell->attributes, " ");
 	dump_cell_expr_port(f, cell, "A", true);
-	f << stringf(";\n");
+	f << ";\n";
 }
 
 void dump_cell_expr_binop(std::ostream &f, std::string indent, RTLIL::Cell *cell, std::string op)
 {
 	f << stringf("%s" "assign ", indent.c_str());
 	dump_sigspec(f, cell->getPort(ID::Y));
-	f << stringf(" = ");
+	f << " = ";
 	dump_cell_expr_port(f, cell, "A", true);
 	f << stringf(" %s ", op.c_str());
 	dump_attributes(f, "", cell->attributes, " ");
 	dump_cell_expr_port(f, cell, "B", true);
-	f << stringf(";\n");
+	f << ";\n";
 }
 
 void dump_cell_expr_print(std::ostream &f, std::string indent, const RTLIL::Cell *cell)
@@ -1042,7 +1066,7 @@ void dump_cell_expr_print(std::ostream &f, std::string indent, const RTLIL::Cell
 			default: log_abort();
 		}
 	}
-	f << stringf(");\n");
+	f << ");\n";
 }
 
 void dump_cell_expr_check(std::ostream &f, std::string indent, const RTLIL::Cell *cell)
@@ -1066,7 +1090,7 @@ void dump_cell_expr_check(std::ostream &f, std::string indent, const RTLIL::Cell
 	else
 		log_abort();
 	dump_sigspec(f, cell->getPort(ID::A));
-	f << stringf(");\n");
+	f << ");\n";
 }
 
 bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
@@ -1074,105 +1098,105 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 	if (cell->type == ID($_NOT_)) {
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::Y));
-		f << stringf(" = ");
-		f << stringf("~");
+		f << " = ";
+		f << "~";
 		dump_attributes(f, "", cell->attributes, " ");
 		dump_cell_expr_port(f, cell, "A", false);
-		f << stringf(";\n");
+		f << ";\n";
 		return true;
 	}
 
 	if (cell->type.in(ID($_BUF_), ID($buf))) {
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::Y));
-		f << stringf(" = ");
+		f << " = ";
 		dump_cell_expr_port(f, cell, "A", false);
-		f << stringf(";\n");
+		f << ";\n";
 		return true;
 	}
 
 	if (cell->type.in(ID($_AND_), ID($_NAND_), ID($_OR_), ID($_NOR_), ID($_XOR_), ID($_XNOR_), ID($_ANDNOT_), ID($_ORNOT_))) {
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::Y));
-		f << stringf(" = ");
+		f << " = ";
 		if (cell->type.in(ID($_NAND_), ID($_NOR_), ID($_XNOR_)))
-			f << stringf("~(");
+			f << "~(";
 		dump_cell_expr_port(f, cell, "A", false);
-		f << stringf(" ");
+		f << " ";
 		if (cell->type.in(ID($_AND_), ID($_NAND_), ID($_ANDNOT_)))
-			f << stringf("&");
+			f << "&";
 		if (cell->type.in(ID($_OR_), ID($_NOR_), ID($_ORNOT_)))
-			f << stringf("|");
+			f << "|";
 		if (cell->type.in(ID($_XOR_), ID($_XNOR_)))
-			f << stringf("^");
+			f << "^";
 		dump_attributes(f, "", cell->attributes, " ");
-		f << stringf(" ");
+		f << " ";
 		if (cell->type.in(ID($_ANDNOT_), ID($_ORNOT_)))
-			f << stringf("~(");
+			f << "~(";
 		dump_cell_expr_port(f, cell, "B", false);
 		if (cell->type.in(ID($_NAND_), ID($_NOR_), ID($_XNOR_), ID($_ANDNOT_), ID($_ORNOT_)))
-			f << stringf(")");
-		f << stringf(";\n");
+			f << ")";
+		f << ";\n";
 		return true;
 	}
 
 	if (cell->type == ID($_MUX_)) {
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::Y));
-		f << stringf(" = ");
+		f << " = ";
 		dump_cell_expr_port(f, cell, "S", false);
-		f << stringf(" ? ");
+		f << " ? ";
 		dump_attributes(f, "", cell->attributes, " ");
 		dump_cell_expr_port(f, cell, "B", false);
-		f << stringf(" : ");
+		f << " : ";
 		dump_cell_expr_port(f, cell, "A", false);
-		f << stringf(";\n");
+		f << ";\n";
 		return true;
 	}
 
 	if (cell->type == ID($_NMUX_)) {
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::Y));
-		f << stringf(" = !(");
+		f << " = !(";
 		dump_cell_expr_port(f, cell, "S", false);
-		f << stringf(" ? ");
+		f << " ? ";
 		dump_attributes(f, "", cell->attributes, " ");
 		dump_cell_expr_port(f, cell, "B", false);
-		f << stringf(" : ");
+		f << " : ";
 		dump_cell_expr_port(f, cell, "A", false);
-		f << stringf(");\n");
+		f << ");\n";
 		return true;
 	}
 
 	if (cell->type.in(ID($_AOI3_), ID($_OAI3_))) {
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::Y));
-		f << stringf(" = ~((");
+		f << " = ~((";
 		dump_cell_expr_port(f, cell, "A", false);
 		f << stringf(cell->type == ID($_AOI3_) ? " & " : " | ");
 		dump_cell_expr_port(f, cell, "B", false);
 		f << stringf(cell->type == ID($_AOI3_) ? ") |" : ") &");
 		dump_attributes(f, "", cell->attributes, " ");
-		f << stringf(" ");
+		f << " ";
 		dump_cell_expr_port(f, cell, "C", false);
-		f << stringf(");\n");
+		f << ");\n";
 		return true;
 	}
 
 	if (cell->type.in(ID($_AOI4_), ID($_OAI4_))) {
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::Y));
-		f << stringf(" = ~((");
+		f << " = ~((";
 		dump_cell_expr_port(f, cell, "A", false);
 		f << stringf(cell->type == ID($_AOI4_) ? " & " : " | ");
 		dump_cell_expr_port(f, cell, "B", false);
 		f << stringf(cell->type == ID($_AOI4_) ? ") |" : ") &");
 		dump_attributes(f, "", cell->attributes, " ");
-		f << stringf(" (");
+		f << " (";
 		dump_cell_expr_port(f, cell, "C", false);
 		f << stringf(cell->type == ID($_AOI4_) ? " & " : " | ");
 		dump_cell_expr_port(f, cell, "D", false);
-		f << stringf("));\n");
+		f << "));\n";
 		return true;
 	}
 
@@ -1248,17 +1272,17 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 			f << stringf("%s" "wire [%d:0] %s, %s, %s;\n", indent.c_str(), size_max, buf_a.c_str(), buf_b.c_str(), buf_num.c_str());
 			f << stringf("%s" "assign %s = ", indent.c_str(), buf_a.c_str());
 			dump_cell_expr_port(f, cell, "A", true);
-			f << stringf(";\n");
+			f << ";\n";
 			f << stringf("%s" "assign %s = ", indent.c_str(), buf_b.c_str());
 			dump_cell_expr_port(f, cell, "B", true);
-			f << stringf(";\n");
+			f << ";\n";
 
 			f << stringf("%s" "assign %s = ", indent.c_str(), buf_num.c_str());
-			f << stringf("(");
+			f << "(";
 			dump_sigspec(f, sig_a.extract(sig_a.size()-1));
-			f << stringf(" == ");
+			f << " == ";
 			dump_sigspec(f, sig_b.extract(sig_b.size()-1));
-			f << stringf(") || ");
+			f << ") || ";
 			dump_sigspec(f, sig_a);
 			f << stringf(" == 0 ? %s : ", buf_a.c_str());
 			f << stringf("$signed(%s - (", buf_a.c_str());
@@ -1294,13 +1318,13 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 			f << stringf(" %% ");
 			dump_attributes(f, "", cell->attributes, " ");
 			dump_cell_expr_port(f, cell, "B", true);
-			f << stringf(";\n");
+			f << ";\n";
 
 			f << stringf("%s" "assign ", indent.c_str());
 			dump_sigspec(f, cell->getPort(ID::Y));
-			f << stringf(" = (");
+			f << " = (";
 			dump_sigspec(f, sig_a.extract(sig_a.size()-1));
-			f << stringf(" == ");
+			f << " == ";
 			dump_sigspec(f, sig_b.extract(sig_b.size()-1));
 			f << stringf(") || %s == 0 ? $signed(%s) : ", temp_id.c_str(), temp_id.c_str());
 			dump_cell_expr_port(f, cell, "B", true);
@@ -1317,26 +1341,26 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 	{
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::Y));
-		f << stringf(" = ");
+		f << " = ";
 		if (cell->getParam(ID::B_SIGNED).as_bool())
 		{
 			dump_cell_expr_port(f, cell, "B", true);
-			f << stringf(" < 0 ? ");
+			f << " < 0 ? ";
 			dump_cell_expr_port(f, cell, "A", true);
-			f << stringf(" << - ");
+			f << " << - ";
 			dump_sigspec(f, cell->getPort(ID::B));
-			f << stringf(" : ");
+			f << " : ";
 			dump_cell_expr_port(f, cell, "A", true);
-			f << stringf(" >> ");
+			f << " >> ";
 			dump_sigspec(f, cell->getPort(ID::B));
 		}
 		else
 		{
 			dump_cell_expr_port(f, cell, "A", true);
-			f << stringf(" >> ");
+			f << " >> ";
 			dump_sigspec(f, cell->getPort(ID::B));
 		}
-		f << stringf(";\n");
+		f << ";\n";
 		return true;
 	}
 
@@ -1345,18 +1369,18 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 		std::string temp_id = next_auto_id();
 		f << stringf("%s" "wire [%d:0] %s = ", indent.c_str(), GetSize(cell->getPort(ID::A))-1, temp_id.c_str());
 		dump_sigspec(f, cell->getPort(ID::A));
-		f << stringf(";\n");
+		f << ";\n";
 
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::Y));
 		f << stringf(" = %s[", temp_id.c_str());
 		if (cell->getParam(ID::B_SIGNED).as_bool())
-			f << stringf("$signed(");
+			f << "$signed(";
 		dump_sigspec(f, cell->getPort(ID::B));
 		if (cell->getParam(ID::B_SIGNED).as_bool())
-			f << stringf(")");
+			f << ")";
 		f << stringf(" +: %d", cell->getParam(ID::Y_WIDTH).as_int());
-		f << stringf("];\n");
+		f << "];\n";
 		return true;
 	}
 
@@ -1364,14 +1388,14 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 	{
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::Y));
-		f << stringf(" = ");
+		f << " = ";
 		dump_sigspec(f, cell->getPort(ID::S));
-		f << stringf(" ? ");
+		f << " ? ";
 		dump_attributes(f, "", cell->attributes, " ");
 		dump_sigspec(f, cell->getPort(ID::B));
-		f << stringf(" : ");
+		f << " : ";
 		dump_sigspec(f, cell->getPort(ID::A));
-		f << stringf(";\n");
+		f << ";\n";
 		return true;
 	}
 
@@ -1403,7 +1427,7 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 			for (int j = s_width-1; j >= 0; j--)
 				f << stringf("%c", j == i ? '1' : noparallelcase ? '0' : '?');
 
-			f << stringf(":\n");
+			f << ":\n";
 			f << stringf("%s" "      %s = b[%d:%d];\n", indent.c_str(), func_name.c_str(), (i+1)*width-1, i*width);
 		}
 
@@ -1411,7 +1435,7 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 			f << stringf("%s" "    %d'b", indent.c_str(), s_width);
 			for (int j = s_width-1; j >= 0; j--)
 				f << '0';
-			f << stringf(":\n");
+			f << ":\n";
 		} else
 			f << stringf("%s" "    default:\n", indent.c_str());
 		f << stringf("%s" "      %s = a;\n", indent.c_str(), func_name.c_str());
@@ -1427,11 +1451,11 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 		dump_sigspec(f, cell->getPort(ID::Y));
 		f << stringf(" = %s(", func_name.c_str());
 		dump_sigspec(f, cell->getPort(ID::A));
-		f << stringf(", ");
+		f << ", ";
 		dump_sigspec(f, cell->getPort(ID::B));
-		f << stringf(", ");
+		f << ", ";
 		dump_sigspec(f, cell->getPort(ID::S));
-		f << stringf(");\n");
+		f << ");\n";
 		return true;
 	}
 
@@ -1439,9 +1463,9 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 	{
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::Y));
-		f << stringf(" = ");
+		f << " = ";
 		dump_sigspec(f, cell->getPort(ID::EN));
-		f << stringf(" ? ");
+		f << " ? ";
 		dump_sigspec(f, cell->getPort(ID::A));
 		f << stringf(" : %d'bz;\n", cell->parameters.at(ID::WIDTH).as_int());
 		return true;
@@ -1451,7 +1475,7 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 	{
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::Y));
-		f << stringf(" = ");
+		f << " = ";
 		dump_sigspec(f, cell->getPort(ID::A));
 		f << stringf(" >> %d;\n", cell->parameters.at(ID::OFFSET).as_int());
 		return true;
@@ -1461,11 +1485,11 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 	{
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::Y));
-		f << stringf(" = { ");
+		f << " = { ";
 		dump_sigspec(f, cell->getPort(ID::B));
-		f << stringf(" , ");
+		f << " , ";
 		dump_sigspec(f, cell->getPort(ID::A));
-		f << stringf(" };\n");
+		f << " };\n";
 		return true;
 	}
 
@@ -1473,12 +1497,12 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 	{
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::Y));
-		f << stringf(" = ");
+		f << " = ";
 		dump_const(f, cell->parameters.at(ID::LUT));
-		f << stringf(" >> ");
+		f << " >> ";
 		dump_attributes(f, "", cell->attributes, " ");
 		dump_sigspec(f, cell->getPort(ID::A));
-		f << stringf(";\n");
+		f << ";\n";
 		return true;
 	}
 
@@ -1535,14 +1559,14 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 						sig_set_name = next_auto_id();
 						f << stringf("%s" "wire %s = ", indent.c_str(), sig_set_name.c_str());
 						dump_const(f, ff.sig_set[i].data);
-						f << stringf(";\n");
+						f << ";\n";
 					}
 					if (ff.sig_clr[i].wire == NULL)
 					{
 						sig_clr_name = next_auto_id();
 						f << stringf("%s" "wire %s = ", indent.c_str(), sig_clr_name.c_str());
 						dump_const(f, ff.sig_clr[i].data);
-						f << stringf(";\n");
+						f << ";\n";
 					}
 				} else if (ff.has_arst) {
 					if (ff.sig_arst[0].wire == NULL)
@@ -1550,7 +1574,7 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 						sig_arst_name = next_auto_id();
 						f << stringf("%s" "wire %s = ", indent.c_str(), sig_arst_name.c_str());
 						dump_const(f, ff.sig_arst[0].data);
-						f << stringf(";\n");
+						f << ";\n";
 					}
 				} else if (ff.has_aload) {
 					if (ff.sig_aload[0].wire == NULL)
@@ -1558,7 +1582,7 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 						sig_aload_name = next_auto_id();
 						f << stringf("%s" "wire %s = ", indent.c_str(), sig_aload_name.c_str());
 						dump_const(f, ff.sig_aload[0].data);
-						f << stringf(";\n");
+						f << ";\n";
 					}
 				}
 			}
@@ -1594,7 +1618,7 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 					else
 						dump_sigspec(f, ff.sig_aload);
 				}
-				f << stringf(")\n");
+				f << ")\n";
 
 				f << stringf("%s" "  ", indent.c_str());
 				if (ff.has_sr) {
@@ -1619,7 +1643,7 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 						dump_sigspec(f, ff.sig_arst);
 					f << stringf(") %s <= ", reg_bit_name.c_str());
 					dump_sigspec(f, val_arst);
-					f << stringf(";\n");
+					f << ";\n";
 					f << stringf("%s" "  else ", indent.c_str());
 				} else if (ff.has_aload) {
 					f << stringf("if (%s", ff.pol_aload ? "" : "!");
@@ -1629,19 +1653,19 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 						dump_sigspec(f, ff.sig_aload);
 					f << stringf(") %s <= ", reg_bit_name.c_str());
 					dump_sigspec(f, sig_ad);
-					f << stringf(";\n");
+					f << ";\n";
 					f << stringf("%s" "  else ", indent.c_str());
 				}
 
 				if (ff.has_srst && ff.has_ce && ff.ce_over_srst) {
 					f << stringf("if (%s", ff.pol_ce ? "" : "!");
 					dump_sigspec(f, ff.sig_ce);
-					f << stringf(")\n");
+					f << ")\n";
 					f << stringf("%s" "    if (%s", indent.c_str(), ff.pol_srst ? "" : "!");
 					dump_sigspec(f, ff.sig_srst);
 					f << stringf(") %s <= ", reg_bit_name.c_str());
 					dump_sigspec(f, val_srst);
-					f << stringf(";\n");
+					f << ";\n";
 					f << stringf("%s" "    else ", indent.c_str());
 				} else {
 					if (ff.has_srst) {
@@ -1649,19 +1673,19 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 						dump_sigspec(f, ff.sig_srst);
 						f << stringf(") %s <= ", reg_bit_name.c_str());
 						dump_sigspec(f, val_srst);
-						f << stringf(";\n");
+						f << ";\n";
 						f << stringf("%s" "  else ", indent.c_str());
 					}
 					if (ff.has_ce) {
 						f << stringf("if (%s", ff.pol_ce ? "" : "!");
 						dump_sigspec(f, ff.sig_ce);
-						f << stringf(") ");
+						f << ") ";
 					}
 				}
 
 				f << stringf("%s <= ", reg_bit_name.c_str());
 				dump_sigspec(f, sig_d);
-				f << stringf(";\n");
+				f << ";\n";
 			}
 			else
 			{
@@ -1683,7 +1707,7 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 					dump_sigspec(f, ff.sig_arst);
 					f << stringf(") %s = ", reg_bit_name.c_str());
 					dump_sigspec(f, val_arst);
-					f << stringf(";\n");
+					f << ";\n";
 					if (ff.has_aload)
 						f << stringf("%s" "  else ", indent.c_str());
 				}
@@ -1692,7 +1716,7 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 					dump_sigspec(f, ff.sig_aload);
 					f << stringf(") %s = ", reg_bit_name.c_str());
 					dump_sigspec(f, sig_ad);
-					f << stringf(";\n");
+					f << ";\n";
 				}
 			}
 		}
@@ -1712,7 +1736,7 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 		dump_sigspec(f, cell->getPort(ID::EN));
 		f << stringf(") %s(", cell->type.c_str()+1);
 		dump_sigspec(f, cell->getPort(ID::A));
-		f << stringf(");\n");
+		f << ");\n";
 		return true;
 	}
 
@@ -1722,9 +1746,9 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 
 		SigSpec en = cell->getPort(ID::EN);
 		if (en != State::S1) {
-			f << stringf("if (");
+			f << "if (";
 			dump_sigspec(f, cell->getPort(ID::EN));
-			f << stringf(") ");
+			f << ") ";
 		}
 
 		f << "(";
@@ -1836,7 +1860,7 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 
 		f << stringf("%s" "  if (", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::EN));
-		f << stringf(")\n");
+		f << ")\n";
 
 		dump_cell_expr_print(f, indent + "    ", cell);
 		return true;
@@ -1852,7 +1876,7 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 
 		f << stringf("%s" "  if (", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::EN));
-		f << stringf(") begin\n");
+		f << ") begin\n";
 
 		std::string flavor = cell->getParam(ID::FLAVOR).decode_string();
 		if (flavor == "assert" || flavor == "assume") {
@@ -1861,7 +1885,7 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 			if (!fmt.parts.empty()) {
 				f << stringf("%s" "    if (!", indent.c_str());
 				dump_sigspec(f, cell->getPort(ID::A));
-				f << stringf(")\n");
+				f << ")\n";
 				dump_cell_expr_print(f, indent + "      ", cell);
 			}
 		} else {
@@ -1902,21 +1926,22 @@ void dump_cell(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 	f << stringf("%s" "%s", indent.c_str(), id(cell->type, false).c_str());
 
 	if (!defparam && cell->parameters.size() > 0) {
-		f << stringf(" #(");
+		f << " #(";
 		for (auto it = cell->parameters.begin(); it != cell->parameters.end(); ++it) {
 			if (it != cell->parameters.begin())
-				f << stringf(",");
+				f << ",";
 			f << stringf("\n%s  .%s(", indent.c_str(), id(it->first).c_str());
 			if (it->second.size() > 0)
 				dump_const(f, it->second);
-			f << stringf(")");
+			f << ")";
 		}
 		f << stringf("\n%s" ")", indent.c_str());
 	}
 
 	std::string cell_name = cellname(cell);
-	if (cell_name != id(cell->name))
-		f << stringf(" %s /* %s */ (", cell_name.c_str(), id(cell->name).c_str());
+	std::string cell_id = id(cell->name);
+	if (cell_name != cell_id)
+		f << stringf(" %s /* %s */ (", cell_name.c_str(), cell_id.c_str());
 	else
 		f << stringf(" %s (", cell_name.c_str());
 
@@ -1929,7 +1954,7 @@ void dump_cell(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 			if (it->first != str)
 				continue;
 			if (!first_arg)
-				f << stringf(",");
+				f << ",";
 			first_arg = false;
 			f << stringf("\n%s  ", indent.c_str());
 			dump_sigspec(f, it->second);
@@ -1943,12 +1968,12 @@ void dump_cell(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 		if (numbered_ports.count(it->first))
 			continue;
 		if (!first_arg)
-			f << stringf(",");
+			f << ",";
 		first_arg = false;
 		f << stringf("\n%s  .%s(", indent.c_str(), id(it->first).c_str());
 		if (it->second.size() > 0)
 			dump_sigspec(f, it->second);
-		f << stringf(")");
+		f << ")";
 	}
 	f << stringf("\n%s" ");\n", indent.c_str());
 
@@ -1956,7 +1981,7 @@ void dump_cell(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 		for (auto it = cell->parameters.begin(); it != cell->parameters.end(); ++it) {
 			f << stringf("%sdefparam %s.%s = ", indent.c_str(), cell_name.c_str(), id(it->first).c_str());
 			dump_const(f, it->second);
-			f << stringf(";\n");
+			f << ";\n";
 		}
 	}
 
@@ -1995,7 +2020,7 @@ void dump_sync_effect(std::ostream &f, std::string indent, const RTLIL::SigSpec
 	for (auto cell : cells) {
 		f << stringf("%s" "  if (", indent.c_str());
 		dump_sigspec(f, cell->getPort(ID::EN));
-		f << stringf(") begin\n");
+		f << ") begin\n";
 
 		if (cell->type == ID($print)) {
 			dump_cell_expr_print(f, indent + "    ", cell);
@@ -2007,7 +2032,7 @@ void dump_sync_effect(std::ostream &f, std::string indent, const RTLIL::SigSpec
 				if (!fmt.parts.empty()) {
 					f << stringf("%s" "    if (!", indent.c_str());
 					dump_sigspec(f, cell->getPort(ID::A));
-					f << stringf(")\n");
+					f << ")\n";
 					dump_cell_expr_print(f, indent + "      ", cell);
 				}
 			} else {
@@ -2032,9 +2057,9 @@ void dump_conn(std::ostream &f, std::string indent, const RTLIL::SigSpec &left,
 	if (!simple_lhs && all_chunks_wires) {
 		f << stringf("%s" "assign ", indent.c_str());
 		dump_sigspec(f, left);
-		f << stringf(" = ");
+		f << " = ";
 		dump_sigspec(f, right);
-		f << stringf(";\n");
+		f << ";\n";
 	} else {
 		int offset = 0;
 		for (auto &chunk : left.chunks()) {
@@ -2043,9 +2068,9 @@ void dump_conn(std::ostream &f, std::string indent, const RTLIL::SigSpec &left,
 			else
 				f << stringf("%s" "assign ", indent.c_str());
 			dump_sigspec(f, chunk);
-			f << stringf(" = ");
+			f << " = ";
 			dump_sigspec(f, right.extract(offset, GetSize(chunk)));
-			f << stringf(";\n");
+			f << ";\n";
 			offset += GetSize(chunk);
 		}
 	}
@@ -2060,9 +2085,9 @@ void dump_case_actions(std::ostream &f, std::string indent, RTLIL::CaseRule *cs)
 			continue;
 		f << stringf("%s  ", indent.c_str());
 		dump_sigspec(f, it->first);
-		f << stringf(" = ");
+		f << " = ";
 		dump_sigspec(f, it->second);
-		f << stringf(";\n");
+		f << ";\n";
 	}
 }
 
@@ -2097,9 +2122,9 @@ bool dump_proc_switch_ifelse(std::ostream &f, std::string indent, RTLIL::SwitchR
 				f << " else ";
 		}
 		if (!(*it)->compare.empty()) {
-			f << stringf("if (");
+			f << "if (";
 			dump_sigspec(f, *sig_it);
-			f << stringf(") begin\n");
+			f << ") begin\n";
 		}
 
 		dump_case_actions(f, indent, (*it));
@@ -2150,7 +2175,7 @@ void dump_proc_switch(std::ostream &f, std::string indent, RTLIL::SwitchRule *sw
 	dump_attributes(f, indent, sw->attributes);
 	f << stringf("%s" "casez (", indent.c_str());
 	dump_sigspec(f, sw->signal);
-	f << stringf(")\n");
+	f << ")\n";
 
 	for (auto it = sw->cases.begin(); it != sw->cases.end(); ++it) {
 		bool got_default = false;
@@ -2162,11 +2187,11 @@ void dump_proc_switch(std::ostream &f, std::string indent, RTLIL::SwitchRule *sw
 			f << stringf("%s  ", indent.c_str());
 			for (size_t i = 0; i < (*it)->compare.size(); i++) {
 				if (i > 0)
-					f << stringf(", ");
+					f << ", ";
 				dump_sigspec(f, (*it)->compare[i]);
 			}
 		}
-		f << stringf(":\n");
+		f << ":\n";
 		dump_case_body(f, indent + "    ", *it);
 
 		if (got_default) {
@@ -2231,11 +2256,11 @@ void dump_process(std::ostream &f, std::string indent, RTLIL::Process *proc, boo
 		} else {
 			f << stringf("%s" "always%s @(", indent.c_str(), systemverilog ? "_ff" : "");
 			if (sync->type == RTLIL::STp || sync->type == RTLIL::ST1)
-				f << stringf("posedge ");
+				f << "posedge ";
 			if (sync->type == RTLIL::STn || sync->type == RTLIL::ST0)
-				f << stringf("negedge ");
+				f << "negedge ";
 			dump_sigspec(f, sync->signal);
-			f << stringf(") begin\n");
+			f << ") begin\n";
 		}
 		std::string ends = indent + "end\n";
 		indent += "  ";
@@ -2243,7 +2268,7 @@ void dump_process(std::ostream &f, std::string indent, RTLIL::Process *proc, boo
 		if (sync->type == RTLIL::ST0 || sync->type == RTLIL::ST1) {
 			f << stringf("%s" "if (%s", indent.c_str(), sync->type == RTLIL::ST0 ? "!" : "");
 			dump_sigspec(f, sync->signal);
-			f << stringf(") begin\n");
+			f << ") begin\n";
 			ends = indent + "end\n" + ends;
 			indent += "  ";
 		}
@@ -2254,7 +2279,7 @@ void dump_process(std::ostream &f, std::string indent, RTLIL::Process *proc, boo
 				if (sync2->type == RTLIL::ST0 || sync2->type == RTLIL::ST1) {
 					f << stringf("%s" "if (%s", indent.c_str(), sync2->type == RTLIL::ST1 ? "!" : "");
 					dump_sigspec(f, sync2->signal);
-					f << stringf(") begin\n");
+					f << ") begin\n";
 					ends = indent + "end\n" + ends;
 					indent += "  ";
 				}
@@ -2266,9 +2291,9 @@ void dump_process(std::ostream &f, std::string indent, RTLIL::Process *proc, boo
 				continue;
 			f << stringf("%s  ", indent.c_str());
 			dump_sigspec(f, it->first);
-			f << stringf(" <= ");
+			f << " <= ";
 			dump_sigspec(f, it->second);
-			f << stringf(";\n");
+			f << ";\n";
 		}
 
 		f << stringf("%s", ends.c_str());
@@ -2304,13 +2329,13 @@ void dump_module(std::ostream &f, std::string indent, RTLIL::Module *module)
 				"unintended changes in simulation behavior are possible! Use \"proc\" "
 				"to convert processes to logic networks and registers.\n", log_id(module));
 
-	f << stringf("\n");
+	f << "\n";
 	for (auto it = module->processes.begin(); it != module->processes.end(); ++it)
 		dump_process(f, indent + "  ", it->second, true);
 
 	if (!noexpr)
 	{
-		std::set<std::pair<RTLIL::Wire*,int>> reg_bits;
+		pool<std::pair<RTLIL::Wire*,int>> reg_bits;
 		for (auto cell : module->cells())
 		{
 			if (cell->type.in(ID($print), ID($check)) && cell->getParam(ID::TRG_ENABLE).as_bool()) {
@@ -2348,13 +2373,13 @@ void dump_module(std::ostream &f, std::string indent, RTLIL::Module *module)
 		Wire *wire = module->wire(port);
 		if (wire) {
 			if (port != module->ports[0])
-				f << stringf(", ");
+				f << ", ";
 			f << stringf("%s", id(wire->name).c_str());
-			if (cnt==20) { f << stringf("\n"); cnt = 0; } else cnt++;
+			if (cnt==20) { f << "\n"; cnt = 0; } else cnt++;
 			continue;
 		}
 	}
-	f << stringf(");\n");
+	f << ");\n";
 	if (!systemverilog && !module->processes.empty()) {
 		initial_id = NEW_ID;
 		f << indent + "  " << "reg " << id(initial_id) << " = 0;\n";
@@ -2502,6 +2527,7 @@ struct VerilogBackend : public Backend {
 		bool selected = false;
 
 		auto_name_map.clear();
+		escaped_id_cache.clear();
 		reg_wires.clear();
 
 		size_t argidx;
@@ -2615,6 +2641,7 @@ struct VerilogBackend : public Backend {
 		}
 
 		auto_name_map.clear();
+		escaped_id_cache.clear();
 		reg_wires.clear();
 	}
 } VerilogBackend;
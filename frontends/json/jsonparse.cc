@@ -21,23 +21,39 @@
 
 YOSYS_NAMESPACE_BEGIN
 
+struct JsonBit
+{
+	// The bit index for signal bits.
+	int64_t index;
+	// One of '0', '1', 'x' or 'z' for constant bits, or 0 for signal bits.
+	char value;
+};
+
 struct JsonNode
 {
 	char type; // S=String, N=Number, A=Array, D=Dict
 	string data_string;
 	int64_t data_number;
 	vector<JsonNode*> data_array;
+	// Arrays that only hold bit values (numbers or one of the strings "0",
+	// "1", "x" and "z"), i.e. the "bits" arrays that make up most of a
+	// netlist, are stored here instead of in data_array, so that no node
+	// needs to be allocated per bit.
+	vector<JsonBit> data_bits;
 	dict<string, JsonNode*> data_dict;
 	vector<string> data_dict_keys;
 
-	JsonNode(std::istream &f)
-	{
-		type = 0;
-		data_number = 0;
+	JsonNode() : type(0), data_number(0) { }
 
+	JsonNode(std::istream &f) : JsonNode(*f.rdbuf()) { }
+
+	// The parser works on the stream buffer directly, as going through
+	// std::istream::get() for every character of a large netlist is slow.
+	JsonNode(std::streambuf &f) : JsonNode()
+	{
 		while (1)
 		{
-			int ch = f.get();
+			int ch = f.sbumpc();
 
 			if (ch == EOF)
 				log_error("Unexpected EOF in JSON file.\n");
@@ -51,7 +67,7 @@ struct JsonNode
 
 				while (1)
 				{
-					ch = f.get();
+					ch = f.sbumpc();
 
 					if (ch == EOF)
 						log_error("Unexpected EOF in JSON string.\n");
@@ -60,7 +76,7 @@ struct JsonNode
 						break;
 
 					if (ch == '\\') {
-						ch = f.get();
+						ch = f.sbumpc();
 
 						switch (ch) {
 							case EOF: log_error("Unexpected EOF in JSON string.\n"); break;
@@ -75,7 +91,7 @@ struct JsonNode
 							case 'u':
 								int val = 0;
 								for (int i = 0; i < 4; i++) {
-									ch = f.get();
+									ch = f.sbumpc();
 									val <<= 4;
 									if (ch >= '0' && '9' >= ch) {
 										val += ch - '0';
@@ -115,19 +131,20 @@ struct JsonNode
 
 				while (1)
 				{
-					ch = f.get();
+					ch = f.sgetc();
 
 					if (ch == EOF)
 						break;
 
-					if (ch == '.')
+					if (ch == '.') {
+						f.sbumpc();
 						goto parse_real;
+					}
 
-					if (ch < '0' || '9' < ch) {
-						f.unget();
+					if (ch < '0' || '9' < ch)
 						break;
-					}
 
+					f.sbumpc();
 					data_number = data_number*10 + (ch - '0');
 					data_string += ch;
 				}
@@ -143,16 +160,15 @@ struct JsonNode
 
 				while (1)
 				{
-					ch = f.get();
+					ch = f.sgetc();
 
 					if (ch == EOF)
 						break;
 
-					if (ch < '0' || '9' < ch) {
-						f.unget();
+					if (ch < '0' || '9' < ch)
 						break;
-					}
 
+					f.sbumpc();
 					data_string += ch;
 				}
 
@@ -165,19 +181,33 @@ struct JsonNode
 
 				while (1)
 				{
-					ch = f.get();
+					ch = f.sgetc();
 
 					if (ch == EOF)
 						log_error("Unexpected EOF in JSON file.\n");
 
-					if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == ',')
+					if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == ',') {
+						f.sbumpc();
 						continue;
+					}
 
-					if (ch == ']')
+					if (ch == ']') {
+						f.sbumpc();
 						break;
+					}
+
+					JsonNode value(f);
+					JsonBit bit;
 
-					f.unget();
-					data_array.push_back(new JsonNode(f));
+					if (data_array.empty() && value.get_bit(bit)) {
+						data_bits.push_back(bit);
+						continue;
+					}
+
+					expand_bits();
+					JsonNode *node = new JsonNode;
+					node->swap(value);
+					data_array.push_back(node);
 				}
 
 				break;
@@ -189,31 +219,35 @@ struct JsonNode
 
 				while (1)
 				{
-					ch = f.get();
+					ch = f.sgetc();
 
 					if (ch == EOF)
 						log_error("Unexpected EOF in JSON file.\n");
 
-					if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == ',')
+					if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == ',') {
+						f.sbumpc();
 						continue;
+					}
 
-					if (ch == '}')
+					if (ch == '}') {
+						f.sbumpc();
 						break;
+					}
 
-					f.unget();
 					JsonNode key(f);
 
 					while (1)
 					{
-						ch = f.get();
+						ch = f.sgetc();
 
 						if (ch == EOF)
 							log_error("Unexpected EOF in JSON file.\n");
 
-						if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == ':')
+						if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' || ch == ':') {
+							f.sbumpc();
 							continue;
+						}
 
-						f.unget();
 						break;
 					}
 
@@ -240,8 +274,79 @@ struct JsonNode
 		for (auto &it : data_dict)
 			delete it.second;
 	}
+
+	void swap(JsonNode &other)
+	{
+		std::swap(type, other.type);
+		std::swap(data_number, other.data_number);
+		data_string.swap(other.data_string);
+		data_array.swap(other.data_array);
+		data_bits.swap(other.data_bits);
+		data_dict.swap(other.data_dict);
+		data_dict_keys.swap(other.data_dict_keys);
+	}
+
+	// Returns true if this node is a valid element of a "bits" array.
+	bool get_bit(JsonBit &bit) const
+	{
+		if (type == 'N') {
+			bit.index = data_number;
+			bit.value = 0;
+			return true;
+		}
+		if (type == 'S' && GetSize(data_string) == 1 && data_string[0] && strchr("01xz", data_string[0])) {
+			bit.index = 0;
+			bit.value = data_string[0];
+			return true;
+		}
+		return false;
+	}
+
+	// Turns a compactly stored array back into one node per element.
+	void expand_bits()
+	{
+		for (auto &bit : data_bits) {
+			JsonNode *node = new JsonNode;
+			if (bit.value) {
+				node->type = 'S';
+				node->data_string = bit.value;
+			} else {
+				node->type = 'N';
+				node->data_number = bit.index;
+			}
+			data_array.push_back(node);
+		}
+		data_bits.clear();
+	}
 };
 
+State json_bit_state(const JsonBit &bit)
+{
+	switch (bit.value) {
+		case '0': return State::S0;
+		case '1': return State::S1;
+		case 'x': return State::Sx;
+		case 'z': return State::Sz;
+	}
+	log_abort();
+}
+
+// Only called for "bits" arrays that the parser could not store in
+// data_bits, i.e. that contain at least one element that is not a bit value.
+void json_bits_error(JsonNode *node, const string &what)
+{
+	JsonBit bit;
+	for (int i = 0; i < GetSize(node->data_array); i++) {
+		JsonNode *bitval_node = node->data_array[i];
+		if (bitval_node->get_bit(bit))
+			continue;
+		if (bitval_node->type == 'S')
+			log_error("JSON %s has invalid '%s' bit string value on bit %d.\n", what.c_str(), bitval_node->data_string.c_str(), i);
+		log_error("JSON %s has invalid bit value on bit %d.\n", what.c_str(), i);
+	}
+	log_abort();
+}
+
 Const json_parse_attr_param_value(JsonNode *node)
 {
 	Const value;
@@ -334,10 +439,13 @@ void json_import(Design *design, string &modname, JsonNode *node)
 			if (port_bits_node->type != 'A')
 				log_error("JSON port node '%s' has non-array bits attribute.\n", log_id(port_name));
 
+			if (!port_bits_node->data_array.empty())
+				json_bits_error(port_bits_node, stringf("port node '%s'", log_id(port_name)));
+
 			Wire *port_wire = module->wire(port_name);
 
 			if (port_wire == nullptr)
-				port_wire = module->addWire(port_name, GetSize(port_bits_node->data_array));
+				port_wire = module->addWire(port_name, GetSize(port_bits_node->data_bits));
 
 			if (port_node->data_dict.count("upto") != 0) {
 				JsonNode *val = port_node->data_dict.at("upto");
@@ -371,26 +479,15 @@ void json_import(Design *design, string &modname, JsonNode *node)
 
 			port_wire->port_id = port_id;
 
-			for (int i = 0; i < GetSize(port_bits_node->data_array); i++)
+			for (int i = 0; i < GetSize(port_bits_node->data_bits); i++)
 			{
-				JsonNode *bitval_node = port_bits_node->data_array.at(i);
+				const JsonBit &bitval = port_bits_node->data_bits[i];
 				SigBit sigbit(port_wire, i);
 
-				if (bitval_node->type == 'S') {
-					if (bitval_node->data_string == "0")
-						module->connect(sigbit, State::S0);
-					else if (bitval_node->data_string == "1")
-						module->connect(sigbit, State::S1);
-					else if (bitval_node->data_string == "x")
-						module->connect(sigbit, State::Sx);
-					else if (bitval_node->data_string == "z")
-						module->connect(sigbit, State::Sz);
-					else
-						log_error("JSON port node '%s' has invalid '%s' bit string value on bit %d.\n",
-								log_id(port_name), bitval_node->data_string.c_str(), i);
-				} else
-				if (bitval_node->type == 'N') {
-					int bitidx = bitval_node->data_number;
+				if (bitval.value) {
+					module->connect(sigbit, json_bit_state(bitval));
+				} else {
+					int bitidx = bitval.index;
 					if (signal_bits.count(bitidx)) {
 						if (port_wire->port_output) {
 							module->connect(sigbit, signal_bits.at(bitidx));
@@ -401,8 +498,7 @@ void json_import(Design *design, string &modname, JsonNode *node)
 					} else {
 						signal_bits[bitidx] = sigbit;
 					}
-				} else
-					log_error("JSON port node '%s' has invalid bit value on bit %d.\n", log_id(port_name), i);
+				}
 			}
 		}
 
@@ -432,10 +528,13 @@ void json_import(Design *design, string &modname, JsonNode *node)
 			if (bits_node->type != 'A')
 				log_error("JSON netname node '%s' has non-array bits attribute.\n", log_id(net_name));
 
+			if (!bits_node->data_array.empty())
+				json_bits_error(bits_node, stringf("netname node '%s'", log_id(net_name)));
+
 			Wire *wire = module->wire(net_name);
 
 			if (wire == nullptr)
-				wire = module->addWire(net_name, GetSize(bits_node->data_array));
+				wire = module->addWire(net_name, GetSize(bits_node->data_bits));
 
 			if (net_node->data_dict.count("upto") != 0) {
 				JsonNode *val = net_node->data_dict.at("upto");
@@ -449,34 +548,22 @@ void json_import(Design *design, string &modname, JsonNode *node)
 					wire->start_offset = val->data_number;
 			}
 
-			for (int i = 0; i < GetSize(bits_node->data_array); i++)
+			for (int i = 0; i < GetSize(bits_node->data_bits); i++)
 			{
-				JsonNode *bitval_node = bits_node->data_array.at(i);
+				const JsonBit &bitval = bits_node->data_bits[i];
 				SigBit sigbit(wire, i);
 
-				if (bitval_node->type == 'S') {
-					if (bitval_node->data_string == "0")
-						module->connect(sigbit, State::S0);
-					else if (bitval_node->data_string == "1")
-						module->connect(sigbit, State::S1);
-					else if (bitval_node->data_string == "x")
-						module->connect(sigbit, State::Sx);
-					else if (bitval_node->data_string == "z")
-						module->connect(sigbit, State::Sz);
-					else
-						log_error("JSON netname node '%s' has invalid '%s' bit string value on bit %d.\n",
-								log_id(net_name), bitval_node->data_string.c_str(), i);
-				} else
-				if (bitval_node->type == 'N') {
-					int bitidx = bitval_node->data_number;
+				if (bitval.value) {
+					module->connect(sigbit, json_bit_state(bitval));
+				} else {
+					int bitidx = bitval.index;
 					if (signal_bits.count(bitidx)) {
 						if (sigbit != signal_bits.at(bitidx))
 							module->connect(sigbit, signal_bits.at(bitidx));
 					} else {
 						signal_bits[bitidx] = sigbit;
 					}
-				} else
-					log_error("JSON netname node '%s' has invalid bit value on bit %d.\n", log_id(net_name), i);
+				}
 			}
 
 			if (net_node->data_dict.count("attributes"))
@@ -527,34 +614,21 @@ void json_import(Design *design, string &modname, JsonNode *node)
 				if (conn_node->type != 'A')
 					log_error("JSON cells node '%s' connection '%s' is not an array.\n", log_id(cell_name), log_id(conn_name));
 
+				if (!conn_node->data_array.empty())
+					json_bits_error(conn_node, stringf("cells node '%s' connection '%s'", log_id(cell_name), log_id(conn_name)));
+
 				SigSpec sig;
 
-				for (int i = 0; i < GetSize(conn_node->data_array); i++)
+				for (auto &bitval : conn_node->data_bits)
 				{
-					JsonNode *bitval_node = conn_node->data_array.at(i);
-
-					if (bitval_node->type == 'S') {
-						if (bitval_node->data_string == "0")
-							sig.append(State::S0);
-						else if (bitval_node->data_string == "1")
-							sig.append(State::S1);
-						else if (bitval_node->data_string == "x")
-							sig.append(State::Sx);
-						else if (bitval_node->data_string == "z")
-							sig.append(State::Sz);
-						else
-							log_error("JSON cells node '%s' connection '%s' has invalid '%s' bit string value on bit %d.\n",
-									log_id(cell_name), log_id(conn_name), bitval_node->data_string.c_str(), i);
-					} else
-					if (bitval_node->type == 'N') {
-						int bitidx = bitval_node->data_number;
+					if (bitval.value) {
+						sig.append(json_bit_state(bitval));
+					} else {
+						int bitidx = bitval.index;
 						if (signal_bits.count(bitidx) == 0)
 							signal_bits[bitidx] = module->addWire(NEW_ID);
 						sig.append(signal_bits.at(bitidx));
-					} else
-						log_error("JSON cells node '%s' connection '%s' has invalid bit value on bit %d.\n",
-								log_id(cell_name), log_id(conn_name), i);
-
+					}
 				}
 
 				cell->setPort(conn_name, sig);
@@ -617,6 +691,7 @@ void json_import(Design *design, string &modname, JsonNode *node)
 	// remove duplicates from connections array
 	pool<RTLIL::SigSig> unique_connections(module->connections_.begin(), module->connections_.end());
 	module->connections_ = std::vector<RTLIL::SigSig>(unique_connections.begin(), unique_connections.end());
+	module->invalidate_sigmap();
 }
 
 struct JsonFrontend : public Frontend {
@@ -22,21 +22,691 @@
  *
  */
 
-#include "rtlil_frontend.h"
 #include "kernel/register.h"
 #include "kernel/log.h"
 
-void rtlil_frontend_yyerror(char const *s)
-{
-	YOSYS_NAMESPACE_PREFIX log_error("Parser error in line %d: %s\n", rtlil_frontend_yyget_lineno(), s);
-}
+YOSYS_NAMESPACE_BEGIN
+
+// RTLIL is a line based format: every statement occupies exactly one line,
+// so the parser below reads one line at a time into a reused buffer and
+// tokenizes it in place. Identifiers are interned straight from that buffer
+// and constants are decoded without intermediate copies.
 
-void rtlil_frontend_yywarning(char const *s)
+struct RTLILFrontendWorker
 {
-	YOSYS_NAMESPACE_PREFIX log_warning("In line %d: %s\n", rtlil_frontend_yyget_lineno(), s);
-}
+	std::istream *f;
+	RTLIL::Design *design;
+	bool flag_nooverwrite = false;
+	bool flag_overwrite = false;
+	bool flag_lib = false;
 
-YOSYS_NAMESPACE_BEGIN
+	std::string line;
+	std::string id_buf;
+	int line_num = 0;
+	size_t pos = 0;
+	bool eof = false;
+
+	dict<RTLIL::IdString, RTLIL::Const> attrbuf;
+	RTLIL::Module *current_module = nullptr;
+
+	RTLILFrontendWorker(std::istream *f, RTLIL::Design *design) : f(f), design(design) { }
+
+	[[noreturn]] void error(const char *msg)
+	{
+		log_error("Parser error in line %d: %s\n", line_num, msg);
+	}
+
+	[[noreturn]] void error(const std::string &msg)
+	{
+		error(msg.c_str());
+	}
+
+	void warning(const char *msg)
+	{
+		log_warning("In line %d: %s\n", line_num, msg);
+	}
+
+	// --- lexical level ---
+
+	static bool is_space(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
+
+	void skip_ws()
+	{
+		while (pos < line.size() && is_space(line[pos]))
+			pos++;
+		if (pos < line.size() && line[pos] == '#')
+			pos = line.size();
+	}
+
+	bool at_eol()
+	{
+		skip_ws();
+		return pos >= line.size();
+	}
+
+	// Advance to the next line that holds a statement, setting eof if there
+	// is none. Blank and comment-only lines are skipped.
+	void next_statement()
+	{
+		while (std::getline(*f, line)) {
+			line_num++;
+			pos = 0;
+			if (!at_eol())
+				return;
+		}
+		line.clear();
+		pos = 0;
+		eof = true;
+	}
+
+	void expect_eol()
+	{
+		if (!at_eol())
+			error("syntax error");
+		next_statement();
+	}
+
+	// Keywords are runs of lower case letters, matching only as a whole.
+	std::string_view peek_keyword()
+	{
+		skip_ws();
+		size_t end = pos;
+		while (end < line.size() && 'a' <= line[end] && line[end] <= 'z')
+			end++;
+		return std::string_view(line).substr(pos, end - pos);
+	}
+
+	bool try_parse_keyword(std::string_view keyword)
+	{
+		if (peek_keyword() != keyword)
+			return false;
+		pos += keyword.size();
+		return true;
+	}
+
+	bool try_parse_char(char c)
+	{
+		skip_ws();
+		if (pos < line.size() && line[pos] == c) {
+			pos++;
+			return true;
+		}
+		return false;
+	}
+
+	bool at_id()
+	{
+		skip_ws();
+		return pos + 1 < line.size() && (line[pos] == '\\' || line[pos] == '$') && !is_space(line[pos + 1]);
+	}
+
+	RTLIL::IdString parse_id()
+	{
+		if (!at_id())
+			error("syntax error");
+		size_t end = pos + 1;
+		while (end < line.size() && !is_space(line[end]))
+			end++;
+		id_buf.assign(line, pos, end - pos);
+		pos = end;
+		return RTLIL::IdString(id_buf);
+	}
+
+	// Scans an integer literal starting at pos without consuming it. Returns
+	// the end of the literal, or 0 if there is none. A run of digits followed
+	// by a quote is the width of a bit vector constant and not an integer.
+	size_t scan_integer()
+	{
+		size_t end = pos;
+		if (end < line.size() && line[end] == '-')
+			end++;
+		size_t digits = end;
+		while (end < line.size() && '0' <= line[end] && line[end] <= '9')
+			end++;
+		if (end == digits)
+			return 0;
+		if (end < line.size() && line[end] == '\'')
+			return 0;
+		return end;
+	}
+
+	bool try_parse_integer(int &value)
+	{
+		skip_ws();
+		size_t end = scan_integer();
+		if (end == 0)
+			return false;
+		char *ep = nullptr;
+		errno = 0;
+		long v = strtol(line.c_str() + pos, &ep, 10);
+		log_assert(ep == line.c_str() + end);
+		if (errno == ERANGE || v < INT_MIN || v > INT_MAX)
+			return false;
+		value = v;
+		pos = end;
+		return true;
+	}
+
+	int parse_integer()
+	{
+		int value;
+		if (!try_parse_integer(value))
+			error("syntax error");
+		return value;
+	}
+
+	RTLIL::Const parse_bits_value()
+	{
+		char *ep = nullptr;
+		int width = strtol(line.c_str() + pos, &ep, 10);
+		pos = ep - line.c_str();
+		log_assert(line[pos] == '\'');
+		pos++;
+
+		bool is_signed = false;
+		if (pos < line.size() && line[pos] == 's') {
+			is_signed = true;
+			pos++;
+		}
+
+		size_t begin = pos;
+		while (pos < line.size() && line[pos] != 0 && strchr("01xzm-", line[pos]))
+			pos++;
+
+		RTLIL::Const value;
+		std::vector<RTLIL::State> &bits = value.bits();
+		bits.reserve(std::max<size_t>(std::max(width, 0), pos - begin));
+		for (size_t i = pos; i > begin; i--) {
+			switch (line[i - 1]) {
+			case '0': bits.push_back(RTLIL::S0); break;
+			case '1': bits.push_back(RTLIL::S1); break;
+			case 'z': bits.push_back(RTLIL::Sz); break;
+			case '-': bits.push_back(RTLIL::Sa); break;
+			case 'm': bits.push_back(RTLIL::Sm); break;
+			default: bits.push_back(RTLIL::Sx); break;
+			}
+		}
+
+		if (bits.empty())
+			bits.push_back(RTLIL::Sx);
+		if (GetSize(bits) < width) {
+			RTLIL::State ext = bits.back() == RTLIL::S1 ? RTLIL::S0 : bits.back();
+			bits.resize(width, ext);
+		}
+		if (GetSize(bits) > width)
+			bits.resize(std::max(width, 0));
+
+		if (is_signed)
+			value.flags |= RTLIL::CONST_FLAG_SIGNED;
+		return value;
+	}
+
+	RTLIL::Const parse_string_value()
+	{
+		log_assert(line[pos] == '"');
+		pos++;
+
+		std::string str;
+		while (true) {
+			if (pos >= line.size())
+				error("unterminated string");
+			char c = line[pos++];
+			if (c == '"')
+				break;
+			if (c == '\\' && pos < line.size()) {
+				c = line[pos++];
+				if (c == 'n')
+					c = '\n';
+				else if (c == 't')
+					c = '\t';
+				else if ('0' <= c && c <= '7') {
+					int v = c - '0';
+					for (int k = 0; k < 2 && pos < line.size() && '0' <= line[pos] && line[pos] <= '7'; k++)
+						v = v * 8 + line[pos++] - '0';
+					c = v;
+				}
+			}
+			str += c;
+		}
+		return RTLIL::Const(str);
+	}
+
+	bool try_parse_const(RTLIL::Const &value)
+	{
+		skip_ws();
+		if (pos >= line.size())
+			return false;
+		if (line[pos] == '"') {
+			value = parse_string_value();
+			return true;
+		}
+		if ('0' <= line[pos] && line[pos] <= '9') {
+			size_t end = pos;
+			while (end < line.size() && '0' <= line[end] && line[end] <= '9')
+				end++;
+			if (end < line.size() && line[end] == '\'') {
+				value = parse_bits_value();
+				return true;
+			}
+		}
+		int integer;
+		if (try_parse_integer(integer)) {
+			value = RTLIL::Const(integer, 32);
+			return true;
+		}
+		return false;
+	}
+
+	RTLIL::Const parse_const()
+	{
+		RTLIL::Const value;
+		if (!try_parse_const(value))
+			error("syntax error");
+		return value;
+	}
+
+	RTLIL::SigSpec parse_sigspec()
+	{
+		RTLIL::SigSpec sig;
+
+		if (try_parse_char('{')) {
+			std::vector<RTLIL::SigSpec> parts;
+			while (!try_parse_char('}')) {
+				if (at_eol())
+					error("syntax error");
+				parts.push_back(parse_sigspec());
+			}
+			for (auto it = parts.rbegin(); it != parts.rend(); it++)
+				sig.append(*it);
+		} else if (at_id()) {
+			RTLIL::IdString id = parse_id();
+			RTLIL::Wire *wire = current_module->wire(id);
+			if (wire == nullptr)
+				error(stringf("RTLIL error: wire %s not found", id.c_str()));
+			sig = RTLIL::SigSpec(wire);
+		} else {
+			sig = RTLIL::SigSpec(parse_const());
+		}
+
+		while (try_parse_char('[')) {
+			int left = parse_integer();
+			if (try_parse_char(':')) {
+				int right = parse_integer();
+				if (!try_parse_char(']'))
+					error("syntax error");
+				if (left >= sig.size() || left < 0 || right < 0 || left < right)
+					error("invalid slice");
+				sig = sig.extract(right, left - right + 1);
+			} else {
+				if (!try_parse_char(']'))
+					error("syntax error");
+				if (left >= sig.size() || left < 0)
+					error("bit index out of range");
+				sig = sig.extract(left);
+			}
+		}
+
+		return sig;
+	}
+
+	// --- statement level ---
+
+	void parse_attribute()
+	{
+		RTLIL::IdString id = parse_id();
+		attrbuf[id] = parse_const();
+		expect_eol();
+	}
+
+	void check_dangling_attributes()
+	{
+		if (!attrbuf.empty())
+			error("dangling attribute");
+	}
+
+	void parse_wire()
+	{
+		int width = 1, start_offset = 0, port_id = 0;
+		bool upto = false, is_signed = false, port_input = false, port_output = false;
+
+		while (!at_id()) {
+			if (try_parse_keyword("width")) {
+				if (!try_parse_integer(width))
+					error("RTLIL error: invalid wire width");
+			} else if (try_parse_keyword("upto")) {
+				upto = true;
+			} else if (try_parse_keyword("signed")) {
+				is_signed = true;
+			} else if (try_parse_keyword("offset")) {
+				start_offset = parse_integer();
+			} else if (try_parse_keyword("input")) {
+				port_id = parse_integer();
+				port_input = true, port_output = false;
+			} else if (try_parse_keyword("output")) {
+				port_id = parse_integer();
+				port_input = false, port_output = true;
+			} else if (try_parse_keyword("inout")) {
+				port_id = parse_integer();
+				port_input = true, port_output = true;
+			} else
+				error("syntax error");
+		}
+
+		RTLIL::IdString id = parse_id();
+		if (current_module->wire(id) != nullptr)
+			error(stringf("RTLIL error: redefinition of wire %s.", id.c_str()));
+
+		RTLIL::Wire *wire = current_module->addWire(id);
+		wire->width = width;
+		wire->start_offset = start_offset;
+		wire->upto = upto;
+		wire->is_signed = is_signed;
+		wire->port_id = port_id;
+		wire->port_input = port_input;
+		wire->port_output = port_output;
+		wire->attributes.swap(attrbuf);
+		attrbuf.clear();
+		expect_eol();
+	}
+
+	void parse_memory()
+	{
+		RTLIL::Memory *memory = new RTLIL::Memory;
+		memory->attributes.swap(attrbuf);
+		attrbuf.clear();
+
+		while (!at_id()) {
+			if (try_parse_keyword("width"))
+				memory->width = parse_integer();
+			else if (try_parse_keyword("size"))
+				memory->size = parse_integer();
+			else if (try_parse_keyword("offset"))
+				memory->start_offset = parse_integer();
+			else {
+				delete memory;
+				error("syntax error");
+			}
+		}
+
+		RTLIL::IdString id = parse_id();
+		if (current_module->memories.count(id) != 0) {
+			delete memory;
+			error(stringf("RTLIL error: redefinition of memory %s.", id.c_str()));
+		}
+		memory->name = id;
+		current_module->memories[id] = memory;
+		expect_eol();
+	}
+
+	void parse_cell()
+	{
+		RTLIL::IdString type = parse_id();
+		RTLIL::IdString id = parse_id();
+		if (current_module->cell(id) != nullptr)
+			error(stringf("RTLIL error: redefinition of cell %s.", id.c_str()));
+
+		RTLIL::Cell *cell = current_module->addCell(id, type);
+		cell->attributes.swap(attrbuf);
+		attrbuf.clear();
+		expect_eol();
+
+		while (!eof) {
+			if (try_parse_keyword("parameter")) {
+				int flags = 0;
+				if (try_parse_keyword("signed"))
+					flags = RTLIL::CONST_FLAG_SIGNED;
+				else if (try_parse_keyword("real"))
+					flags = RTLIL::CONST_FLAG_REAL;
+				RTLIL::IdString param = parse_id();
+				RTLIL::Const &value = cell->parameters[param];
+				value = parse_const();
+				value.flags |= flags;
+				expect_eol();
+			} else if (try_parse_keyword("connect")) {
+				RTLIL::IdString port = parse_id();
+				if (cell->hasPort(port))
+					error(stringf("RTLIL error: redefinition of cell port %s.", port.c_str()));
+				cell->setPort(port, parse_sigspec());
+				expect_eol();
+			} else if (try_parse_keyword("end")) {
+				expect_eol();
+				return;
+			} else
+				error("syntax error");
+		}
+		error("syntax error");
+	}
+
+	void parse_switch(RTLIL::CaseRule *parent)
+	{
+		RTLIL::SwitchRule *rule = new RTLIL::SwitchRule;
+		parent->switches.push_back(rule);
+		rule->signal = parse_sigspec();
+		rule->attributes.swap(attrbuf);
+		attrbuf.clear();
+		expect_eol();
+
+		while (try_parse_keyword("attribute"))
+			parse_attribute();
+
+		while (try_parse_keyword("case")) {
+			RTLIL::CaseRule *case_rule = new RTLIL::CaseRule;
+			rule->cases.push_back(case_rule);
+			case_rule->attributes.swap(attrbuf);
+			attrbuf.clear();
+			if (!at_eol()) {
+				do
+					case_rule->compare.push_back(parse_sigspec());
+				while (try_parse_char(','));
+			}
+			expect_eol();
+			parse_case_body(case_rule);
+		}
+
+		if (!try_parse_keyword("end"))
+			error("syntax error");
+		expect_eol();
+	}
+
+	void parse_case_body(RTLIL::CaseRule *case_rule)
+	{
+		while (!eof) {
+			if (try_parse_keyword("attribute")) {
+				parse_attribute();
+			} else if (try_parse_keyword("switch")) {
+				parse_switch(case_rule);
+			} else if (try_parse_keyword("assign")) {
+				check_dangling_attributes();
+
+				// See https://github.com/YosysHQ/yosys/pull/4765 for discussion on this
+				// warning
+				if (!case_rule->switches.empty()) {
+					warning("case rule assign statements after switch statements may cause unexpected behaviour. "
+						"The assign statement is reordered to come before all switch statements.");
+				}
+
+				RTLIL::SigSpec lhs = parse_sigspec();
+				RTLIL::SigSpec rhs = parse_sigspec();
+				case_rule->actions.push_back(RTLIL::SigSig(std::move(lhs), std::move(rhs)));
+				expect_eol();
+			} else
+				return;
+		}
+	}
+
+	void parse_sync(RTLIL::Process *process)
+	{
+		RTLIL::SyncRule *rule = new RTLIL::SyncRule;
+		process->syncs.push_back(rule);
+
+		if (try_parse_keyword("always"))
+			rule->type = RTLIL::SyncType::STa;
+		else if (try_parse_keyword("global"))
+			rule->type = RTLIL::SyncType::STg;
+		else if (try_parse_keyword("init"))
+			rule->type = RTLIL::SyncType::STi;
+		else {
+			if (try_parse_keyword("low"))
+				rule->type = RTLIL::SyncType::ST0;
+			else if (try_parse_keyword("high"))
+				rule->type = RTLIL::SyncType::ST1;
+			else if (try_parse_keyword("posedge"))
+				rule->type = RTLIL::SyncType::STp;
+			else if (try_parse_keyword("negedge"))
+				rule->type = RTLIL::SyncType::STn;
+			else if (try_parse_keyword("edge"))
+				rule->type = RTLIL::SyncType::STe;
+			else
+				error("syntax error");
+			rule->signal = parse_sigspec();
+		}
+		expect_eol();
+
+		while (!eof) {
+			if (try_parse_keyword("update")) {
+				RTLIL::SigSpec lhs = parse_sigspec();
+				RTLIL::SigSpec rhs = parse_sigspec();
+				rule->actions.push_back(RTLIL::SigSig(std::move(lhs), std::move(rhs)));
+				expect_eol();
+				continue;
+			}
+
+			bool has_attributes = false;
+			while (try_parse_keyword("attribute")) {
+				parse_attribute();
+				has_attributes = true;
+			}
+
+			if (try_parse_keyword("memwr")) {
+				RTLIL::MemWriteAction act;
+				act.attributes.swap(attrbuf);
+				attrbuf.clear();
+				act.memid = parse_id();
+				act.address = parse_sigspec();
+				act.data = parse_sigspec();
+				act.enable = parse_sigspec();
+				act.priority_mask = parse_const();
+				rule->mem_write_actions.push_back(std::move(act));
+				expect_eol();
+			} else if (has_attributes)
+				error("syntax error");
+			else
+				return;
+		}
+	}
+
+	void parse_process()
+	{
+		RTLIL::IdString id = parse_id();
+		if (current_module->processes.count(id) != 0)
+			error(stringf("RTLIL error: redefinition of process %s.", id.c_str()));
+
+		RTLIL::Process *process = current_module->addProcess(id);
+		process->attributes.swap(attrbuf);
+		attrbuf.clear();
+		expect_eol();
+
+		parse_case_body(&process->root_case);
+
+		while (try_parse_keyword("sync"))
+			parse_sync(process);
+
+		if (!try_parse_keyword("end"))
+			error("syntax error");
+		expect_eol();
+	}
+
+	void parse_module()
+	{
+		RTLIL::IdString id = parse_id();
+		bool delete_current_module = false;
+
+		if (design->has(id)) {
+			RTLIL::Module *existing_mod = design->module(id);
+			if (!flag_overwrite && (flag_lib || (attrbuf.count(ID::blackbox) && attrbuf.at(ID::blackbox).as_bool()))) {
+				log("Ignoring blackbox re-definition of module %s.\n", id.c_str());
+				delete_current_module = true;
+			} else if (!flag_nooverwrite && !flag_overwrite && !existing_mod->get_bool_attribute(ID::blackbox)) {
+				error(stringf("RTLIL error: redefinition of module %s.", id.c_str()));
+			} else if (flag_nooverwrite) {
+				log("Ignoring re-definition of module %s.\n", id.c_str());
+				delete_current_module = true;
+			} else {
+				log("Replacing existing%s module %s.\n", existing_mod->get_bool_attribute(ID::blackbox) ? " blackbox" : "", id.c_str());
+				design->remove(existing_mod);
+			}
+		}
+
+		current_module = new RTLIL::Module;
+		current_module->name = id;
+		current_module->attributes.swap(attrbuf);
+		attrbuf.clear();
+		if (!delete_current_module)
+			design->add(current_module);
+		expect_eol();
+
+		while (true) {
+			if (eof)
+				error("syntax error");
+			if (try_parse_keyword("parameter")) {
+				RTLIL::IdString param = parse_id();
+				current_module->avail_parameters(param);
+				RTLIL::Const value;
+				if (try_parse_const(value))
+					current_module->parameter_default_values[param] = value;
+				expect_eol();
+			} else if (try_parse_keyword("attribute")) {
+				parse_attribute();
+			} else if (try_parse_keyword("wire")) {
+				parse_wire();
+			} else if (try_parse_keyword("memory")) {
+				parse_memory();
+			} else if (try_parse_keyword("cell")) {
+				parse_cell();
+			} else if (try_parse_keyword("process")) {
+				parse_process();
+			} else if (try_parse_keyword("connect")) {
+				check_dangling_attributes();
+				RTLIL::SigSpec lhs = parse_sigspec();
+				RTLIL::SigSpec rhs = parse_sigspec();
+				current_module->connect(lhs, rhs);
+				expect_eol();
+			} else if (try_parse_keyword("end")) {
+				break;
+			} else
+				error("syntax error");
+		}
+
+		check_dangling_attributes();
+		current_module->fixup_ports();
+		if (delete_current_module)
+			delete current_module;
+		else if (flag_lib)
+			current_module->makeblackbox();
+		current_module = nullptr;
+		expect_eol();
+	}
+
+	void parse()
+	{
+		next_statement();
+		while (!eof) {
+			if (try_parse_keyword("module")) {
+				parse_module();
+			} else if (try_parse_keyword("attribute")) {
+				parse_attribute();
+			} else if (try_parse_keyword("autoidx")) {
+				autoidx = std::max(autoidx, parse_integer());
+				expect_eol();
+			} else
+				error("syntax error");
+		}
+		check_dangling_attributes();
+	}
+};
 
 struct RTLILFrontend : public Frontend {
 	RTLILFrontend() : Frontend("rtlil", "read modules from RTLIL file") { }
@@ -63,9 +733,7 @@ struct RTLILFrontend : public Frontend {
 	}
 	void execute(std::istream *&f, std::string filename, std::vector<std::string> args, RTLIL::Design *design) override
 	{
-		RTLIL_FRONTEND::flag_nooverwrite = false;
-		RTLIL_FRONTEND::flag_overwrite = false;
-		RTLIL_FRONTEND::flag_lib = false;
+		RTLILFrontendWorker worker(f, design);
 
 		log_header(design, "Executing RTLIL frontend.\n");
 
@@ -73,17 +741,17 @@ struct RTLILFrontend : public Frontend {
 		for (argidx = 1; argidx < args.size(); argidx++) {
 			std::string arg = args[argidx];
 			if (arg == "-nooverwrite") {
-				RTLIL_FRONTEND::flag_nooverwrite = true;
-				RTLIL_FRONTEND::flag_overwrite = false;
+				worker.flag_nooverwrite = true;
+				worker.flag_overwrite = false;
 				continue;
 			}
 			if (arg == "-overwrite") {
-				RTLIL_FRONTEND::flag_nooverwrite = false;
-				RTLIL_FRONTEND::flag_overwrite = true;
+				worker.flag_nooverwrite = false;
+				worker.flag_overwrite = true;
 				continue;
 			}
 			if (arg == "-lib") {
-				RTLIL_FRONTEND::flag_lib = true;
+				worker.flag_lib = true;
 				continue;
 			}
 			break;
@@ -92,14 +760,9 @@ struct RTLILFrontend : public Frontend {
 
 		log("Input filename: %s\n", filename.c_str());
 
-		RTLIL_FRONTEND::lexin = f;
-		RTLIL_FRONTEND::current_design = design;
-		rtlil_frontend_yydebug = false;
-		rtlil_frontend_yyrestart(NULL);
-		rtlil_frontend_yyparse();
-		rtlil_frontend_yylex_destroy();
+		worker.f = f;
+		worker.parse();
 	}
 } RTLILFrontend;
 
 YOSYS_NAMESPACE_END
-
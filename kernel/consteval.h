@@ -29,13 +29,55 @@ YOSYS_NAMESPACE_BEGIN
 
 struct ConstEval
 {
+	// Known values of (assign_map-ed) wire bits. Each value is tagged with the
+	// push() level it was derived from, so that pop() only has to forget the
+	// values of that level and everything that does not depend on the popped
+	// assignments stays cached.
+	struct ValueMap
+	{
+		dict<RTLIL::SigBit, std::pair<RTLIL::State, int>> values;
+
+		void clear()
+		{
+			values.clear();
+		}
+
+		void apply(RTLIL::SigBit &bit) const
+		{
+			if (bit.wire == nullptr)
+				return;
+			auto it = values.find(bit);
+			if (it != values.end())
+				bit = it->second.first;
+		}
+
+		void apply(RTLIL::SigSpec &sig) const
+		{
+			for (auto &bit : sig)
+				apply(bit);
+		}
+
+		RTLIL::SigBit operator()(RTLIL::SigBit bit) const
+		{
+			apply(bit);
+			return bit;
+		}
+
+		RTLIL::SigSpec operator()(RTLIL::SigSpec sig) const
+		{
+			apply(sig);
+			return sig;
+		}
+	};
+
 	RTLIL::Module *module;
 	SigMap assign_map;
-	SigMap values_map;
+	ValueMap values_map;
 	SigPool stop_signals;
 	SigSet<RTLIL::Cell*> sig2driver;
 	std::set<RTLIL::Cell*> busy;
-	std::vector<SigMap> stack;
+	std::vector<std::vector<RTLIL::SigBit>> trail;
+	int eval_level = -1;
 	RTLIL::State defaultval;
 
 	ConstEval(RTLIL::Module *module, RTLIL::State defaultval = RTLIL::State::Sm) : module(module), assign_map(module), defaultval(defaultval)
@@ -57,17 +99,20 @@ struct ConstEval
 	{
 		values_map.clear();
 		stop_signals.clear();
+		for (auto &level : trail)
+			level.clear();
 	}
 
 	void push()
 	{
-		stack.push_back(values_map);
+		trail.emplace_back();
 	}
 
 	void pop()
 	{
-		values_map.swap(stack.back());
-		stack.pop_back();
+		for (auto &bit : trail.back())
+			values_map.values.erase(bit);
+		trail.pop_back();
 	}
 
 	void set(RTLIL::SigSpec sig, RTLIL::Const value)
@@ -78,7 +123,35 @@ struct ConstEval
 		for (int i = 0; i < GetSize(current_val); i++)
 			log_assert(current_val[i].wire != NULL || current_val[i] == value[i]);
 #endif
-		values_map.add(sig, RTLIL::SigSpec(value));
+		// values computed while evaluating a cell depend on the cell inputs only,
+		// values set by the caller belong to the current push() level
+		int level = eval_level < 0 ? GetSize(trail) : eval_level;
+		for (int i = 0; i < GetSize(sig); i++) {
+			if (sig[i].wire == nullptr)
+				continue;
+			auto it = values_map.values.find(sig[i]);
+			if (it != values_map.values.end() && it->second.first == value[i])
+				continue;
+			if (level > 0)
+				trail[level-1].push_back(sig[i]);
+			values_map.values[sig[i]] = std::make_pair(value[i], level);
+		}
+	}
+
+	// Replaces known bits by their values, noting the level of each value
+	// used while a cell is being evaluated.
+	void apply_values(RTLIL::SigSpec &sig)
+	{
+		for (auto &bit : sig) {
+			if (bit.wire == nullptr)
+				continue;
+			auto it = values_map.values.find(bit);
+			if (it == values_map.values.end())
+				continue;
+			bit = it->second.first;
+			if (eval_level >= 0)
+				eval_level = std::max(eval_level, it->second.second);
+		}
 	}
 
 	void stop(RTLIL::SigSpec sig)
@@ -88,6 +161,15 @@ struct ConstEval
 	}
 
 	bool eval(RTLIL::Cell *cell, RTLIL::SigSpec &undef)
+	{
+		int saved_level = eval_level;
+		eval_level = 0;
+		bool ret = eval_cell(cell, undef);
+		eval_level = saved_level;
+		return ret;
+	}
+
+	bool eval_cell(RTLIL::Cell *cell, RTLIL::SigSpec &undef)
 	{
 		if (cell->type == ID($lcu))
 		{
@@ -363,7 +445,7 @@ struct ConstEval
 	bool eval(RTLIL::SigSpec &sig, RTLIL::SigSpec &undef, RTLIL::Cell *busy_cell = NULL)
 	{
 		assign_map.apply(sig);
-		values_map.apply(sig);
+		apply_values(sig);
 
 		if (sig.is_fully_const())
 			return true;
@@ -394,11 +476,13 @@ struct ConstEval
 		if (busy_cell)
 			busy.erase(busy_cell);
 
-		values_map.apply(sig);
+		apply_values(sig);
 		if (sig.is_fully_const())
 			return true;
 
 		if (defaultval != RTLIL::State::Sm) {
+			if (eval_level >= 0)
+				eval_level = std::max(eval_level, GetSize(trail));
 			for (auto &bit : sig)
 				if (bit.wire) bit = defaultval;
 			return true;
@@ -19,6 +19,7 @@
 
 #include "kernel/yosys.h"
 #include "kernel/hashlib.h"
+#include "kernel/trace.h"
 #include "libs/sha1/sha1.h"
 #define CXXOPTS_VECTOR_DELIMITER '\0'
 #include "libs/cxxopts/include/cxxopts.hpp"
@@ -151,6 +152,8 @@ extern "C" {
 
 void yosys_atexit()
 {
+	trace_stop();
+
 #if defined(YOSYS_ENABLE_READLINE) || defined(YOSYS_ENABLE_EDITLINE)
 	if (!yosys_history_file.empty()) {
 #if defined(YOSYS_ENABLE_READLINE)
@@ -200,6 +203,7 @@ int main(int argc, char **argv)
 	std::string depsfile = "";
 	std::string topmodule = "";
 	std::string perffile = "";
+	std::string tracefile = "";
 	bool scriptfile_tcl = false;
 	bool scriptfile_python = false;
 	bool print_banner = true;
@@ -292,6 +296,8 @@ int main(int argc, char **argv)
 			cxxopts::value<std::vector<std::string>>(), "<feature>")
 		("g,debug", "globally enable debug log messages")
 		("perffile", "write a JSON performance log to <perffile>", cxxopts::value<std::string>(), "<perffile>")
+		("tracefile", "write a Chrome trace event JSON of nested pass runtimes to <tracefile>",
+			cxxopts::value<std::string>(), "<tracefile>")
 	;
 
 	options.parse_positional({"infile"});
@@ -360,7 +366,10 @@ int main(int argc, char **argv)
 				for (const auto& filename : result[key].as<std::vector<std::string>>()) {
 					if (FILE* f = fopen(filename.c_str(), "wt")) {
 						log_files.push_back(f);
-						if (key[0] == 'L') setvbuf(f, NULL, _IOLBF, 0);
+						if (key[0] == 'L') {
+							setvbuf(f, NULL, _IOLBF, 0);
+							log_linebuf_files.insert(f);
+						}
 					} else {
 						std::cerr << "Can't open log file `" << filename << "' for writing!\n";
 						exit(1);
@@ -436,6 +445,7 @@ int main(int argc, char **argv)
 			log_experimentals_ignored.insert(ignores.begin(), ignores.end());
 		}
 		if (result.count("perffile")) perffile = result["perffile"].as<std::string>();
+		if (result.count("tracefile")) tracefile = result["tracefile"].as<std::string>();
 		if (result.count("infile")) {
 			frontend_files = result["infile"].as<std::vector<std::string>>();
 		}
@@ -521,6 +531,9 @@ int main(int argc, char **argv)
 #endif
 	log_error_atexit = yosys_atexit;
 
+	if (!tracefile.empty())
+		trace_start(tracefile);
+
 	for (auto &fn : plugin_filenames)
 		load_plugin(fn, {});
 
@@ -646,6 +659,7 @@ int main(int argc, char **argv)
 
 	if (print_stats)
 	{
+		log_flush();
 		std::string hash = log_hasher->final().substr(0, 10);
 		delete log_hasher;
 		log_hasher = nullptr;
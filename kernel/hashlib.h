@@ -803,6 +803,9 @@ public:
 	bool empty() const { return entries.empty(); }
 	void clear() { hashtable.clear(); entries.clear(); }
 
+	// heap memory of the container itself, not counting memory owned by the elements
+	size_t alloc_bytes() const { return hashtable.capacity() * sizeof(int) + entries.capacity() * sizeof(entry_t); }
+
 	iterator begin() { return iterator(this, int(entries.size())-1); }
 	iterator element(int n) { return iterator(this, int(entries.size())-1-n); }
 	iterator end() { return iterator(nullptr, -1); }
@@ -1170,6 +1173,9 @@ public:
 	bool empty() const { return entries.empty(); }
 	void clear() { hashtable.clear(); entries.clear(); }
 
+	// heap memory of the container itself, not counting memory owned by the elements
+	size_t alloc_bytes() const { return hashtable.capacity() * sizeof(int) + entries.capacity() * sizeof(entry_t); }
+
 	iterator begin() { return iterator(this, int(entries.size())-1); }
 	iterator element(int n) { return iterator(this, int(entries.size())-1-n); }
 	iterator end() { return iterator(nullptr, -1); }
@@ -39,6 +39,7 @@
 YOSYS_NAMESPACE_BEGIN
 
 std::vector<FILE*> log_files;
+std::set<FILE*> log_linebuf_files;
 std::vector<std::ostream*> log_streams;
 std::vector<std::string> log_scratchpads;
 std::map<std::string, std::set<std::string>> log_hdump;
@@ -74,6 +75,73 @@ static struct timeval initial_tv = { 0, 0 };
 static bool next_print_log = false;
 static int log_newline_count = 0;
 
+// Log output is collected in log_buffer (and log_hash_buffer) and written to
+// the sinks in larger chunks, one fwrite() per file and one hasher update per
+// chunk instead of one per message. The buffers belong to the sinks that were
+// registered when they were filled and are written out before log_files,
+// log_streams or log_hasher change, when they reach log_buffer_limit, and on
+// log_flush(). Output to a terminal or to a file in log_linebuf_files is still
+// written immediately.
+static const size_t log_buffer_limit = 64 * 1024;
+static std::string log_buffer, log_hash_buffer;
+static std::vector<FILE*> log_buffer_sinks, log_buffer_files, log_direct_files;
+static std::vector<std::ostream*> log_buffer_streams;
+static SHA1 *log_buffer_hasher = nullptr;
+static bool log_buffer_direct = false;
+
+static void log_write_buffer()
+{
+	if (!log_buffer.empty()) {
+		for (auto f : log_buffer_files)
+			fwrite(log_buffer.data(), 1, log_buffer.size(), f);
+		if (!log_buffer_direct)
+			for (auto f : log_buffer_streams)
+				f->write(log_buffer.data(), log_buffer.size());
+		log_buffer.clear();
+	}
+
+	if (!log_hash_buffer.empty()) {
+		log_buffer_hasher->update(log_hash_buffer);
+		log_hash_buffer.clear();
+	}
+}
+
+static void log_write(const std::string &str, bool hash)
+{
+	if (log_files != log_buffer_sinks || log_streams != log_buffer_streams || log_hasher != log_buffer_hasher) {
+		log_write_buffer();
+		log_buffer_sinks = log_files;
+		log_buffer_files.clear();
+		log_direct_files.clear();
+		log_buffer_streams = log_streams;
+		log_buffer_hasher = log_hasher;
+		log_buffer_direct = false;
+		for (auto f : log_files)
+			if (isatty(fileno(f))) {
+				log_direct_files.push_back(f);
+				log_buffer_direct = true;
+			} else if (log_linebuf_files.count(f))
+				log_direct_files.push_back(f);
+			else
+				log_buffer_files.push_back(f);
+	}
+
+	for (auto f : log_direct_files)
+		fputs(str.c_str(), f);
+	if (log_buffer_direct)
+		for (auto f : log_streams)
+			*f << str;
+
+	if (!log_buffer_files.empty() || (!log_buffer_direct && !log_streams.empty()))
+		log_buffer += str;
+
+	if (hash && log_hasher)
+		log_hash_buffer += str;
+
+	if (log_buffer.size() >= log_buffer_limit || log_hash_buffer.size() >= log_buffer_limit)
+		log_write_buffer();
+}
+
 static void log_id_cache_clear()
 {
 	for (auto p : log_id_cache)
@@ -111,6 +179,17 @@ void logv(const char *format, va_list ap)
 	if (log_make_debug && !ys_debug(1))
 		return;
 
+	if (log_files.empty() && log_streams.empty() && log_hasher == nullptr && log_scratchpads.empty() &&
+			log_warn_regexes.empty() && log_expect_log.empty()) {
+		// nothing would see this message (e.g. `yosys -q`), so don't format
+		// it and only estimate the trailing newlines from the format string
+		int len = strlen(format), nl = 0;
+		while (nl < len && format[len-nl-1] == '\n')
+			nl++;
+		log_newline_count = nl == len ? log_newline_count + nl : nl;
+		return;
+	}
+
 	std::string str = vstringf(format, ap);
 
 	if (str.empty())
@@ -122,9 +201,6 @@ void logv(const char *format, va_list ap)
 	else
 		log_newline_count = GetSize(str) - nnl_pos - 1;
 
-	if (log_hasher)
-		log_hasher->update(str);
-
 	if (log_time)
 	{
 		std::string time_str;
@@ -153,18 +229,11 @@ void logv(const char *format, va_list ap)
 		if (!strcmp(format, "%s") && str.back() == '\n')
 			next_print_log = true;
 
-		for (auto f : log_files)
-			fputs(time_str.c_str(), f);
-
-		for (auto f : log_streams)
-			*f << time_str;
+		if (!time_str.empty())
+			log_write(time_str, false);
 	}
 
-	for (auto f : log_files)
-		fputs(str.c_str(), f);
-
-	for (auto f : log_streams)
-		*f << str;
+	log_write(str, true);
 
 	RTLIL::Design *design = yosys_get_design();
 	if (design != nullptr)
@@ -609,6 +678,8 @@ void log_reset_stack()
 
 void log_flush()
 {
+	log_write_buffer();
+
 	for (auto f : log_files)
 		fflush(f);
 
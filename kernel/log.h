@@ -95,6 +95,7 @@ YOSYS_NAMESPACE_BEGIN
 struct log_cmd_error_exception { };
 
 extern std::vector<FILE*> log_files;
+extern std::set<FILE*> log_linebuf_files;
 extern std::vector<std::ostream*> log_streams;
 extern std::vector<std::string> log_scratchpads;
 extern std::map<std::string, std::set<std::string>> log_hdump;
@@ -56,28 +56,35 @@ struct ModIndex : public RTLIL::Monitor
 		}
 	};
 
+	// Most bits connect to only a handful of ports, so they are kept in a plain vector instead of a pool: a pool
+	// per bit costs several allocations and dominated the time spent building the index of large modules.
 	struct SigBitInfo
 	{
 		bool is_input, is_output;
-		pool<PortInfo> ports;
+		std::vector<PortInfo> ports;
 
 		SigBitInfo() : is_input(false), is_output(false) { }
 
 		bool operator==(const SigBitInfo &other) const {
-			return is_input == other.is_input && is_output == other.is_output && ports == other.ports;
+			if (is_input != other.is_input || is_output != other.is_output || ports.size() != other.ports.size())
+				return false;
+			std::vector<PortInfo> sorted_ports = ports, other_sorted_ports = other.ports;
+			std::sort(sorted_ports.begin(), sorted_ports.end());
+			std::sort(other_sorted_ports.begin(), other_sorted_ports.end());
+			return sorted_ports == other_sorted_ports;
 		}
 
-		void merge(const SigBitInfo &other)
+		void merge(SigBitInfo &&other)
 		{
 			is_input = is_input || other.is_input;
 			is_output = is_output || other.is_output;
-			ports.insert(other.ports.begin(), other.ports.end());
+			ports.insert(ports.end(), other.ports.begin(), other.ports.end());
 		}
 	};
 
 	SigMap sigmap;
 	RTLIL::Module *module;
-	std::map<RTLIL::SigBit, SigBitInfo> database;
+	dict<RTLIL::SigBit, SigBitInfo> database;
 	int auto_reload_counter;
 	bool auto_reload_module;
 
@@ -86,7 +93,7 @@ struct ModIndex : public RTLIL::Monitor
 		for (int i = 0; i < GetSize(sig); i++) {
 			RTLIL::SigBit bit = sigmap(sig[i]);
 			if (bit.wire)
-				database[bit].ports.insert(PortInfo(cell, port, i));
+				database[bit].ports.push_back(PortInfo(cell, port, i));
 		}
 	}
 
@@ -94,8 +101,14 @@ struct ModIndex : public RTLIL::Monitor
 	{
 		for (int i = 0; i < GetSize(sig); i++) {
 			RTLIL::SigBit bit = sigmap(sig[i]);
-			if (bit.wire)
-				database[bit].ports.erase(PortInfo(cell, port, i));
+			if (!bit.wire)
+				continue;
+			std::vector<PortInfo> &ports = database[bit].ports;
+			auto it = std::find(ports.begin(), ports.end(), PortInfo(cell, port, i));
+			if (it != ports.end()) {
+				*it = ports.back();
+				ports.pop_back();
+			}
 		}
 	}
 
@@ -112,6 +125,7 @@ struct ModIndex : public RTLIL::Monitor
 		}
 
 		database.clear();
+		database.reserve(GetSize(module->wires()) + GetSize(module->cells()));
 		for (auto wire : module->wires())
 			if (wire->port_input || wire->port_output)
 				for (int i = 0; i < GetSize(wire); i++) {
@@ -190,29 +204,29 @@ struct ModIndex : public RTLIL::Monitor
 				sigmap.add(lhs, rhs);
 			} else
 			if (!has_rhs) {
-				SigBitInfo new_info = database.at(lhs);
+				SigBitInfo new_info = std::move(database.at(lhs));
 				database.erase(lhs);
 				sigmap.add(lhs, rhs);
 				lhs = sigmap(lhs);
 				if (lhs.wire)
-					database[lhs] = new_info;
+					database[lhs] = std::move(new_info);
 			} else
 			if (!has_lhs) {
-				SigBitInfo new_info = database.at(rhs);
+				SigBitInfo new_info = std::move(database.at(rhs));
 				database.erase(rhs);
 				sigmap.add(lhs, rhs);
 				rhs = sigmap(rhs);
 				if (rhs.wire)
-					database[rhs] = new_info;
+					database[rhs] = std::move(new_info);
 			} else {
-				SigBitInfo new_info = database.at(lhs);
-				new_info.merge(database.at(rhs));
+				SigBitInfo new_info = std::move(database.at(lhs));
+				new_info.merge(std::move(database.at(rhs)));
 				database.erase(lhs);
 				database.erase(rhs);
 				sigmap.add(lhs, rhs);
 				rhs = sigmap(rhs);
 				if (rhs.wire)
-					database[rhs] = new_info;
+					database[rhs] = std::move(new_info);
 			}
 		}
 	}
@@ -269,9 +283,9 @@ struct ModIndex : public RTLIL::Monitor
 		return info->is_output;
 	}
 
-	pool<PortInfo> &query_ports(RTLIL::SigBit bit)
+	const std::vector<PortInfo> &query_ports(RTLIL::SigBit bit)
 	{
-		static pool<PortInfo> empty_result_set;
+		static const std::vector<PortInfo> empty_result_set;
 		SigBitInfo *info = query(bit);
 		if (info == nullptr)
 			return empty_result_set;
@@ -287,13 +301,21 @@ struct ModIndex : public RTLIL::Monitor
 			reload_module();
 		}
 
-		for (auto &it : database) {
-			log("BIT %s:\n", log_signal(it.first));
-			if (it.second.is_input)
+		std::vector<RTLIL::SigBit> bits;
+		for (auto &it : database)
+			bits.push_back(it.first);
+		std::sort(bits.begin(), bits.end());
+
+		for (auto bit : bits) {
+			SigBitInfo &info = database.at(bit);
+			log("BIT %s:\n", log_signal(bit));
+			if (info.is_input)
 				log("  PRIMARY INPUT\n");
-			if (it.second.is_output)
+			if (info.is_output)
 				log("  PRIMARY OUTPUT\n");
-			for (auto &port : it.second.ports)
+			std::vector<PortInfo> ports = info.ports;
+			std::sort(ports.begin(), ports.end());
+			for (auto &port : ports)
 				log("  PORT: %s.%s[%d] (%s)\n", log_id(port.cell),
 						log_id(port.port), port.offset, log_id(port.cell->type));
 		}
@@ -335,8 +357,9 @@ struct ModWalker
 	CellTypes ct;
 	SigMap sigmap;
 
-	dict<RTLIL::SigBit, pool<PortBit>> signal_drivers;
-	dict<RTLIL::SigBit, pool<PortBit>> signal_consumers;
+	// Each port bit is added exactly once, so plain vectors suffice for the per-bit port lists.
+	dict<RTLIL::SigBit, std::vector<PortBit>> signal_drivers;
+	dict<RTLIL::SigBit, std::vector<PortBit>> signal_consumers;
 	pool<RTLIL::SigBit> signal_inputs, signal_outputs;
 
 	dict<RTLIL::Cell*, pool<RTLIL::SigBit>> cell_outputs, cell_inputs;
@@ -358,18 +381,23 @@ struct ModWalker
 		}
 	}
 
-	void add_cell_port(RTLIL::Cell *cell, RTLIL::IdString port, std::vector<RTLIL::SigBit> bits, bool is_output, bool is_input)
+	void add_cell_port(RTLIL::Cell *cell, RTLIL::IdString port, const std::vector<RTLIL::SigBit> &bits, bool is_output, bool is_input)
 	{
+		pool<RTLIL::SigBit> *outputs = nullptr, *inputs = nullptr;
 		for (int i = 0; i < int(bits.size()); i++)
 			if (bits[i].wire != NULL) {
 				PortBit pbit {cell, port, i};
 				if (is_output) {
-					signal_drivers[bits[i]].insert(pbit);
-					cell_outputs[cell].insert(bits[i]);
+					if (outputs == nullptr)
+						outputs = &cell_outputs[cell];
+					signal_drivers[bits[i]].push_back(pbit);
+					outputs->insert(bits[i]);
 				}
 				if (is_input) {
-					signal_consumers[bits[i]].insert(pbit);
-					cell_inputs[cell].insert(bits[i]);
+					if (inputs == nullptr)
+						inputs = &cell_inputs[cell];
+					signal_consumers[bits[i]].push_back(pbit);
+					inputs->insert(bits[i]);
 				}
 			}
 	}
@@ -407,6 +435,11 @@ struct ModWalker
 		cell_inputs.clear();
 		cell_outputs.clear();
 
+		signal_drivers.reserve(GetSize(module->cells_));
+		signal_consumers.reserve(GetSize(module->cells_));
+		cell_inputs.reserve(GetSize(module->cells_));
+		cell_outputs.reserve(GetSize(module->cells_));
+
 		for (auto &it : module->wires_)
 			add_wire(it.second);
 		for (auto &it : module->cells_)
@@ -419,9 +452,9 @@ struct ModWalker
 	inline bool get_drivers(pool<PortBit> &result, RTLIL::SigBit bit) const
 	{
 		bool found = false;
-		if (signal_drivers.count(bit)) {
-			const pool<PortBit> &r = signal_drivers.at(bit);
-			result.insert(r.begin(), r.end());
+		auto it = signal_drivers.find(bit);
+		if (it != signal_drivers.end()) {
+			result.insert(it->second.begin(), it->second.end());
 			found = true;
 		}
 		return found;
@@ -430,9 +463,9 @@ struct ModWalker
 	inline bool get_consumers(pool<PortBit> &result, RTLIL::SigBit bit) const
 	{
 		bool found = false;
-		if (signal_consumers.count(bit)) {
-			const pool<PortBit> &r = signal_consumers.at(bit);
-			result.insert(r.begin(), r.end());
+		auto it = signal_consumers.find(bit);
+		if (it != signal_consumers.end()) {
+			result.insert(it->second.begin(), it->second.end());
 			found = true;
 		}
 		return found;
@@ -460,12 +493,13 @@ struct ModWalker
 	inline bool get_drivers(pool<PortBit> &result, const T &bits) const
 	{
 		bool found = false;
-		for (RTLIL::SigBit bit : bits)
-			if (signal_drivers.count(bit)) {
-				const pool<PortBit> &r = signal_drivers.at(bit);
-				result.insert(r.begin(), r.end());
+		for (RTLIL::SigBit bit : bits) {
+			auto it = signal_drivers.find(bit);
+			if (it != signal_drivers.end()) {
+				result.insert(it->second.begin(), it->second.end());
 				found = true;
 			}
+		}
 		return found;
 	}
 
@@ -473,12 +507,13 @@ struct ModWalker
 	inline bool get_consumers(pool<PortBit> &result, const T &bits) const
 	{
 		bool found = false;
-		for (RTLIL::SigBit bit : bits)
-			if (signal_consumers.count(bit)) {
-				const pool<PortBit> &r = signal_consumers.at(bit);
-				result.insert(r.begin(), r.end());
+		for (RTLIL::SigBit bit : bits) {
+			auto it = signal_consumers.find(bit);
+			if (it != signal_consumers.end()) {
+				result.insert(it->second.begin(), it->second.end());
 				found = true;
 			}
+		}
 		return found;
 	}
 
@@ -21,6 +21,7 @@
 #include "kernel/satgen.h"
 #include "kernel/json.h"
 #include "kernel/gzip.h"
+#include "kernel/trace.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -97,6 +98,7 @@ Pass::pre_post_exec_state_t Pass::pre_execute()
 	call_counter++;
 	state.begin_ns = PerformanceTimer::query();
 	state.parent_pass = current_pass;
+	state.trace_depth = yosys_trace_enabled ? trace_begin(pass_name, "pass") : -1;
 	current_pass = this;
 	clear_flags();
 	return state;
@@ -106,6 +108,10 @@ void Pass::post_execute(Pass::pre_post_exec_state_t state)
 {
 	IdString::checkpoint();
 	log_suppressed();
+	log_flush();
+
+	if (state.trace_depth >= 0)
+		trace_end(state.trace_depth);
 
 	int64_t time_ns = PerformanceTimer::query() - state.begin_ns;
 	runtime_ns += time_ns;
@@ -331,6 +337,12 @@ bool ScriptPass::check_label(std::string label, std::string info)
 			if (label == active_run_to)
 				block_active = false;
 		}
+		if (trace_label_depth >= 0) {
+			trace_end(trace_label_depth);
+			trace_label_depth = -1;
+		}
+		if (block_active && yosys_trace_enabled)
+			trace_label_depth = trace_begin(pass_name + ":" + label, "label");
 		return block_active;
 	}
 }
@@ -364,10 +376,15 @@ void ScriptPass::run_script(RTLIL::Design *design, std::string run_from, std::st
 {
 	help_mode = false;
 	active_design = design;
+	trace_label_depth = -1;
 	block_active = run_from.empty();
 	active_run_from = run_from;
 	active_run_to = run_to;
 	script();
+	if (trace_label_depth >= 0) {
+		trace_end(trace_label_depth);
+		trace_label_depth = -1;
+	}
 }
 
 void ScriptPass::help_script()
@@ -989,6 +1006,7 @@ struct HelpPass : public Pass {
 						log("WARNING: THE '%s' COMMAND IS EXPERIMENTAL.\n", it.first.c_str());
 						log("\n");
 					}
+					log_flush();
 					log_streams.pop_back();
 					write_cmd_rst(it.first, it.second->short_help, buf.str());
 				}
@@ -47,6 +47,7 @@ struct Pass
 	struct pre_post_exec_state_t {
 		Pass *parent_pass;
 		int64_t begin_ns;
+		int trace_depth;
 	};
 
 	pre_post_exec_state_t pre_execute();
@@ -80,6 +81,7 @@ struct ScriptPass : Pass
 	bool block_active, help_mode;
 	RTLIL::Design *active_design;
 	std::string active_run_from, active_run_to;
+	int trace_label_depth = -1;
 
 	ScriptPass(std::string name, std::string short_help = "** document me **") : Pass(name, short_help) { }
 
@@ -547,6 +547,19 @@ bool RTLIL::Const::empty() const {
 	}
 }
 
+size_t RTLIL::Const::alloc_bytes() const {
+	if (is_str()) {
+		// short strings are stored inline
+		const char *data = str_.data();
+		if (data >= (const char*)&str_ && data < (const char*)(&str_ + 1))
+			return 0;
+		return str_.capacity() + 1;
+	} else {
+		check(is_bits());
+		return bits_.capacity() * sizeof(RTLIL::State);
+	}
+}
+
 void RTLIL::Const::bitvectorize() const {
 	if (tag == backing_tag::bits)
 		return;
@@ -1303,6 +1316,7 @@ RTLIL::Module::~Module()
 		delete pr.second;
 	for (auto binding : bindings_)
 		delete binding;
+	delete sigmap_cache_;
 #ifdef WITH_PYTHON
 	RTLIL::Module::get_all_modules()->erase(hashidx_);
 #endif
@@ -1337,6 +1351,7 @@ void RTLIL::Module::makeblackbox()
 	processes.clear();
 
 	connections_.clear();
+	invalidate_sigmap();
 
 	remove(delwires);
 	set_bool_attribute(ID::blackbox);
@@ -2462,6 +2477,13 @@ void RTLIL::Module::check()
 
 	for (auto &it : attributes)
 		log_assert(!it.first.empty());
+
+	if (sigmap_cache_ != nullptr && sigmap_cache_connections_ == connections_.size()) {
+		SigMap fresh_sigmap(this);
+		for (auto &it : wires_)
+			for (auto bit : SigSpec(it.second))
+				log_assert((*sigmap_cache_)(bit) == fresh_sigmap(bit));
+	}
 #endif
 }
 
@@ -2819,6 +2841,11 @@ void RTLIL::Module::connect(const RTLIL::SigSig &conn)
 
 	log_assert(GetSize(conn.first) == GetSize(conn.second));
 	connections_.push_back(conn);
+
+	if (sigmap_cache_ != nullptr && sigmap_cache_connections_ + 1 == connections_.size()) {
+		sigmap_cache_->add(conn.first, conn.second);
+		sigmap_cache_connections_++;
+	}
 }
 
 void RTLIL::Module::connect(const RTLIL::SigSpec &lhs, const RTLIL::SigSpec &rhs)
@@ -2843,6 +2870,7 @@ void RTLIL::Module::new_connections(const std::vector<RTLIL::SigSig> &new_conn)
 	}
 
 	connections_ = new_conn;
+	invalidate_sigmap();
 }
 
 const std::vector<RTLIL::SigSig> &RTLIL::Module::connections() const
@@ -2850,6 +2878,24 @@ const std::vector<RTLIL::SigSig> &RTLIL::Module::connections() const
 	return connections_;
 }
 
+const SigMap &RTLIL::Module::sigmap()
+{
+	// A changed number of connections means that connections_ was modified without going through connect().
+	if (sigmap_cache_ == nullptr || sigmap_cache_connections_ != connections_.size()) {
+		if (sigmap_cache_ == nullptr)
+			sigmap_cache_ = new SigMap;
+		sigmap_cache_->set(this);
+		sigmap_cache_connections_ = connections_.size();
+	}
+	return *sigmap_cache_;
+}
+
+void RTLIL::Module::invalidate_sigmap()
+{
+	delete sigmap_cache_;
+	sigmap_cache_ = nullptr;
+}
+
 void RTLIL::Module::fixup_ports()
 {
 	std::vector<RTLIL::Wire*> all_ports;
@@ -4689,6 +4735,14 @@ void RTLIL::SigSpec::unpack() const
 	that->hash_ = 0;
 }
 
+size_t RTLIL::SigSpec::alloc_bytes() const
+{
+	size_t bytes = chunks_.capacity() * sizeof(RTLIL::SigChunk) + bits_.capacity() * sizeof(RTLIL::SigBit);
+	for (auto &c : chunks_)
+		bytes += c.data.capacity() * sizeof(RTLIL::State);
+	return bytes;
+}
+
 void RTLIL::SigSpec::updhash() const
 {
 	RTLIL::SigSpec *that = (RTLIL::SigSpec*)this;
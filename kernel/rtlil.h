@@ -782,6 +782,9 @@ public:
 	bool empty() const;
 	void bitvectorize() const;
 
+	// heap memory owned by this constant (for internal_stats)
+	size_t alloc_bytes() const;
+
 	void append(const RTLIL::Const &other);
 
 	class const_iterator {
@@ -1072,6 +1075,9 @@ public:
 	inline int size() const { return width_; }
 	inline bool empty() const { return width_ == 0; }
 
+	// heap memory owned by this SigSpec in its current representation (for internal_stats)
+	size_t alloc_bytes() const;
+
 	inline RTLIL::SigBit &operator[](int index) { inline_unpack(); return bits_.at(index); }
 	inline const RTLIL::SigBit &operator[](int index) const { inline_unpack(); return bits_.at(index); }
 
@@ -1482,6 +1488,9 @@ struct RTLIL::Design
 #endif
 };
 
+// Forward declaration; defined in sigtools.h.
+struct SigMap;
+
 struct RTLIL::Module : public RTLIL::NamedObject
 {
 	Hasher::hash_t hashidx_;
@@ -1492,6 +1501,10 @@ protected:
 	void add(RTLIL::Cell *cell);
 	void add(RTLIL::Process *process);
 
+private:
+	SigMap *sigmap_cache_ = nullptr;
+	size_t sigmap_cache_connections_ = 0;
+
 public:
 	RTLIL::Design *design;
 	pool<RTLIL::Monitor*> monitors;
@@ -1532,6 +1545,13 @@ public:
 	void new_connections(const std::vector<RTLIL::SigSig> &new_conn);
 	const std::vector<RTLIL::SigSig> &connections() const;
 
+	// A SigMap of the module's connections that passes can share instead of each building their own. It is
+	// built on first use, extended by connect(), and dropped by new_connections(), rewrite_sigspecs() and wire
+	// removal, which also ends the lifetime of references to it. Code that modifies connections_ directly has to
+	// call invalidate_sigmap() itself.
+	const SigMap &sigmap();
+	void invalidate_sigmap();
+
 	std::vector<RTLIL::IdString> ports;
 	void fixup_ports();
 
@@ -2099,6 +2119,7 @@ inline RTLIL::SigBit::SigBit(const RTLIL::SigSpec &sig) {
 template<typename T>
 void RTLIL::Module::rewrite_sigspecs(T &functor)
 {
+	invalidate_sigmap();
 	for (auto &it : cells_)
 		it.second->rewrite_sigspecs(functor);
 	for (auto &it : processes)
@@ -2112,6 +2133,7 @@ void RTLIL::Module::rewrite_sigspecs(T &functor)
 template<typename T>
 void RTLIL::Module::rewrite_sigspecs2(T &functor)
 {
+	invalidate_sigmap();
 	for (auto &it : cells_)
 		it.second->rewrite_sigspecs2(functor);
 	for (auto &it : processes)
@@ -1347,11 +1347,11 @@ bool SatGen::importCell(RTLIL::Cell *cell, int timestep)
 	{
 		auto key = make_pair(prefix, timestep);
 		if (initstates.count(key) == 0)
-			initstates[key] = false;
+			initstates[key] = ez->CONST_FALSE;
 
 		std::vector<int> y = importDefSigSpec(cell->getPort(ID::Y), timestep);
 		log_assert(GetSize(y) == 1);
-		ez->SET(y[0], initstates[key] ? ez->CONST_TRUE : ez->CONST_FALSE);
+		ez->SET(y[0], initstates[key]);
 
 		if (model_undef) {
 			std::vector<int> undef_y = importUndefSigSpec(cell->getPort(ID::Y), timestep);
@@ -70,7 +70,7 @@ struct SatGen
 	std::map<std::string, RTLIL::SigSpec> asserts_a, asserts_en;
 	std::map<std::string, RTLIL::SigSpec> assumes_a, assumes_en;
 	std::map<std::string, std::map<RTLIL::SigBit, int>> imported_signals;
-	std::map<std::pair<std::string, int>, bool> initstates;
+	std::map<std::pair<std::string, int>, int> initstates;
 	bool ignore_div_by_zero;
 	bool model_undef;
 	bool def_formal = false;
@@ -280,11 +280,13 @@ struct SatGen
 		ez->assume(ez->OR(undef, ez->IFF(y, yy)));
 	}
 
-	void setInitState(int timestep)
+	// $initstate is true in this timestep, or only when the given literal is
+	// true (e.g. an activation literal for the initial state constraints)
+	void setInitState(int timestep, int literal = ezSAT::CONST_TRUE)
 	{
 		auto key = make_pair(prefix, timestep);
-		log_assert(initstates.count(key) == 0 || initstates.at(key) == true);
-		initstates[key] = true;
+		log_assert(initstates.count(key) == 0 || initstates.at(key) == literal);
+		initstates[key] = literal;
 	}
 
 	bool importCell(RTLIL::Cell *cell, int timestep = -1);
@@ -0,0 +1,208 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/strash.h"
+#include "kernel/celltypes.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+namespace {
+
+struct StrashWorker
+{
+	RTLIL::Module *module;
+	SigMap &sigmap;
+	CellTypes ct;
+
+	struct CellKey
+	{
+		RTLIL::IdString type;
+		// sorted by name, inputs are sigmapped
+		std::vector<std::pair<RTLIL::IdString, RTLIL::Const>> parameters;
+		std::vector<std::pair<RTLIL::IdString, RTLIL::SigSpec>> inputs;
+
+		bool operator==(const CellKey &other) const {
+			return type == other.type && parameters == other.parameters && inputs == other.inputs;
+		}
+
+		[[nodiscard]] Hasher hash_into(Hasher h) const {
+			h.eat(type);
+			for (auto &it : parameters) {
+				h.eat(it.first);
+				h.eat(it.second);
+			}
+			for (auto &it : inputs) {
+				h.eat(it.first);
+				h.eat(it.second);
+			}
+			return h;
+		}
+	};
+
+	dict<RTLIL::SigBit, RTLIL::Cell*> bit_driver;
+	dict<CellKey, RTLIL::Cell*> known_cells;
+	pool<RTLIL::Cell*> duplicates;
+
+	StrashWorker(RTLIL::Module *module, SigMap &sigmap) : module(module), sigmap(sigmap)
+	{
+		// only cells that are pure functions of their inputs, which
+		// excludes $anyconst, $anyseq, $tribuf and friends
+		ct.setup_internals_eval();
+		ct.setup_stdcells_eval();
+	}
+
+	CellKey cell_key(RTLIL::Cell *cell)
+	{
+		CellKey key;
+		key.type = cell->type;
+
+		for (auto &param : cell->parameters)
+			key.parameters.push_back(param);
+
+		for (auto &conn : cell->connections())
+			if (ct.cell_input(cell->type, conn.first))
+				key.inputs.push_back(std::make_pair(conn.first, sigmap(conn.second)));
+
+		std::sort(key.parameters.begin(), key.parameters.end(), [](const std::pair<RTLIL::IdString, RTLIL::Const> &a, const std::pair<RTLIL::IdString, RTLIL::Const> &b) {
+			return a.first < b.first;
+		});
+		std::sort(key.inputs.begin(), key.inputs.end(), [](const std::pair<RTLIL::IdString, RTLIL::SigSpec> &a, const std::pair<RTLIL::IdString, RTLIL::SigSpec> &b) {
+			return a.first < b.first;
+		});
+
+		if (cell->type.in(ID($and), ID($or), ID($xor), ID($xnor), ID($add), ID($mul),
+				ID($logic_and), ID($logic_or), ID($eq), ID($ne), ID($eqx), ID($nex),
+				ID($_AND_), ID($_OR_), ID($_XOR_), ID($_NAND_), ID($_NOR_), ID($_XNOR_)))
+		{
+			// swapping A and B together with their parameters keeps the
+			// function of these cells, so store them in a canonical order
+			auto find = [](auto &vec, RTLIL::IdString name) {
+				for (auto &it : vec)
+					if (it.first == name)
+						return &it.second;
+				return decltype(&vec.front().second)(nullptr);
+			};
+
+			RTLIL::SigSpec *sig_a = find(key.inputs, ID::A), *sig_b = find(key.inputs, ID::B);
+			RTLIL::Const *a_signed = find(key.parameters, ID::A_SIGNED), *b_signed = find(key.parameters, ID::B_SIGNED);
+			RTLIL::Const *a_width = find(key.parameters, ID::A_WIDTH), *b_width = find(key.parameters, ID::B_WIDTH);
+
+			if (sig_a && sig_b && (a_signed == nullptr) == (b_signed == nullptr) && (a_width == nullptr) == (b_width == nullptr)) {
+				bool a_sgn = a_signed && a_signed->as_bool(), b_sgn = b_signed && b_signed->as_bool();
+				if (std::make_pair(*sig_b, b_sgn) < std::make_pair(*sig_a, a_sgn)) {
+					std::swap(*sig_a, *sig_b);
+					if (a_signed)
+						std::swap(*a_signed, *b_signed);
+					if (a_width)
+						std::swap(*a_width, *b_width);
+				}
+			}
+		}
+
+		return key;
+	}
+
+	void hash_cell(RTLIL::Cell *cell)
+	{
+		CellKey key = cell_key(cell);
+
+		auto it = known_cells.find(key);
+		if (it == known_cells.end()) {
+			known_cells.emplace(std::move(key), cell);
+			return;
+		}
+
+		RTLIL::Cell *other = it->second;
+		for (auto &conn : cell->connections())
+			if (ct.cell_output(cell->type, conn.first))
+				sigmap.add(conn.second, other->getPort(conn.first));
+
+		duplicates.insert(cell);
+	}
+
+	void run()
+	{
+		for (auto cell : module->cells())
+		{
+			if (!ct.cell_evaluable(cell->type))
+				continue;
+
+			for (auto &conn : cell->connections())
+				if (ct.cell_output(cell->type, conn.first))
+					for (auto bit : conn.second) {
+						sigmap.apply(bit);
+						if (bit.wire != nullptr)
+							bit_driver[bit] = cell;
+					}
+		}
+
+		// iterative DFS so that deep logic cones don't exhaust the stack,
+		// a cell is hashed once the drivers of all its inputs are
+		pool<RTLIL::Cell*> visited;
+		std::vector<std::pair<RTLIL::Cell*, bool>> stack;
+
+		for (auto cell : module->cells())
+		{
+			if (!ct.cell_evaluable(cell->type))
+				continue;
+
+			stack.push_back(std::make_pair(cell, false));
+
+			while (!stack.empty())
+			{
+				RTLIL::Cell *c = stack.back().first;
+
+				if (stack.back().second) {
+					stack.pop_back();
+					hash_cell(c);
+					continue;
+				}
+
+				if (visited.count(c)) {
+					stack.pop_back();
+					continue;
+				}
+
+				visited.insert(c);
+				stack.back().second = true;
+
+				for (auto &conn : c->connections()) {
+					if (!ct.cell_input(c->type, conn.first))
+						continue;
+					for (auto bit : conn.second) {
+						auto drv = bit_driver.find(sigmap(bit));
+						if (drv != bit_driver.end() && !visited.count(drv->second))
+							stack.push_back(std::make_pair(drv->second, false));
+					}
+				}
+			}
+		}
+	}
+};
+
+}
+
+pool<RTLIL::Cell*> strash_cells(RTLIL::Module *module, SigMap &sigmap)
+{
+	StrashWorker worker(module, sigmap);
+	worker.run();
+	return std::move(worker.duplicates);
+}
+
+YOSYS_NAMESPACE_END
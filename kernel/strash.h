@@ -15,38 +15,26 @@
  *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
  *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  *
- *  ---
- *
- *  A very simple and straightforward frontend for the RTLIL text
- *  representation.
- *
  */
 
-#ifndef RTLIL_FRONTEND_H
-#define RTLIL_FRONTEND_H
+#ifndef STRASH_H
+#define STRASH_H
 
 #include "kernel/yosys.h"
+#include "kernel/sigtools.h"
 
 YOSYS_NAMESPACE_BEGIN
 
-namespace RTLIL_FRONTEND {
-	extern std::istream *lexin;
-	extern RTLIL::Design *current_design;
-	extern bool flag_nooverwrite;
-	extern bool flag_overwrite;
-	extern bool flag_lib;
-}
+// Structural hashing for backends that export a module without modifying it.
+//
+// Finds combinational cells that compute the same function of the same
+// (sigmapped) inputs as another cell, visiting the drivers of each cell's
+// inputs first so that chains of duplicates collapse in a single sweep.
+// The outputs of every duplicate are merged into the outputs of the cell it
+// duplicates in `sigmap`, and the duplicates are returned so the caller can
+// leave them out of its driver index. The module itself is left untouched.
+pool<RTLIL::Cell*> strash_cells(RTLIL::Module *module, SigMap &sigmap);
 
 YOSYS_NAMESPACE_END
 
-extern int rtlil_frontend_yydebug;
-int rtlil_frontend_yylex(void);
-void rtlil_frontend_yyerror(char const *s);
-void rtlil_frontend_yywarning(char const *s);
-void rtlil_frontend_yyrestart(FILE *f);
-int rtlil_frontend_yyparse(void);
-int rtlil_frontend_yylex_destroy(void);
-int rtlil_frontend_yyget_lineno(void);
-
 #endif
-
@@ -0,0 +1,194 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/trace.h"
+#include "kernel/json.h"
+
+#include <chrono>
+
+#if defined(__APPLE__) && defined(__MACH__)
+#include <mach/task.h>
+#include <mach/mach_init.h>
+#endif
+
+YOSYS_NAMESPACE_BEGIN
+
+bool yosys_trace_enabled = false;
+
+namespace {
+
+struct TraceEvent
+{
+	std::string name, module;
+	const char *category;
+	int64_t begin_ns, end_ns;
+	int64_t cpu_begin_ns, cpu_ns;
+	int64_t mem_begin, mem_delta;
+	int64_t peak_rss_kb;
+};
+
+std::string trace_filename;
+std::chrono::steady_clock::time_point trace_epoch;
+std::vector<TraceEvent> trace_stack, trace_events;
+
+int64_t wall_ns()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - trace_epoch).count();
+}
+
+int64_t peak_rss_kb()
+{
+#if defined(__linux__) || defined(__FreeBSD__)
+	struct rusage ru_buffer;
+	getrusage(RUSAGE_SELF, &ru_buffer);
+	return ru_buffer.ru_maxrss;
+#elif defined(__APPLE__)
+	struct rusage ru_buffer;
+	getrusage(RUSAGE_SELF, &ru_buffer);
+	return ru_buffer.ru_maxrss / 1024;
+#else
+	return 0;
+#endif
+}
+
+}
+
+std::optional<uint64_t> current_mem_bytes()
+{
+#if defined(__APPLE__)
+	task_basic_info_64_data_t basicInfo;
+	mach_msg_type_number_t count = TASK_BASIC_INFO_64_COUNT;
+	kern_return_t error = task_info(mach_task_self(), TASK_BASIC_INFO_64, (task_info_t)&basicInfo, &count);
+	if (error != KERN_SUCCESS)
+		return {};
+	return basicInfo.resident_size;
+#elif defined(__linux__)
+	// Not all linux distributions have to have this file
+	std::ifstream statusFile("/proc/self/status");
+	std::string line;
+	while (std::getline(statusFile, line)) {
+		if (line.find("VmRSS:") == 0) {
+			std::istringstream iss(line);
+			std::string token;
+			// Skip prefix
+			iss >> token;
+			uint64_t rss;
+			iss >> rss;
+			return rss * 1024;
+		}
+	}
+	return {};
+#else
+	return {};
+#endif
+}
+
+void trace_start(const std::string &filename)
+{
+	trace_stop();
+	trace_filename = filename;
+	trace_epoch = std::chrono::steady_clock::now();
+	yosys_trace_enabled = true;
+}
+
+void trace_stop()
+{
+	if (!yosys_trace_enabled)
+		return;
+
+	trace_end(0);
+	yosys_trace_enabled = false;
+
+	PrettyJson json;
+	if (!json.write_to_file(trace_filename)) {
+		// also called on the way out of log_error()
+		log_warning("Can't open trace file `%s' for writing: %s\n", trace_filename.c_str(), strerror(errno));
+		trace_events.clear();
+		return;
+	}
+
+	json.begin_object();
+	json.entry("displayTimeUnit", "ms");
+	json.name("otherData");
+	json.begin_object();
+	json.entry("generator", yosys_maybe_version());
+	json.end_object();
+	json.name("traceEvents");
+	json.begin_array();
+	for (auto &event : trace_events) {
+		Json::object args;
+		args["cpu_ms"] = event.cpu_ns / 1e6;
+		args["peak_rss_kb"] = (double)event.peak_rss_kb;
+		if (event.mem_begin >= 0)
+			args["rss_delta_kb"] = event.mem_delta / 1024.0;
+		if (!event.module.empty())
+			args["module"] = event.module;
+		json.value(Json::object {
+			{ "name", event.name },
+			{ "cat", event.category },
+			{ "ph", "X" },
+			{ "ts", event.begin_ns / 1e3 },
+			{ "dur", (event.end_ns - event.begin_ns) / 1e3 },
+			{ "pid", 1 },
+			{ "tid", 1 },
+			{ "args", args },
+		});
+	}
+	json.end_array();
+	json.end_object();
+	json.flush();
+
+	trace_events.clear();
+}
+
+int trace_begin(const std::string &name, const char *category, const RTLIL::Module *module)
+{
+	log_assert(yosys_trace_enabled);
+
+	TraceEvent event;
+	event.name = name;
+	if (module != nullptr)
+		event.module = log_id(module);
+	event.category = category;
+	event.cpu_begin_ns = PerformanceTimer::query();
+	auto mem = current_mem_bytes();
+	event.mem_begin = mem ? *mem : -1;
+	event.begin_ns = wall_ns();
+
+	trace_stack.push_back(std::move(event));
+	return GetSize(trace_stack) - 1;
+}
+
+void trace_end(int depth)
+{
+	while (GetSize(trace_stack) > depth) {
+		TraceEvent &event = trace_stack.back();
+		event.end_ns = wall_ns();
+		event.cpu_ns = PerformanceTimer::query() - event.cpu_begin_ns;
+		if (event.mem_begin >= 0) {
+			auto mem = current_mem_bytes();
+			event.mem_delta = mem ? *mem - event.mem_begin : 0;
+		}
+		event.peak_rss_kb = peak_rss_kb();
+		trace_events.push_back(std::move(event));
+		trace_stack.pop_back();
+	}
+}
+
+YOSYS_NAMESPACE_END
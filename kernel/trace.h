@@ -0,0 +1,76 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "kernel/yosys_common.h"
+
+#include <optional>
+
+YOSYS_NAMESPACE_BEGIN
+
+// Nested timing spans, written as Chrome trace event JSON when tracing was
+// started with `yosys --tracefile <file>`. The file can be opened in Perfetto
+// (https://ui.perfetto.dev) or chrome://tracing.
+//
+// Every pass invocation and every script label of a ScriptPass opens a span
+// automatically. Passes can add finer spans, e.g. one per module:
+//
+//	for (auto module : design->selected_modules()) {
+//		TraceSpan span("opt_expr", "module", module);
+//		...
+//	}
+//
+// When tracing is disabled a TraceSpan only tests yosys_trace_enabled.
+
+extern bool yosys_trace_enabled;
+
+void trace_start(const std::string &filename);
+void trace_stop();
+
+// Opens a span and returns the depth to pass to trace_end(), which also
+// closes any spans left open above it (e.g. by a pass that threw an error).
+int trace_begin(const std::string &name, const char *category, const RTLIL::Module *module = nullptr);
+void trace_end(int depth);
+
+// Resident set size of the process, if the platform reports it.
+std::optional<uint64_t> current_mem_bytes();
+
+struct TraceSpan
+{
+	int depth = -1;
+
+	TraceSpan(const char *name, const char *category, const RTLIL::Module *module = nullptr) {
+		if (yosys_trace_enabled)
+			depth = trace_begin(name, category, module);
+	}
+
+	~TraceSpan() {
+		if (depth >= 0)
+			trace_end(depth);
+	}
+
+	TraceSpan(const TraceSpan&) = delete;
+	TraceSpan &operator=(const TraceSpan&) = delete;
+};
+
+YOSYS_NAMESPACE_END
+
+#endif
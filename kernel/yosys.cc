@@ -238,6 +238,7 @@ void yosys_shutdown()
 	delete yosys_design;
 	yosys_design = NULL;
 
+	log_flush();
 	for (auto f : log_files)
 		if (f != stderr)
 			fclose(f);
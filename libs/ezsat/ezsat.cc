@@ -85,11 +85,12 @@ int ezSAT::literal()
 
 int ezSAT::literal(const std::string &name)
 {
-	if (literalsCache.count(name) == 0) {
-		literals.push_back(name);
-		literalsCache[name] = literals.size();
-	}
-	return literalsCache.at(name);
+	auto it = literalsCache.find(name);
+	if (it != literalsCache.end())
+		return it->second;
+	literals.push_back(name);
+	literalsCache[name] = literals.size();
+	return literals.size();
 }
 
 int ezSAT::frozen_literal()
@@ -108,23 +109,36 @@ int ezSAT::frozen_literal(const std::string &name)
 
 int ezSAT::expression(OpId op, int a, int b, int c, int d, int e, int f)
 {
-	std::vector<int> args(6);
-	args[0] = a, args[1] = b, args[2] = c;
-	args[3] = d, args[4] = e, args[5] = f;
-	return expression(op, args);
+	int args[6] = { a, b, c, d, e, f };
+	return make_expression(op, args, 6);
 }
 
 int ezSAT::expression(OpId op, const std::vector<int> &args)
 {
-	std::vector<int> myArgs;
-	myArgs.reserve(args.size());
+	return make_expression(op, args.data(), int(args.size()));
+}
+
+int ezSAT::make_expression(OpId op, const int *args, int numArgs)
+{
+	// most expressions have no more than six arguments, keep those off the heap
+	int smallArgs[6];
+	std::vector<int> largeArgs;
+	int *myArgs = smallArgs;
+	int myNumArgs = 0;
 	bool xorRemovedOddTrues = false;
 
+	if (numArgs > 6) {
+		largeArgs.resize(numArgs);
+		myArgs = largeArgs.data();
+	}
+
 	addhash(__LINE__);
 	addhash(op);
 
-	for (auto arg : args)
+	for (int i = 0; i < numArgs; i++)
 	{
+		int arg = args[i];
+
 		addhash(__LINE__);
 		addhash(arg);
 
@@ -138,24 +152,28 @@ int ezSAT::expression(OpId op, const std::vector<int> &args)
 			xorRemovedOddTrues = !xorRemovedOddTrues;
 			continue;
 		}
-		myArgs.push_back(arg);
+		myArgs[myNumArgs++] = arg;
 	}
 
-	if (myArgs.size() > 0 && (op == OpAnd || op == OpOr || op == OpXor || op == OpIFF)) {
-		std::sort(myArgs.begin(), myArgs.end());
+	if (myNumArgs > 0 && (op == OpAnd || op == OpOr || op == OpXor || op == OpIFF)) {
+		if (myNumArgs == 2) {
+			if (myArgs[0] > myArgs[1])
+				std::swap(myArgs[0], myArgs[1]);
+		} else
+			std::sort(myArgs, myArgs + myNumArgs);
 		int j = 0;
-		for (int i = 1; i < int(myArgs.size()); i++)
+		for (int i = 1; i < myNumArgs; i++)
 			if (j < 0 || myArgs[j] != myArgs[i])
 				myArgs[++j] = myArgs[i];
 			else if (op == OpXor)
 				j--;
-		myArgs.resize(j+1);
+		myNumArgs = j+1;
 	}
 
 	switch (op)
 	{
 	case OpNot:
-		assert(myArgs.size() == 1);
+		assert(myNumArgs == 1);
 		if (myArgs[0] == CONST_TRUE)
 			return CONST_FALSE;
 		if (myArgs[0] == CONST_FALSE)
@@ -163,35 +181,35 @@ int ezSAT::expression(OpId op, const std::vector<int> &args)
 		break;
 
 	case OpAnd:
-		if (myArgs.size() == 0)
+		if (myNumArgs == 0)
 			return CONST_TRUE;
-		if (myArgs.size() == 1)
+		if (myNumArgs == 1)
 			return myArgs[0];
 		break;
 
 	case OpOr:
-		if (myArgs.size() == 0)
+		if (myNumArgs == 0)
 			return CONST_FALSE;
-		if (myArgs.size() == 1)
+		if (myNumArgs == 1)
 			return myArgs[0];
 		break;
 
 	case OpXor:
-		if (myArgs.size() == 0)
+		if (myNumArgs == 0)
 			return xorRemovedOddTrues ? CONST_TRUE : CONST_FALSE;
-		if (myArgs.size() == 1)
+		if (myNumArgs == 1)
 			return xorRemovedOddTrues ? NOT(myArgs[0]) : myArgs[0];
 		break;
 
 	case OpIFF:
-		assert(myArgs.size() >= 1);
-		if (myArgs.size() == 1)
+		assert(myNumArgs >= 1);
+		if (myNumArgs == 1)
 			return CONST_TRUE;
 		// FIXME: Add proper const folding
 		break;
 
 	case OpITE:
-		assert(myArgs.size() == 3);
+		assert(myNumArgs == 3);
 		if (myArgs[0] == CONST_TRUE)
 			return myArgs[1];
 		if (myArgs[0] == CONST_FALSE)
@@ -202,16 +220,7 @@ int ezSAT::expression(OpId op, const std::vector<int> &args)
 		abort();
 	}
 
-	std::pair<OpId, std::vector<int>> myExpr(op, myArgs);
-	int id = 0;
-
-	if (expressionsCache.count(myExpr) > 0) {
-		id = expressionsCache.at(myExpr);
-	} else {
-		id = -(int(expressions.size()) + 1);
-		expressionsCache[myExpr] = id;
-		expressions.push_back(myExpr);
-	}
+	int id = intern_expression(op, myArgs, myNumArgs);
 
 	if (xorRemovedOddTrues)
 		id = NOT(id);
@@ -222,6 +231,44 @@ int ezSAT::expression(OpId op, const std::vector<int> &args)
 	return id;
 }
 
+unsigned int ezSAT::expression_hash(OpId op, const int *args, int numArgs)
+{
+	unsigned int h = 2166136261u ^ op;
+	for (int i = 0; i < numArgs; i++)
+		h = (h ^ (unsigned int)args[i]) * 16777619u;
+	return h ^ (h >> 15);
+}
+
+int ezSAT::intern_expression(OpId op, const int *args, int numArgs)
+{
+	if (2 * (expressions.size() + 1) > expressionsTable.size())
+	{
+		std::vector<int> newTable(std::max(size_t(1024), 2 * expressionsTable.size()));
+		size_t mask = newTable.size() - 1;
+		for (int i = 0; i < int(expressions.size()); i++) {
+			const std::vector<int> &exprArgs = expressions[i].second;
+			size_t slot = expression_hash(expressions[i].first, exprArgs.data(), int(exprArgs.size())) & mask;
+			while (newTable[slot] != 0)
+				slot = (slot + 1) & mask;
+			newTable[slot] = -(i + 1);
+		}
+		expressionsTable.swap(newTable);
+	}
+
+	size_t mask = expressionsTable.size() - 1;
+	size_t slot = expression_hash(op, args, numArgs) & mask;
+
+	for (; expressionsTable[slot] != 0; slot = (slot + 1) & mask) {
+		const std::pair<OpId, std::vector<int>> &expr = expressions[-expressionsTable[slot] - 1];
+		if (expr.first == op && int(expr.second.size()) == numArgs && std::equal(args, args + numArgs, expr.second.begin()))
+			return expressionsTable[slot];
+	}
+
+	expressions.push_back(std::make_pair(op, std::vector<int>(args, args + numArgs)));
+	expressionsTable[slot] = -int(expressions.size());
+	return expressionsTable[slot];
+}
+
 void ezSAT::lookup_literal(int id, std::string &name) const
 {
 	assert(0 < id && id <= int(literals.size()));
@@ -430,7 +477,7 @@ void ezSAT::assume(int id)
 				std::vector<int> clause;
 				for (int arg : args)
 					clause.push_back(bind(arg));
-				cnfClauses.push_back(clause);
+				cnfClauses.push_back(std::move(clause));
 				cnfClausesCount++;
 				return;
 			}
@@ -450,18 +497,24 @@ void ezSAT::assume(int id)
 }
 
 void ezSAT::add_clause(const std::vector<int> &args)
+{
+	add_clause(std::vector<int>(args));
+}
+
+void ezSAT::add_clause(std::vector<int> &&args)
 {
 	addhash(__LINE__);
 	for (auto arg : args)
 		addhash(arg);
 
-	cnfClauses.push_back(args);
+	cnfClauses.push_back(std::move(args));
 	cnfClausesCount++;
 }
 
 void ezSAT::add_clause(const std::vector<int> &args, bool argsPolarity, int a, int b, int c)
 {
 	std::vector<int> clause;
+	clause.reserve(args.size() + 3);
 	for (auto arg : args)
 		clause.push_back(argsPolarity ? +arg : -arg);
 	if (a != 0)
@@ -470,7 +523,7 @@ void ezSAT::add_clause(const std::vector<int> &args, bool argsPolarity, int a, i
 		clause.push_back(b);
 	if (c != 0)
 		clause.push_back(c);
-	add_clause(clause);
+	add_clause(std::move(clause));
 }
 
 void ezSAT::add_clause(int a, int b, int c)
@@ -482,7 +535,7 @@ void ezSAT::add_clause(int a, int b, int c)
 		clause.push_back(b);
 	if (c != 0)
 		clause.push_back(c);
-	add_clause(clause);
+	add_clause(std::move(clause));
 }
 
 int ezSAT::bind_cnf_not(const std::vector<int> &args)
@@ -1302,16 +1355,18 @@ void ezSAT::printInternalState(FILE *f) const
 	fprintf(f, "--8<-- snip --8<--\n");
 
 	fprintf(f, "literalsCache:\n");
-	for (auto &it : literalsCache)
-		fprintf(f, "    `%s' -> %d\n", it.first.c_str(), it.second);
+	for (int i = 0; i < int(literals.size()); i++)
+		if (literalsCache.count(literals[i]) && literalsCache.at(literals[i]) == i+1)
+			fprintf(f, "    `%s' -> %d\n", literals[i].c_str(), i+1);
 
 	fprintf(f, "literals:\n");
 	for (int i = 0; i < int(literals.size()); i++)
 		fprintf(f, "    %d: `%s'\n", i+1, literals[i].c_str());
 
-	fprintf(f, "expressionsCache:\n");
-	for (auto &it : expressionsCache)
-		fprintf(f, "    `%s' -> %d\n", expression2str(it.first).c_str(), it.second);
+	fprintf(f, "expressionsTable (size=%d):\n", int(expressionsTable.size()));
+	for (int i = 0; i < int(expressionsTable.size()); i++)
+		if (expressionsTable[i] != 0)
+			fprintf(f, "    %d: `%s' -> %d\n", i, expression2str(expressions[-expressionsTable[i]-1]).c_str(), expressionsTable[i]);
 
 	fprintf(f, "expressions:\n");
 	for (int i = 0; i < int(expressions.size()); i++)
@@ -22,6 +22,7 @@
 
 #include <set>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include <stdio.h>
@@ -54,18 +55,26 @@ private:
 
 	bool non_incremental_solve_used_up;
 
-	std::map<std::string, int> literalsCache;
+	std::unordered_map<std::string, int> literalsCache;
 	std::vector<std::string> literals;
 
-	std::map<std::pair<OpId, std::vector<int>>, int> expressionsCache;
+	// expressions are hash-consed: expressionsTable is an open-addressing hash table
+	// (linear probing, power-of-two size) holding the ids of the entries in expressions,
+	// with 0 marking an empty slot. the keys are not stored a second time.
+	std::vector<int> expressionsTable;
 	std::vector<std::pair<OpId, std::vector<int>>> expressions;
 
+	static unsigned int expression_hash(OpId op, const int *args, int numArgs);
+	int make_expression(OpId op, const int *args, int numArgs);
+	int intern_expression(OpId op, const int *args, int numArgs);
+
 	bool cnfConsumed;
 	int cnfVariableCount, cnfClausesCount;
 	std::vector<int> cnfLiteralVariables, cnfExpressionVariables;
 	std::vector<std::vector<int>> cnfClauses, cnfClausesBackup;
 
 	void add_clause(const std::vector<int> &args);
+	void add_clause(std::vector<int> &&args);
 	void add_clause(const std::vector<int> &args, bool argsPolarity, int a = 0, int b = 0, int c = 0);
 	void add_clause(int a, int b = 0, int c = 0);
 
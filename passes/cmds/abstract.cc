@@ -255,6 +255,7 @@ bool abstract_value_mod_port(Module* mod, Wire* wire, std::set<int> offsets, Ena
 		}
 	}
 	mod->connections_.push_back(SigSig(direct_lhs, direct_rhs));
+	mod->invalidate_sigmap();
 	emit_mux_anyseq(mod, mux_input, mux_output, enable);
 	return true;
 }
@@ -20,6 +20,13 @@
 #include "kernel/yosys.h"
 #include "backends/rtlil/rtlil_backend.h"
 
+#ifndef _WIN32
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+extern char **environ;
+#endif
+
 USING_YOSYS_NAMESPACE
 using namespace RTLIL_BACKEND;
 PRIVATE_NAMESPACE_BEGIN
@@ -36,8 +43,10 @@ struct BugpointPass : public Pass {
 		log("given script into a smaller testcase. It does this by removing an arbitrary part\n");
 		log("of the design and recursively invokes a new Yosys process with this modified\n");
 		log("design and the same script, repeating these steps while it can find a smaller\n");
-		log("design that still causes a crash. Once this command finishes, it replaces the\n");
-		log("current design with the smallest testcase it was able to produce.\n");
+		log("design that still causes a crash. The number of parts removed at once starts\n");
+		log("at one, is doubled whenever the testcase still crashes, and is halved whenever\n");
+		log("it does not. Once this command finishes, it replaces the current design with\n");
+		log("the smallest testcase it was able to produce.\n");
 		log("In order to save the reduced testcase you must write this out to a file with\n");
 		log("another command after `bugpoint` like `write_rtlil` or `write_verilog`.\n");
 		log("\n");
@@ -47,6 +56,11 @@ struct BugpointPass : public Pass {
 		log("    -yosys <filename>\n");
 		log("        use this Yosys binary. if not specified, `yosys` is used.\n");
 		log("\n");
+		log("    -j <N>\n");
+		log("        check up to N testcases at once, each in a separate Yosys process that\n");
+		log("        uses its own bugpoint-case.<n>.il and bugpoint-case.<n>.log files.\n");
+		log("        default: 1\n");
+		log("\n");
 		log("    -grep \"<string>\"\n");
 		log("        only consider crashes that place this string in the log file.\n");
 		log("\n");
@@ -94,19 +108,27 @@ struct BugpointPass : public Pass {
 		log("\n");
 	}
 
-	bool run_yosys(RTLIL::Design *design, string runner, string yosys_cmd, string yosys_arg)
+	void write_testcase(RTLIL::Design *design, string case_name)
 	{
 		design->sort();
 
-		std::ofstream f("bugpoint-case.il");
+		std::ofstream f(case_name + ".il");
 		RTLIL_BACKEND::dump_design(f, design, /*only_selected=*/false, /*flag_m=*/true, /*flag_n=*/false);
 		f.close();
+	}
+
+	string testcase_cmdline(string case_name, string runner, string yosys_cmd, string yosys_arg)
+	{
+		return stringf("%s %s -qq -L %s.log %s %s.il", runner.c_str(), yosys_cmd.c_str(), case_name.c_str(), yosys_arg.c_str(), case_name.c_str());
+	}
 
-		string yosys_cmdline = stringf("%s %s -qq -L bugpoint-case.log %s bugpoint-case.il", runner.c_str(), yosys_cmd.c_str(), yosys_arg.c_str());
-		return run_command(yosys_cmdline) == 0;
+	bool run_yosys(RTLIL::Design *design, string runner, string yosys_cmd, string yosys_arg, string case_name = "bugpoint-case")
+	{
+		write_testcase(design, case_name);
+		return run_command(testcase_cmdline(case_name, runner, yosys_cmd, yosys_arg)) == 0;
 	}
 
-	bool check_logfile(string grep)
+	bool check_logfile(string grep, string case_name = "bugpoint-case")
 	{
 		if (grep.empty())
 			return true;
@@ -114,7 +136,7 @@ struct BugpointPass : public Pass {
 		if (grep.size() > 2 && grep.front() == '"' && grep.back() == '"')
 			grep = grep.substr(1, grep.size() - 2);
 
-		std::ifstream f("bugpoint-case.log");
+		std::ifstream f(case_name + ".log");
 		while (!f.eof())
 		{
 			string line;
@@ -125,6 +147,64 @@ struct BugpointPass : public Pass {
 		return false;
 	}
 
+	// The numbered files of a batch of testcases are only needed until the batch has been checked.
+	void remove_testcases(const vector<string> &case_names)
+	{
+		for (auto &case_name : case_names) {
+			remove((case_name + ".il").c_str());
+			remove((case_name + ".log").c_str());
+		}
+	}
+
+	// Returns for each testcase whether it still crashes Yosys (and places the grep string in the log file). When there is more
+	// than one testcase, each is written to its own bugpoint-case.<n>.il file and all of them are checked at once.
+	vector<bool> check_testcases(const vector<RTLIL::Design*> &testcases, string runner, string yosys_cmd, string yosys_arg, string grep)
+	{
+		vector<string> case_names;
+		for (int i = 0; i < GetSize(testcases); i++)
+			case_names.push_back(GetSize(testcases) == 1 ? "bugpoint-case" : stringf("bugpoint-case.%d", i));
+
+		vector<bool> crashes;
+#ifndef _WIN32
+		if (GetSize(testcases) > 1)
+		{
+			vector<pid_t> pids;
+			for (int i = 0; i < GetSize(testcases); i++)
+			{
+				write_testcase(testcases[i], case_names[i]);
+				string cmdline = testcase_cmdline(case_names[i], runner, yosys_cmd, yosys_arg);
+				const char *argv[] = {"sh", "-c", cmdline.c_str(), nullptr};
+				pid_t pid;
+				int err = posix_spawn(&pid, "/bin/sh", /*file_actions=*/nullptr, /*attrp=*/nullptr, const_cast<char **>(argv), environ);
+				if (err != 0) {
+					for (auto running : pids) {
+						kill(running, SIGKILL);
+						waitpid(running, nullptr, 0);
+					}
+					remove_testcases(case_names);
+					log_error("posix_spawn failed: %s\n", strerror(err));
+				}
+				pids.push_back(pid);
+			}
+			for (int i = 0; i < GetSize(testcases); i++)
+			{
+				int status;
+				if (waitpid(pids[i], &status, 0) < 0)
+					log_error("waitpid failed: %s\n", strerror(errno));
+				bool succeeded = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+				crashes.push_back(!succeeded && check_logfile(grep, case_names[i]));
+			}
+			remove_testcases(case_names);
+			return crashes;
+		}
+#endif
+		for (int i = 0; i < GetSize(testcases); i++)
+			crashes.push_back(!run_yosys(testcases[i], runner, yosys_cmd, yosys_arg, case_names[i]) && check_logfile(grep, case_names[i]));
+		if (GetSize(testcases) > 1)
+			remove_testcases(case_names);
+		return crashes;
+	}
+
 	RTLIL::Design *clean_design(RTLIL::Design *design, bool do_clean = true, bool do_delete = false)
 	{
 		if (!do_clean)
@@ -141,16 +221,35 @@ struct BugpointPass : public Pass {
 		return design_copy;
 	}
 
-	RTLIL::Design *simplify_something(RTLIL::Design *design, int &seed, bool stage2, bool modules, bool ports, bool cells, bool connections, bool processes, bool assigns, bool updates, bool wires)
+	RTLIL::Design *simplify_something(RTLIL::Design *design, int seed, int count, int &num_parts, bool stage2, bool modules, bool ports, bool cells, bool connections, bool processes, bool assigns, bool updates, bool wires)
 	{
 		RTLIL::Design *design_copy = new RTLIL::Design;
 		for (auto module : design->modules())
 			design_copy->add(module->clone());
 
-		int index = 0;
+		// Parts of the design that may be removed are numbered in a fixed order, and the parts numbered from `seed` to
+		// `seed + count - 1` are removed. All of them are collected before any is removed, so that the numbering is the same
+		// no matter how many parts are removed at once.
+		int index = 0, picked = 0;
+		auto pick = [&]() {
+			int part = index++;
+			if (part < seed || part >= seed + count)
+				return false;
+			picked++;
+			return true;
+		};
+
+		vector<RTLIL::Module*> removed_modules;
+		vector<RTLIL::Wire*> removed_ports;
+		vector<RTLIL::Cell*> removed_cells;
+		vector<pair<RTLIL::Cell*, RTLIL::IdString>> removed_connections, exposed_connections;
+		vector<RTLIL::Process*> removed_processes;
+		vector<pair<RTLIL::CaseRule*, int>> removed_assigns;
+		vector<pair<RTLIL::SyncRule*, int>> removed_updates, removed_memwrs;
+		dict<RTLIL::Module*, pool<RTLIL::Wire*>> removed_wires;
+
 		if (modules)
 		{
-			Module *removed_module = nullptr;
 			for (auto module : design_copy->modules())
 			{
 				if (module->get_blackbox_attribute())
@@ -159,17 +258,13 @@ struct BugpointPass : public Pass {
 				if (module->get_bool_attribute(ID::bugpoint_keep))
 				    continue;
 
-				if (index++ == seed)
+				if (pick())
 				{
-					log_header(design, "Trying to remove module %s.\n", log_id(module));
-					removed_module = module;
-					break;
+					if (count == 1)
+						log_header(design, "Trying to remove module %s.\n", log_id(module));
+					removed_modules.push_back(module);
 				}
 			}
-			if (removed_module) {
-				design_copy->remove(removed_module);
-				return design_copy;
-			}
 		}
 		if (ports)
 		{
@@ -189,12 +284,11 @@ struct BugpointPass : public Pass {
 					if (wire->get_bool_attribute(ID::bugpoint_keep))
 						continue;
 
-					if (index++ == seed)
+					if (pick())
 					{
-						log_header(design, "Trying to remove module port %s.\n", log_id(wire));
-						wire->port_input = wire->port_output = false;
-						mod->fixup_ports();
-						return design_copy;
+						if (count == 1)
+							log_header(design, "Trying to remove module port %s.\n", log_id(wire));
+						removed_ports.push_back(wire);
 					}
 				}
 			}
@@ -206,23 +300,18 @@ struct BugpointPass : public Pass {
 				if (mod->get_blackbox_attribute())
 					continue;
 
-				Cell *removed_cell = nullptr;
 				for (auto cell : mod->cells())
 				{
 					if (cell->get_bool_attribute(ID::bugpoint_keep))
 						continue;
 
-					if (index++ == seed)
+					if (pick())
 					{
-						log_header(design, "Trying to remove cell %s.%s.\n", log_id(mod), log_id(cell));
-						removed_cell = cell;
-						break;
+						if (count == 1)
+							log_header(design, "Trying to remove cell %s.%s.\n", log_id(mod), log_id(cell));
+						removed_cells.push_back(cell);
 					}
 				}
-				if (removed_cell) {
-					mod->remove(removed_cell);
-					return design_copy;
-				}
 			}
 		}
 		if (connections)
@@ -243,26 +332,19 @@ struct BugpointPass : public Pass {
 						if(is_undef || (!stage2 && is_port))
 							continue;
 
-						if (index++ == seed)
+						bool removed = pick();
+						if (removed)
 						{
-							log_header(design, "Trying to remove cell port %s.%s.%s.\n", log_id(mod), log_id(cell), log_id(it.first));
-							RTLIL::SigSpec port_x(State::Sx, port.size());
-							cell->unsetPort(it.first);
-							cell->setPort(it.first, port_x);
-							return design_copy;
+							if (count == 1)
+								log_header(design, "Trying to remove cell port %s.%s.%s.\n", log_id(mod), log_id(cell), log_id(it.first));
+							removed_connections.push_back({cell, it.first});
 						}
 
-						if (!stage2 && (cell->input(it.first) || cell->output(it.first)) && index++ == seed)
+						if (!stage2 && (cell->input(it.first) || cell->output(it.first)) && pick() && !removed)
 						{
-							log_header(design, "Trying to expose cell port %s.%s.%s as module port.\n", log_id(mod), log_id(cell), log_id(it.first));
-							RTLIL::Wire *wire = mod->addWire(NEW_ID, port.size());
-							wire->set_bool_attribute(ID($bugpoint));
-							wire->port_input = cell->input(it.first);
-							wire->port_output = cell->output(it.first);
-							cell->unsetPort(it.first);
-							cell->setPort(it.first, wire);
-							mod->fixup_ports();
-							return design_copy;
+							if (count == 1)
+								log_header(design, "Trying to expose cell port %s.%s.%s as module port.\n", log_id(mod), log_id(cell), log_id(it.first));
+							exposed_connections.push_back({cell, it.first});
 						}
 					}
 				}
@@ -275,23 +357,18 @@ struct BugpointPass : public Pass {
 				if (mod->get_blackbox_attribute())
 					continue;
 
-				RTLIL::Process *removed_process = nullptr;
 				for (auto process : mod->processes)
 				{
 					if (process.second->get_bool_attribute(ID::bugpoint_keep))
 						continue;
 
-					if (index++ == seed)
+					if (pick())
 					{
-						log_header(design, "Trying to remove process %s.%s.\n", log_id(mod), log_id(process.first));
-						removed_process = process.second;
-						break;
+						if (count == 1)
+							log_header(design, "Trying to remove process %s.%s.\n", log_id(mod), log_id(process.first));
+						removed_processes.push_back(process.second);
 					}
 				}
-				if (removed_process) {
-					mod->remove(removed_process);
-					return design_copy;
-				}
 			}
 		}
 		if (assigns)
@@ -308,13 +385,13 @@ struct BugpointPass : public Pass {
 					{
 						RTLIL::CaseRule *cs = cases[0];
 						cases.erase(cases.begin());
-						for (auto it = cs->actions.begin(); it != cs->actions.end(); ++it)
+						for (int i = 0; i < GetSize(cs->actions); i++)
 						{
-							if (index++ == seed)
+							if (pick())
 							{
-								log_header(design, "Trying to remove assign %s %s in %s.%s.\n", log_signal(it->first), log_signal(it->second), log_id(mod), log_id(pr.first));
-								cs->actions.erase(it);
-								return design_copy;
+								if (count == 1)
+									log_header(design, "Trying to remove assign %s %s in %s.%s.\n", log_signal(cs->actions[i].first), log_signal(cs->actions[i].second), log_id(mod), log_id(pr.first));
+								removed_assigns.push_back({cs, i});
 							}
 						}
 						for (auto &sw : cs->switches)
@@ -334,30 +411,23 @@ struct BugpointPass : public Pass {
 				{
 					for (auto &sy : pr.second->syncs)
 					{
-						for (auto it = sy->actions.begin(); it != sy->actions.end(); ++it)
+						for (int i = 0; i < GetSize(sy->actions); i++)
 						{
-							if (index++ == seed)
+							if (pick())
 							{
-								log_header(design, "Trying to remove sync %s update %s %s in %s.%s.\n", log_signal(sy->signal), log_signal(it->first), log_signal(it->second), log_id(mod), log_id(pr.first));
-								sy->actions.erase(it);
-								return design_copy;
+								if (count == 1)
+									log_header(design, "Trying to remove sync %s update %s %s in %s.%s.\n", log_signal(sy->signal), log_signal(sy->actions[i].first), log_signal(sy->actions[i].second), log_id(mod), log_id(pr.first));
+								removed_updates.push_back({sy, i});
 							}
 						}
-						int i = 0;
-						for (auto it = sy->mem_write_actions.begin(); it != sy->mem_write_actions.end(); ++it, ++i)
+						for (int i = 0; i < GetSize(sy->mem_write_actions); i++)
 						{
-							if (index++ == seed)
+							if (pick())
 							{
-								log_header(design, "Trying to remove sync %s memwr %s %s %s %s in %s.%s.\n", log_signal(sy->signal), log_id(it->memid), log_signal(it->address), log_signal(it->data), log_signal(it->enable), log_id(mod), log_id(pr.first));
-								sy->mem_write_actions.erase(it);
-								// Remove the bit for removed action from other actions' priority masks.
-								for (auto it2 = sy->mem_write_actions.begin(); it2 != sy->mem_write_actions.end(); ++it2) {
-									auto &mask = it2->priority_mask;
-									if (GetSize(mask) > i) {
-										mask.bits().erase(mask.bits().begin() + i);
-									}
-								}
-								return design_copy;
+								auto &memwr = sy->mem_write_actions[i];
+								if (count == 1)
+									log_header(design, "Trying to remove sync %s memwr %s %s %s %s in %s.%s.\n", log_signal(sy->signal), log_id(memwr.memid), log_signal(memwr.address), log_signal(memwr.data), log_signal(memwr.enable), log_id(mod), log_id(pr.first));
+								removed_memwrs.push_back({sy, i});
 							}
 						}
 					}
@@ -371,7 +441,6 @@ struct BugpointPass : public Pass {
 				if (mod->get_blackbox_attribute())
 					continue;
 
-				Wire *removed_wire = nullptr;
 				for (auto wire : mod->wires())
 				{
 					if (wire->get_bool_attribute(ID::bugpoint_keep))
@@ -380,26 +449,84 @@ struct BugpointPass : public Pass {
 					if (wire->name.begins_with("$delete_wire") || wire->name.begins_with("$auto$bugpoint"))
 						continue;
 
-					if (index++ == seed)
+					if (pick())
 					{
-						log_header(design, "Trying to remove wire %s.%s.\n", log_id(mod), log_id(wire));
-						removed_wire = wire;
-						break;
+						if (count == 1)
+							log_header(design, "Trying to remove wire %s.%s.\n", log_id(mod), log_id(wire));
+						removed_wires[mod].insert(wire);
 					}
 				}
-				if (removed_wire) {
-					mod->remove({removed_wire});
-					return design_copy;
+			}
+		}
+
+		num_parts = index;
+		if (picked == 0)
+		{
+			delete design_copy;
+			return nullptr;
+		}
+		if (count != 1)
+			log_header(design, "Trying to remove %d parts of the design, starting with part %d of %d.\n", picked, seed, num_parts);
+
+		// Parts that contain other parts are removed last, so that nothing is modified after it has been removed.
+		for (auto it : removed_connections)
+		{
+			RTLIL::Cell *cell = it.first;
+			RTLIL::SigSpec port_x(State::Sx, cell->getPort(it.second).size());
+			cell->unsetPort(it.second);
+			cell->setPort(it.second, port_x);
+		}
+		for (auto it : exposed_connections)
+		{
+			RTLIL::Cell *cell = it.first;
+			RTLIL::Module *mod = cell->module;
+			RTLIL::Wire *wire = mod->addWire(NEW_ID, cell->getPort(it.second).size());
+			wire->set_bool_attribute(ID($bugpoint));
+			wire->port_input = cell->input(it.second);
+			wire->port_output = cell->output(it.second);
+			cell->unsetPort(it.second);
+			cell->setPort(it.second, wire);
+			mod->fixup_ports();
+		}
+		for (auto wire : removed_ports)
+		{
+			wire->port_input = wire->port_output = false;
+			wire->module->fixup_ports();
+		}
+		// Actions are removed back to front, so that the indices of the remaining ones stay valid.
+		for (auto it = removed_assigns.rbegin(); it != removed_assigns.rend(); ++it)
+			it->first->actions.erase(it->first->actions.begin() + it->second);
+		for (auto it = removed_updates.rbegin(); it != removed_updates.rend(); ++it)
+			it->first->actions.erase(it->first->actions.begin() + it->second);
+		for (auto it = removed_memwrs.rbegin(); it != removed_memwrs.rend(); ++it)
+		{
+			auto &memwrs = it->first->mem_write_actions;
+			int i = it->second;
+			memwrs.erase(memwrs.begin() + i);
+			// Remove the bit for removed action from other actions' priority masks.
+			for (auto it2 = memwrs.begin(); it2 != memwrs.end(); ++it2) {
+				auto &mask = it2->priority_mask;
+				if (GetSize(mask) > i) {
+					mask.bits().erase(mask.bits().begin() + i);
 				}
 			}
 		}
-		delete design_copy;
-		return nullptr;
+		for (auto cell : removed_cells)
+			cell->module->remove(cell);
+		for (auto process : removed_processes)
+			process->module->remove(process);
+		for (auto &it : removed_wires)
+			it.first->remove(it.second);
+		for (auto module : removed_modules)
+			design_copy->remove(module);
+
+		return design_copy;
 	}
 
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		string yosys_cmd = "yosys", yosys_arg, grep, runner;
+		int jobs = 1;
 		bool fast = false, clean = false;
 		bool modules = false, ports = false, cells = false, connections = false, processes = false, assigns = false, updates = false, wires = false, has_part = false;
 
@@ -429,6 +556,12 @@ struct BugpointPass : public Pass {
 				grep = args[++argidx];
 				continue;
 			}
+			if (args[argidx] == "-j" && argidx + 1 < args.size()) {
+				jobs = atoi(args[++argidx].c_str());
+				if (jobs < 1)
+					log_cmd_error("The -j option requires a positive number of jobs!\n");
+				continue;
+			}
 			if (args[argidx] == "-fast") {
 				fast = true;
 				continue;
@@ -513,44 +646,80 @@ struct BugpointPass : public Pass {
 		if (!check_logfile(grep))
 			log_cmd_error("The provided grep string is not found in the log file!\n");
 
-		int seed = 0;
+		// Parts of the design are removed in chunks, and each of up to `jobs` testcases removes the chunk following the one removed
+		// by the previous testcase. The chunk size is doubled whenever a testcase still crashes, and halved whenever none of them
+		// do, so that large designs are cut down quickly, but every part is eventually tried on its own.
+		int seed = 0, chunk = 1, num_parts = 0;
 		bool found_something = false, stage2 = false;
 		while (true)
 		{
-			if (RTLIL::Design *simplified = simplify_something(crashing_design, seed, stage2, modules, ports, cells, connections, processes, assigns, updates, wires))
+			vector<RTLIL::Design*> simplified_designs;
+			for (int job = 0; job < jobs; job++)
 			{
-				simplified = clean_design(simplified, fast, /*do_delete=*/true);
+				RTLIL::Design *simplified = simplify_something(crashing_design, seed + job * chunk, chunk, num_parts, stage2, modules, ports, cells, connections, processes, assigns, updates, wires);
+				if (simplified == nullptr)
+					break;
+				simplified_designs.push_back(clean_design(simplified, fast, /*do_delete=*/true));
+			}
 
-				bool crashes;
+			if (!simplified_designs.empty())
+			{
+				vector<bool> crashes;
 				if (clean)
 				{
-					RTLIL::Design *testcase = clean_design(simplified);
-					crashes = !run_yosys(testcase, runner, yosys_cmd, yosys_arg);
-					delete testcase;
+					vector<RTLIL::Design*> testcases;
+					for (auto simplified : simplified_designs)
+						testcases.push_back(clean_design(simplified));
+					crashes = check_testcases(testcases, runner, yosys_cmd, yosys_arg, grep);
+					for (auto testcase : testcases)
+						delete testcase;
 				}
 				else
 				{
-					crashes = !run_yosys(simplified, runner, yosys_cmd, yosys_arg);
+					crashes = check_testcases(simplified_designs, runner, yosys_cmd, yosys_arg, grep);
 				}
 
-				if (crashes && check_logfile(grep))
+				int crashing_index = -1;
+				for (int i = 0; i < GetSize(crashes) && crashing_index == -1; i++)
+					if (crashes[i])
+						crashing_index = i;
+
+				if (crashing_index != -1)
 				{
-					log("Testcase crashes.\n");
+					if (GetSize(simplified_designs) == 1)
+						log("Testcase crashes.\n");
+					else
+						log("Testcase %d of %d crashes.\n", crashing_index + 1, GetSize(simplified_designs));
 					if (crashing_design != design)
 						delete crashing_design;
-					crashing_design = simplified;
+					crashing_design = simplified_designs[crashing_index];
+					simplified_designs.erase(simplified_designs.begin() + crashing_index);
 					found_something = true;
+					// the testcases before the crashing one did not crash, skip
+					// them as if they had been tried one after the other
+					if (chunk == 1)
+						seed += crashing_index;
+					chunk = max(1, min(2 * chunk, num_parts / jobs));
 				}
 				else
 				{
-					log("Testcase does not crash.\n");
-					delete simplified;
-					seed++;
+					if (GetSize(simplified_designs) == 1)
+						log("Testcase does not crash.\n");
+					else
+						log("None of %d testcases crash.\n", GetSize(simplified_designs));
+					if (chunk > 1)
+						chunk /= 2;
+					else
+						seed += GetSize(simplified_designs);
 				}
+
+				for (auto simplified : simplified_designs)
+					delete simplified;
 			}
 			else
 			{
 				seed = 0;
+				chunk = 1;
 				if (found_something)
 					found_something = false;
 				else
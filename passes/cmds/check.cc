@@ -113,7 +113,7 @@ struct CheckPass : public Pass {
 		{
 			log("Checking module %s...\n", log_id(module));
 
-			SigMap sigmap(module);
+			const SigMap &sigmap = module->sigmap();
 			dict<SigBit, vector<string>> wire_drivers;
 			dict<SigBit, Cell *> driver_cells;
 			dict<SigBit, int> wire_drivers_count;
@@ -165,10 +165,10 @@ struct CheckPass : public Pass {
 
 			struct CircuitEdgesDatabase : AbstractCellEdgesDatabase {
 				TopoSort<std::pair<RTLIL::IdString, int>> &topo;
-				SigMap sigmap;
+				const SigMap &sigmap;
 				bool force_detail;
 
-				CircuitEdgesDatabase(TopoSort<std::pair<RTLIL::IdString, int>> &topo, SigMap &sigmap, bool force_detail)
+				CircuitEdgesDatabase(TopoSort<std::pair<RTLIL::IdString, int>> &topo, const SigMap &sigmap, bool force_detail)
 					: topo(topo), sigmap(sigmap), force_detail(force_detail) {}
 
 				void add_edge(RTLIL::Cell *cell, RTLIL::IdString from_port, int from_bit,
@@ -351,12 +351,12 @@ struct CheckPass : public Pass {
 
 					struct MatchingEdgePrinter : AbstractCellEdgesDatabase {
 						std::string &message;
-						SigMap &sigmap;
+						const SigMap &sigmap;
 						SigBit from, to;
 						int nhits;
 						const int HITS_LIMIT = 3;
 
-						MatchingEdgePrinter(std::string &message, SigMap &sigmap, SigBit from, SigBit to)
+						MatchingEdgePrinter(std::string &message, const SigMap &sigmap, SigBit from, SigBit to)
 							: message(message), sigmap(sigmap), from(from), to(to), nhits(0) {}
 
 						void add_edge(RTLIL::Cell *cell, RTLIL::IdString from_port, int from_bit,
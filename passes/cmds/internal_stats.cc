@@ -25,49 +25,189 @@
 #include "kernel/celltypes.h"
 #include "passes/techmap/libparse.h"
 #include "kernel/cost.h"
+#include "kernel/trace.h"
 #include "frontends/ast/ast.h"
 #include "libs/json11/json11.hpp"
 
-#if defined(__APPLE__) && defined(__MACH__)
-#include <mach/task.h>
-#include <mach/mach_init.h>
-#endif
-
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
 
-std::optional<uint64_t> current_mem_bytes() {
-
-#if defined(__APPLE__)
-    task_basic_info_64_data_t basicInfo;
-    mach_msg_type_number_t count = TASK_BASIC_INFO_64_COUNT;
-    kern_return_t error = task_info(mach_task_self(), TASK_BASIC_INFO_64, (task_info_t)&basicInfo, &count);
-    if (error != KERN_SUCCESS) {
-        return {}; // Error getting task information
-    }
-    return basicInfo.resident_size; // Return RSS in KB
-
-#elif defined(__linux__)
-	// Not all linux distributions have to have this file
-    std::ifstream statusFile("/proc/self/status");
-    std::string line;
-    while (std::getline(statusFile, line)) {
-        if (line.find("VmRSS:") == 0) {
-            std::istringstream iss(line);
-            std::string token;
-			// Skip prefix
-            iss >> token;
-            uint64_t rss;
-            iss >> rss;
-            return rss * 1024;
-        }
-    }
-	// Error reading /proc/self/status
-    return {};
-
-#else
-	return {};
+struct MemStat
+{
+	uint64_t count = 0, bytes = 0;
+
+	void add(uint64_t n, uint64_t b) {
+		count += n;
+		bytes += b;
+	}
+
+	MemStat &operator+=(const MemStat &other) {
+		add(other.count, other.bytes);
+		return *this;
+	}
+
+	json11::Json json() const {
+		return json11::Json::object { { "count", (double)count }, { "bytes", (double)bytes } };
+	}
+};
+
+// Estimated memory of the RTLIL objects of a module: sizeof() of every object
+// plus the heap memory of its containers, SigSpecs and constants. IdStrings are
+// shared between all users and are only counted in the global IdString table.
+struct ModuleMemStats
+{
+	MemStat module, wires, cells, cell_ports, cell_params, connections, memories, processes, attributes, src;
+
+	std::vector<std::pair<const char*, const MemStat*>> categories() const {
+		return {
+			{ "module", &module },
+			{ "wires", &wires },
+			{ "cells", &cells },
+			{ "cell_ports", &cell_ports },
+			{ "cell_params", &cell_params },
+			{ "connections", &connections },
+			{ "memories", &memories },
+			{ "processes", &processes },
+			{ "attributes", &attributes },
+			{ "src", &src },
+		};
+	}
+
+	uint64_t total_bytes() const {
+		uint64_t bytes = 0;
+		for (auto &it : categories())
+			bytes += it.second->bytes;
+		return bytes;
+	}
+
+	ModuleMemStats &operator+=(const ModuleMemStats &other) {
+		module += other.module;
+		wires += other.wires;
+		cells += other.cells;
+		cell_ports += other.cell_ports;
+		cell_params += other.cell_params;
+		connections += other.connections;
+		memories += other.memories;
+		processes += other.processes;
+		attributes += other.attributes;
+		src += other.src;
+		return *this;
+	}
+
+	static uint64_t sigsig_bytes(const RTLIL::SigSig &sigsig) {
+		return sigsig.first.alloc_bytes() + sigsig.second.alloc_bytes();
+	}
+
+	// The `src' attribute is listed separately as it often dominates the attribute memory.
+	void add_attributes(const RTLIL::AttrObject *obj) {
+		attributes.add(0, obj->attributes.alloc_bytes());
+		for (auto &it : obj->attributes) {
+			if (it.first == ID::src)
+				src.add(1, it.second.alloc_bytes());
+			else
+				attributes.add(1, it.second.alloc_bytes());
+		}
+	}
+
+	void add_case(const RTLIL::CaseRule *cs) {
+		add_attributes(cs);
+		processes.add(0, cs->compare.capacity() * sizeof(RTLIL::SigSpec) + cs->actions.capacity() * sizeof(RTLIL::SigSig) +
+				cs->switches.capacity() * sizeof(RTLIL::SwitchRule*));
+		for (auto &sig : cs->compare)
+			processes.add(0, sig.alloc_bytes());
+		for (auto &action : cs->actions)
+			processes.add(0, sigsig_bytes(action));
+		for (auto sw : cs->switches) {
+			add_attributes(sw);
+			processes.add(0, sizeof(RTLIL::SwitchRule) + sw->signal.alloc_bytes() + sw->cases.capacity() * sizeof(RTLIL::CaseRule*));
+			for (auto child : sw->cases) {
+				processes.add(0, sizeof(RTLIL::CaseRule));
+				add_case(child);
+			}
+		}
+	}
+
+	void add_process(const RTLIL::Process *proc) {
+		add_attributes(proc);
+		processes.add(1, sizeof(RTLIL::Process) + proc->syncs.capacity() * sizeof(RTLIL::SyncRule*));
+		add_case(&proc->root_case);
+		for (auto sync : proc->syncs) {
+			processes.add(0, sizeof(RTLIL::SyncRule) + sync->signal.alloc_bytes() + sync->actions.capacity() * sizeof(RTLIL::SigSig) +
+					sync->mem_write_actions.capacity() * sizeof(RTLIL::MemWriteAction));
+			for (auto &action : sync->actions)
+				processes.add(0, sigsig_bytes(action));
+			for (auto &action : sync->mem_write_actions) {
+				add_attributes(&action);
+				processes.add(0, action.address.alloc_bytes() + action.data.alloc_bytes() + action.enable.alloc_bytes() +
+						action.priority_mask.alloc_bytes());
+			}
+		}
+	}
+
+	void add_module(const RTLIL::Module *mod) {
+		add_attributes(mod);
+		module.add(1, sizeof(RTLIL::Module) + mod->wires_.alloc_bytes() + mod->cells_.alloc_bytes() +
+				mod->memories.alloc_bytes() + mod->processes.alloc_bytes() + mod->ports.capacity() * sizeof(RTLIL::IdString) +
+				mod->parameter_default_values.alloc_bytes());
+		for (auto &it : mod->parameter_default_values)
+			module.add(0, it.second.alloc_bytes());
+
+		for (auto &it : mod->wires_) {
+			add_attributes(it.second);
+			wires.add(1, sizeof(RTLIL::Wire));
+		}
+
+		for (auto &it : mod->cells_) {
+			auto cell = it.second;
+			add_attributes(cell);
+			cells.add(1, sizeof(RTLIL::Cell));
+			cell_ports.add(0, cell->connections_.alloc_bytes());
+			for (auto &conn : cell->connections_)
+				cell_ports.add(1, conn.second.alloc_bytes());
+			cell_params.add(0, cell->parameters.alloc_bytes());
+			for (auto &param : cell->parameters)
+				cell_params.add(1, param.second.alloc_bytes());
+		}
+
+		connections.add(0, mod->connections_.capacity() * sizeof(RTLIL::SigSig));
+		for (auto &conn : mod->connections_)
+			connections.add(1, sigsig_bytes(conn));
+
+		for (auto &it : mod->memories) {
+			add_attributes(it.second);
+			memories.add(1, sizeof(RTLIL::Memory));
+		}
+
+		for (auto &it : mod->processes)
+			add_process(it.second);
+	}
+};
+
+MemStat idstring_mem_stats()
+{
+	MemStat stat;
+	for (auto str : RTLIL::IdString::global_id_storage_)
+		if (str != nullptr)
+			stat.add(1, strlen(str) + 1);
+	stat.add(0, RTLIL::IdString::global_id_storage_.capacity() * sizeof(char*) + RTLIL::IdString::global_id_index_.alloc_bytes());
+#ifndef YOSYS_NO_IDS_REFCNT
+	stat.add(0, RTLIL::IdString::global_refcount_storage_.capacity() * sizeof(int) +
+			RTLIL::IdString::global_free_idx_list_.capacity() * sizeof(int));
 #endif
+	return stat;
+}
+
+uint64_t design_mem_bytes(RTLIL::Design *design)
+{
+	ModuleMemStats stats;
+	for (auto mod : design->modules())
+		stats.add_module(mod);
+	return stats.total_bytes();
+}
+
+std::string format_bytes(uint64_t bytes)
+{
+	return stringf("%.2f MB", bytes / (1024.0 * 1024.0));
 }
 
 struct InternalStatsPass : public Pass {
@@ -75,7 +215,20 @@ struct InternalStatsPass : public Pass {
 	void help() override
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
-		log("Print internal statistics for developers (experimental)\n");
+		log("\n");
+		log("    internal_stats [options] [selection]\n");
+		log("\n");
+		log("Print internal statistics for developers (experimental).\n");
+		log("\n");
+		log("This reports the resident memory of the process and an estimate of the memory\n");
+		log("used by the RTLIL objects of the selected modules, broken down by category and\n");
+		log("by module, as well as the memory of the IdString table, AST nodes and designs\n");
+		log("saved with 'design -save'. The estimate includes the heap memory owned by the\n");
+		log("objects (SigSpecs, constants, containers), but not allocator overhead.\n");
+		log("\n");
+		log("    -json\n");
+		log("        print the statistics as JSON, e.g. for sampling between passes\n");
+		log("\n");
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
@@ -97,26 +250,92 @@ struct InternalStatsPass : public Pass {
 
 		log_experimental("internal_stats");
 
+		auto mem = current_mem_bytes();
+		auto ast_bytes = AST::astnode_count() * (unsigned long long) sizeof(AST::AstNode);
+		MemStat idstrings = idstring_mem_stats();
+
+		ModuleMemStats total;
+		std::vector<std::pair<RTLIL::Module*, ModuleMemStats>> module_stats;
+		for (auto mod : design->selected_modules()) {
+			module_stats.emplace_back(mod, ModuleMemStats());
+			module_stats.back().second.add_module(mod);
+			total += module_stats.back().second;
+		}
+		std::sort(module_stats.begin(), module_stats.end(), [](const std::pair<RTLIL::Module*, ModuleMemStats> &a,
+				const std::pair<RTLIL::Module*, ModuleMemStats> &b) {
+			return a.second.total_bytes() > b.second.total_bytes();
+		});
+
+		std::vector<std::pair<std::string, uint64_t>> saved_stats;
+		for (auto &it : saved_designs)
+			saved_stats.emplace_back(it.first, design_mem_bytes(it.second));
+
 		if (json_mode) {
 			log("{\n");
 			log("   \"creator\": %s,\n", json11::Json(yosys_maybe_version()).dump().c_str());
 			std::stringstream invocation;
 			std::copy(args.begin(), args.end(), std::ostream_iterator<std::string>(invocation, " "));
 			log("   \"invocation\": %s,\n", json11::Json(invocation.str()).dump().c_str());
-			if (auto mem = current_mem_bytes()) {
+			if (mem) {
 				log("   \"memory_now\": %s,\n", std::to_string(*mem).c_str());
 			}
-			auto ast_bytes = AST::astnode_count() * (unsigned long long) sizeof(AST::AstNode);
 			log("   \"memory_ast\": %s,\n", std::to_string(ast_bytes).c_str());
-		}
+			log("   \"memory_idstrings\": %s,\n", idstrings.json().dump().c_str());
+			log("   \"memory_rtlil\": %s,\n", std::to_string(total.total_bytes()).c_str());
 
-		// stats go here
+			json11::Json::object categories;
+			for (auto &it : total.categories())
+				categories[it.first] = it.second->json();
+			log("   \"memory_categories\": %s,\n", json11::Json(categories).dump().c_str());
 
-		if (json_mode) {
-			log("\n");
+			log("   \"memory_modules\": {");
+			bool first = true;
+			for (auto &it : module_stats) {
+				json11::Json::object module;
+				module["bytes"] = (double)it.second.total_bytes();
+				for (auto &cat : it.second.categories())
+					module[cat.first] = cat.second->json();
+				log("%s\n      %s: %s", first ? "" : ",", json11::Json(log_id(it.first)).dump().c_str(), json11::Json(module).dump().c_str());
+				first = false;
+			}
+			log("\n   },\n");
+
+			json11::Json::object saved;
+			for (auto &it : saved_stats)
+				saved[it.first] = (double)it.second;
+			log("   \"memory_saved_designs\": %s\n", json11::Json(saved).dump().c_str());
 			log("}\n");
-		}
+		} else {
+			if (mem)
+				log("Resident memory:   %s\n", format_bytes(*mem).c_str());
+			log("AST nodes:         %s (%llu nodes)\n", format_bytes(ast_bytes).c_str(), (unsigned long long) AST::astnode_count());
+			log("IdString table:    %s (%llu strings)\n", format_bytes(idstrings.bytes).c_str(), (unsigned long long) idstrings.count);
+			log("RTLIL objects:     %s (%d modules)\n", format_bytes(total.total_bytes()).c_str(), GetSize(module_stats));
+
+			log("\n");
+			log("   %-14s %12s %14s\n", "category", "count", "memory");
+			for (auto &it : total.categories())
+				log("   %-14s %12llu %14s\n", it.first, (unsigned long long) it.second->count, format_bytes(it.second->bytes).c_str());
 
+			if (!module_stats.empty()) {
+				log("\n");
+				log("   %14s %14s %14s %14s  %s\n", "memory", "cells", "wires", "attributes", "module");
+				for (auto &it : module_stats) {
+					auto &stats = it.second;
+					log("   %14s %14s %14s %14s  %s\n", format_bytes(stats.total_bytes()).c_str(),
+							format_bytes(stats.cells.bytes + stats.cell_ports.bytes + stats.cell_params.bytes).c_str(),
+							format_bytes(stats.wires.bytes).c_str(), format_bytes(stats.attributes.bytes + stats.src.bytes).c_str(),
+							log_id(it.first));
+				}
+			}
+
+			if (!saved_stats.empty()) {
+				log("\n");
+				log("   %14s  %s\n", "memory", "saved design");
+				for (auto &it : saved_stats)
+					log("   %14s  %s\n", format_bytes(it.second).c_str(), it.first.c_str());
+			}
+		}
 	}
 } InternalStatsPass;
 
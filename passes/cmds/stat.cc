@@ -89,8 +89,19 @@ struct statdata_t
 		STAT_NUMERIC_MEMBERS
 	#undef X
 
-		for (auto wire : mod->selected_wires())
+		// Cells are first counted per type in a hash table and only then
+		// merged into the sorted num_cells_by_type map, so that each cell costs
+		// a hash lookup rather than a chain of IdString string comparisons.
+		// Modules that are selected as a whole skip the per-member selection
+		// lookups entirely.
+		bool whole_module = design->selected_whole_module(mod);
+		dict<RTLIL::IdString, unsigned int> cell_type_count;
+
+		for (auto wire : mod->wires())
 		{
+			if (!whole_module && !design->selected(mod, wire))
+				continue;
+
 			if (wire->port_input || wire->port_output) {
 				num_ports++;
 				num_port_bits += wire->width;
@@ -112,8 +123,11 @@ struct statdata_t
 			num_memory_bits += it.second->width * it.second->size;
 		}
 
-		for (auto cell : mod->selected_cells())
+		for (auto cell : mod->cells())
 		{
+			if (!whole_module && !design->selected(mod, cell))
+				continue;
+
 			RTLIL::IdString cell_type = cell->type;
 
 			if (width_mode)
@@ -143,21 +157,26 @@ struct statdata_t
 					cell_type = stringf("%s_%d", cell_type.c_str(), GetSize(cell->getPort(ID::Q)));
 			}
 
+			num_cells++;
+			cell_type_count[cell_type]++;
+		}
+
+		for (auto &it : cell_type_count)
+		{
 			if (!cell_area.empty()) {
-				if (cell_area.count(cell_type)) {
-					cell_area_t cell_data = cell_area.at(cell_type);
+				if (cell_area.count(it.first)) {
+					cell_area_t cell_data = cell_area.at(it.first);
 					if (cell_data.is_sequential) {
-						sequential_area += cell_data.area;
+						sequential_area += cell_data.area * it.second;
 					}
-					area += cell_data.area;
+					area += cell_data.area * it.second;
 				}
 				else {
-					unknown_cell_area.insert(cell_type);
+					unknown_cell_area.insert(it.first);
 				}
 			}
 
-			num_cells++;
-			num_cells_by_type[cell_type]++;
+			num_cells_by_type[it.first] += it.second;
 		}
 
 		for (auto &it : mod->processes) {
@@ -102,6 +102,7 @@ struct TeePass : public Pass {
 			std::vector<std::string> new_args(args.begin() + argidx, args.end());
 			Pass::call(design, new_args);
 		} catch (...) {
+			log_flush();
 			for (auto cf : files_to_close)
 				fclose(cf);
 			log_files = backup_log_files;
@@ -110,6 +111,7 @@ struct TeePass : public Pass {
 			throw;
 		}
 
+		log_flush();
 		for (auto cf : files_to_close)
 			fclose(cf);
 
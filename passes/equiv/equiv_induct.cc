@@ -86,10 +86,60 @@ struct EquivInductWorker
 		ez_step_is_consistent[step] = ez->expression(ez->OpAnd, ez_equal_terms);
 	}
 
+	// Only cells in the transitive fan-in of the $equiv cells can influence the
+	// proof, so leave everything else out of the SAT model. Cells without a
+	// known type are kept, they are reported by create_timestep().
+	void restrict_to_cone()
+	{
+		dict<SigBit, Cell*> bit2driver;
+		pool<Cell*> cone;
+		vector<Cell*> queue;
+
+		for (auto cell : cells) {
+			if (!yosys_celltypes.cell_known(cell->type)) {
+				cone.insert(cell);
+				continue;
+			}
+			for (auto &conn : cell->connections())
+				if (yosys_celltypes.cell_output(cell->type, conn.first))
+					for (auto bit : sigmap(conn.second))
+						bit2driver[bit] = cell;
+			if (cell->type == ID($equiv) && sigmap(cell->getPort(ID::A)) != sigmap(cell->getPort(ID::B))) {
+				cone.insert(cell);
+				queue.push_back(cell);
+			}
+		}
+
+		while (!queue.empty()) {
+			Cell *cell = queue.back();
+			queue.pop_back();
+			for (auto &conn : cell->connections())
+				if (yosys_celltypes.cell_input(cell->type, conn.first))
+					for (auto bit : sigmap(conn.second)) {
+						auto it = bit2driver.find(bit);
+						if (it != bit2driver.end() && cone.insert(it->second).second)
+							queue.push_back(it->second);
+					}
+		}
+
+		if (GetSize(cone) == GetSize(cells))
+			return;
+
+		log("  Restricting SAT model to the %d of %d selected cells in the input cone of $equiv cells.\n", GetSize(cone), GetSize(cells));
+
+		vector<Cell*> cone_cells;
+		for (auto cell : cells)
+			if (cone.count(cell))
+				cone_cells.push_back(cell);
+		cells.swap(cone_cells);
+	}
+
 	void run()
 	{
 		log("Found %d unproven $equiv cells in module %s:\n", GetSize(workset), log_id(module));
 
+		restrict_to_cone();
+
 		if (satgen.model_undef) {
 			for (auto cell : cells)
 				if (yosys_celltypes.cell_known(cell->type))
@@ -117,17 +167,27 @@ struct EquivInductWorker
 			ez->assume(ez_step_is_consistent[step]);
 
 			log("  Proving existence of base case for step %d. (%d clauses over %d variables)\n", step, ez->numCnfClauses(), ez->numCnfVariables());
-			if (!ez->solve()) {
+			int64_t solve_begin = PerformanceTimer::query();
+			bool base_case = ez->solve();
+			int64_t solve_ns = PerformanceTimer::query() - solve_begin;
+			if (!base_case) {
 				log("  Proof for base case failed. Circuit inherently diverges!\n");
 				return;
 			}
 
+			int64_t encode_begin = PerformanceTimer::query();
 			create_timestep(step+1);
 			int new_step_not_consistent = ez->NOT(ez_step_is_consistent[step+1]);
 			ez->bind(new_step_not_consistent);
+			int64_t encode_ns = PerformanceTimer::query() - encode_begin;
 
 			log("  Proving induction step %d. (%d clauses over %d variables)\n", step, ez->numCnfClauses(), ez->numCnfVariables());
-			if (!ez->solve(new_step_not_consistent)) {
+			solve_begin = PerformanceTimer::query();
+			bool induction_step = ez->solve(new_step_not_consistent);
+			solve_ns += PerformanceTimer::query() - solve_begin;
+			log("  Time for step %d: %.2f sec encoding, %.2f sec solving.\n", step, encode_ns * 1e-9, solve_ns * 1e-9);
+
+			if (!induction_step) {
 				log("  Proof for induction step holds. Entire workset of %d cells proven!\n", GetSize(workset));
 				for (auto cell : workset)
 					cell->setPort(ID::B, cell->getPort(ID::A));
@@ -140,6 +200,8 @@ struct EquivInductWorker
 
 		workset.sort();
 
+		int64_t individual_begin = PerformanceTimer::query();
+
 		for (auto cell : workset)
 		{
 			SigBit bit_a = sigmap(cell->getPort(ID::A)).as_bit();
@@ -162,6 +224,8 @@ struct EquivInductWorker
 				log(" failed.\n");
 			}
 		}
+
+		log("  Time for individual proofs: %.2f sec.\n", (PerformanceTimer::query() - individual_begin) * 1e-9);
 	}
 };
 
@@ -23,6 +23,28 @@
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
 
+// Sigmapped input bits of a cell as followed by find_input_cone(). For FF
+// cells these are the bits that continue in the previous time step.
+struct EquivSimpleCellInputs
+{
+	bool is_ff = false;
+	vector<SigBit> bits;
+
+	EquivSimpleCellInputs() { }
+
+	EquivSimpleCellInputs(Cell *cell, const SigMap &sigmap)
+	{
+		is_ff = RTLIL::builtin_ff_cell_types().count(cell->type);
+		for (auto &conn : cell->connections())
+			if (yosys_celltypes.cell_input(cell->type, conn.first)) {
+				if (is_ff && conn.first.in(ID::CLK, ID::C))
+					continue;
+				for (auto bit : sigmap(conn.second))
+					bits.push_back(bit);
+			}
+	}
+};
+
 struct EquivSimpleWorker
 {
 	Module *module;
@@ -31,6 +53,7 @@ struct EquivSimpleWorker
 
 	SigMap &sigmap;
 	dict<SigBit, Cell*> &bit2driver;
+	dict<Cell*, EquivSimpleCellInputs> &cell_inputs;
 
 	ezSatPtr ez;
 	SatGen satgen;
@@ -40,9 +63,11 @@ struct EquivSimpleWorker
 
 	pool<pair<Cell*, int>> imported_cells_cache;
 
-	EquivSimpleWorker(const vector<Cell*> &equiv_cells, SigMap &sigmap, dict<SigBit, Cell*> &bit2driver, int max_seq, bool short_cones, bool verbose, bool model_undef) :
+	EquivSimpleWorker(const vector<Cell*> &equiv_cells, SigMap &sigmap, dict<SigBit, Cell*> &bit2driver, dict<Cell*, EquivSimpleCellInputs> &cell_inputs,
+			int max_seq, bool short_cones, bool verbose, bool model_undef) :
 			module(equiv_cells.front()->module), equiv_cells(equiv_cells), equiv_cell(nullptr),
-			sigmap(sigmap), bit2driver(bit2driver), satgen(ez.get(), &sigmap), max_seq(max_seq), short_cones(short_cones), verbose(verbose)
+			sigmap(sigmap), bit2driver(bit2driver), cell_inputs(cell_inputs), satgen(ez.get(), &sigmap),
+			max_seq(max_seq), short_cones(short_cones), verbose(verbose)
 	{
 		satgen.model_undef = model_undef;
 	}
@@ -57,15 +82,12 @@ struct EquivSimpleWorker
 		if (cells_stop.count(cell))
 			return true;
 
-		for (auto &conn : cell->connections())
-			if (yosys_celltypes.cell_input(cell->type, conn.first))
-				for (auto bit : sigmap(conn.second)) {
-					if (RTLIL::builtin_ff_cell_types().count(cell->type)) {
-						if (!conn.first.in(ID::CLK, ID::C))
-							next_seed.insert(bit);
-					} else
-						find_input_cone(next_seed, cells_cone, bits_cone, cells_stop, bits_stop, input_bits, bit);
-				}
+		const EquivSimpleCellInputs &inputs = cell_inputs.at(cell);
+		if (inputs.is_ff)
+			next_seed.insert(inputs.bits.begin(), inputs.bits.end());
+		else
+			for (auto bit : inputs.bits)
+				find_input_cone(next_seed, cells_cone, bits_cone, cells_stop, bits_stop, input_bits, bit);
 		return false;
 	}
 
@@ -81,10 +103,11 @@ struct EquivSimpleWorker
 			return;
 		}
 
-		if (!bit2driver.count(bit))
+		auto it = bit2driver.find(bit);
+		if (it == bit2driver.end())
 			return;
 
-		if (find_input_cone(next_seed, cells_cone, bits_cone, cells_stop, bits_stop, input_bits, bit2driver.at(bit)))
+		if (find_input_cone(next_seed, cells_cone, bits_cone, cells_stop, bits_stop, input_bits, it->second))
 			if (input_bits != nullptr) input_bits->insert(bit);
 	}
 
@@ -204,6 +227,8 @@ struct EquivSimpleWorker
 			if (!ez->solve(ez_context)) {
 				log(verbose ? "    Proved equivalence! Marking $equiv cell as proven.\n" : " success!\n");
 				equiv_cell->setPort(ID::B, equiv_cell->getPort(ID::A));
+				if (cell_inputs.count(equiv_cell))
+					cell_inputs.at(equiv_cell) = EquivSimpleCellInputs(equiv_cell, sigmap);
 				ez->assume(ez->NOT(ez_context));
 				return true;
 			}
@@ -346,6 +371,7 @@ struct EquivSimplePass : public Pass {
 		{
 			SigMap sigmap(module);
 			dict<SigBit, Cell*> bit2driver;
+			dict<Cell*, EquivSimpleCellInputs> cell_inputs;
 			dict<SigBit, dict<SigBit, Cell*>> unproven_equiv_cells;
 			int unproven_cells_counter = 0;
 
@@ -372,6 +398,7 @@ struct EquivSimplePass : public Pass {
 					if (yosys_celltypes.cell_output(cell->type, conn.first))
 						for (auto bit : sigmap(conn.second))
 							bit2driver[bit] = cell;
+				cell_inputs[cell] = EquivSimpleCellInputs(cell, sigmap);
 			}
 
 			unproven_equiv_cells.sort();
@@ -383,7 +410,7 @@ struct EquivSimplePass : public Pass {
 				for (auto it2 : it.second)
 					cells.push_back(it2.second);
 
-				EquivSimpleWorker worker(cells, sigmap, bit2driver, max_seq, short_cones, verbose, model_undef);
+				EquivSimpleWorker worker(cells, sigmap, bit2driver, cell_inputs, max_seq, short_cones, verbose, model_undef);
 				success_counter += worker.run();
 			}
 		}
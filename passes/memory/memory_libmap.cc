@@ -136,7 +136,16 @@ struct MapWorker {
 	SigMap sigmap_xmux;
 	FfInitVals initvals;
 
-	MapWorker(Module *module) : module(module), modwalker(module->design, module), sigmap(module), sigmap_xmux(module), initvals(&sigmap, module) {
+	MapWorker(Module *module) : module(module), modwalker(module->design, module) {
+		refresh();
+	}
+
+	// Rebuilds the sigmaps and init values from the current module, emitting
+	// a memory connects and removes wires and FFs behind their back.
+	void refresh() {
+		sigmap.set(module);
+		sigmap_xmux.set(module);
+		initvals.set(&sigmap, module);
 		for (auto cell : module->cells())
 		{
 			if (cell->type == ID($mux))
@@ -185,7 +194,10 @@ struct MemMapping {
 	dict<std::pair<int, int>, bool> wr_excludes_srst_cache;
 	std::string rejected_cfg_debug_msgs;
 
-	MemMapping(MapWorker &worker, Mem &mem, const Library &lib, const PassOptions &opts) : worker(worker), qcsat(worker.modwalker), mem(mem), lib(lib), opts(opts) {
+	MemMapping(MapWorker &worker, Mem &mem, const Library &lib, const PassOptions &opts) : worker(worker), qcsat(worker.modwalker), mem(mem), lib(lib), opts(opts) {}
+
+	// Enumerates and scores all valid mapping configurations into cfgs.
+	void find_configs() {
 		determine_style();
 		logic_ok = determine_logic_ok();
 		if (GetSize(mem.wr_ports) == 0)
@@ -309,6 +321,8 @@ struct MemMapping {
 	void handle_rd_rst();
 	void score_emu_ports();
 	void handle_geom();
+	std::string resource_key(const MemConfig &cfg);
+	double cost_lower_bound(const MemConfig &cfg);
 	void prune_post_geom();
 	void emit_port(const MemConfig &cfg, std::vector<Cell*> &cells, const PortVariant &pdef, const char *name, int wpidx, int rpidx, const std::vector<int> &hw_addr_swizzle);
 	void emit(const MemConfig &cfg);
@@ -1192,7 +1206,20 @@ void MemMapping::handle_geom() {
 		en.sort_and_unify();
 		wren_size.push_back(GetSize(en));
 	}
-	for (auto &cfg: cfgs) {
+	// Best cost found so far for each resource.  prune_post_geom() only keeps
+	// the cheapest configuration per resource (the first one on ties), so any
+	// configuration whose cost cannot drop below that is skipped here without
+	// running the geometry search on it.
+	dict<std::string, double> best_rsrc_cost;
+	std::vector<bool> pruned(GetSize(cfgs), false);
+	for (int ci = 0; ci < GetSize(cfgs); ci++) {
+		auto &cfg = cfgs[ci];
+		std::string rsrc = resource_key(cfg);
+		auto rsrc_it = best_rsrc_cost.find(rsrc);
+		if (rsrc_it != best_rsrc_cost.end() && cost_lower_bound(cfg) >= rsrc_it->second) {
+			pruned[ci] = true;
+			continue;
+		}
 		// First, create a set of "byte boundaries": the bit positions in source memory word
 		// that have write enable different from the previous bit in any write port.
 		// Bit 0 is considered to be a byte boundary as well.
@@ -1466,7 +1493,49 @@ hw_bit_failed:
 bw_done:;
 		}
 		log_assert(got_config);
+		if (rsrc_it == best_rsrc_cost.end())
+			best_rsrc_cost[rsrc] = cfg.cost;
+		else if (cfg.cost < rsrc_it->second)
+			rsrc_it->second = cfg.cost;
+	}
+	MemConfigs new_cfgs;
+	for (int i = 0; i < GetSize(cfgs); i++)
+		if (!pruned[i])
+			new_cfgs.push_back(std::move(cfgs[i]));
+	cfgs = std::move(new_cfgs);
+}
+
+std::string MemMapping::resource_key(const MemConfig &cfg) {
+	std::string key = cfg.def->resource_name;
+	if (key.empty()) {
+		switch (cfg.def->kind) {
+			case RamKind::Distributed:
+				key = "[distributed]";
+				break;
+			case RamKind::Block:
+				key = "[block]";
+				break;
+			case RamKind::Huge:
+				key = "[huge]";
+				break;
+			default:
+				break;
+		}
 	}
+	return key;
+}
+
+// A lower bound on the cost handle_geom() can assign to this configuration,
+// assuming a single data replica and no mux / demux logic.
+double MemMapping::cost_lower_bound(const MemConfig &cfg) {
+	double cost = cfg.score_emu * FACTOR_EMU;
+	// With a negative widthscale or one above the base cost, the replica
+	// terms are not monotonic and give no usable bound.
+	if (cfg.def->widthscale >= 0 && cfg.def->cost >= cfg.def->widthscale)
+		cost += (cfg.def->cost - cfg.def->widthscale) * cfg.repl_port;
+	else
+		cost = -std::numeric_limits<double>::infinity();
+	return cost;
 }
 
 void MemMapping::prune_post_geom() {
@@ -1474,22 +1543,7 @@ void MemMapping::prune_post_geom() {
 	dict<std::string, int> rsrc;
 	for (int i = 0; i < GetSize(cfgs); i++) {
 		auto &cfg = cfgs[i];
-		std::string key = cfg.def->resource_name;
-		if (key.empty()) {
-			switch (cfg.def->kind) {
-				case RamKind::Distributed:
-					key = "[distributed]";
-					break;
-				case RamKind::Block:
-					key = "[block]";
-					break;
-				case RamKind::Huge:
-					key = "[huge]";
-					break;
-				default:
-					break;
-			}
-		}
+		std::string key = resource_key(cfg);
 		auto it = rsrc.find(key);
 		if (it == rsrc.end()) {
 			rsrc[key] = i;
@@ -2232,11 +2286,20 @@ struct MemoryLibMapPass : public Pass {
 			if (module->has_processes_warn())
 				continue;
 
-			auto worker = std::make_unique<MapWorker>(module);
+			// The mapping of every memory is chosen up front, against the
+			// unmodified module, and only then are the memories emitted.
+			// This way the module indices in the worker are built once per
+			// module rather than once per mapped memory, which made this
+			// pass quadratic on modules with many memories.  Emission
+			// does change the netlist, so the (much cheaper) sigmaps and
+			// init values are rebuilt before the next memory is emitted.
+			MapWorker worker(module);
 			auto mems = Mem::get_selected_memories(module);
+			std::vector<std::pair<Mem*, MemConfig>> mappings;
 			for (auto &mem : mems)
 			{
-				MemMapping map(*worker, mem, lib, opts);
+				MemMapping map(worker, mem, lib, opts);
+				map.find_configs();
 				int idx = -1;
 				int best = map.logic_cost;
 				if (!map.logic_ok) {
@@ -2254,13 +2317,17 @@ struct MemoryLibMapPass : public Pass {
 						best = map.cfgs[i].cost;
 					}
 				}
-				if (idx == -1) {
+				if (idx == -1)
 					log("using FF mapping for memory %s.%s\n", log_id(module->name), log_id(mem.memid));
-				} else {
-					map.emit(map.cfgs[idx]);
-					// Rebuild indices after modifying module
-					worker = std::make_unique<MapWorker>(module);
-				}
+				else
+					mappings.push_back({&mem, std::move(map.cfgs[idx])});
+			}
+
+			for (int i = 0; i < GetSize(mappings); i++) {
+				if (i > 0)
+					worker.refresh();
+				MemMapping map(worker, *mappings[i].first, lib, opts);
+				map.emit(mappings[i].second);
 			}
 		}
 	}
@@ -22,6 +22,7 @@
 #include "kernel/log.h"
 #include "kernel/celltypes.h"
 #include "kernel/ffinit.h"
+#include "kernel/trace.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <set>
@@ -106,7 +107,7 @@ int count_rm_cells, count_rm_wires;
 
 void rmunused_module_cells(Module *module, bool verbose)
 {
-	SigMap sigmap(module);
+	const SigMap &sigmap = module->sigmap();
 	dict<IdString, pool<Cell*>> mem2cells;
 	pool<IdString> mem_unused;
 	pool<Cell*> queue, unused;
@@ -350,6 +351,7 @@ bool rmunused_module_signals(RTLIL::Module *module, bool purge_mode, bool verbos
 
 	// we are removing all connections
 	module->connections_.clear();
+	module->invalidate_sigmap();
 
 	// used signals sigmapped
 	SigPool used_signals;
@@ -675,6 +677,7 @@ struct OptCleanPass : public Pass {
 		for (auto module : design->selected_whole_modules_warn()) {
 			if (module->has_processes_warn())
 				continue;
+			TraceSpan span("opt_clean", "module", module);
 			rmunused_module(module, purge_mode, true, true);
 		}
 
@@ -737,6 +740,7 @@ struct CleanPass : public Pass {
 		for (auto module : design->selected_unboxed_whole_modules()) {
 			if (module->has_processes())
 				continue;
+			TraceSpan span("clean", "module", module);
 			rmunused_module(module, purge_mode, ys_debug(), true);
 		}
 
@@ -51,7 +51,7 @@ void demorgan_worker(
 
 		//See if this bit is driven by a $not cell
 		//TODO: do other stuff like nor/nand?
-		pool<ModIndex::PortInfo> ports = index.query_ports(b);
+		const auto &ports = index.query_ports(b);
 		bool inverted = false;
 		for(auto x : ports)
 		{
@@ -85,7 +85,7 @@ void demorgan_worker(
 
 		//See if this bit is driven by a $not cell
 		//TODO: do other stuff like nor/nand?
-		pool<ModIndex::PortInfo> ports = index.query_ports(b);
+		const auto &ports = index.query_ports(b);
 		RTLIL::Cell* srcinv = NULL;
 		for(auto x : ports)
 		{
@@ -22,6 +22,7 @@
 #include "kernel/celltypes.h"
 #include "kernel/utils.h"
 #include "kernel/log.h"
+#include "kernel/trace.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <algorithm>
@@ -33,7 +34,7 @@ bool did_something;
 
 void replace_undriven(RTLIL::Module *module, const CellTypes &ct)
 {
-	SigMap sigmap(module);
+	const SigMap &sigmap = module->sigmap();
 	SigPool driven_signals;
 	SigPool used_signals;
 	SigPool all_signals;
@@ -94,7 +95,7 @@ void replace_undriven(RTLIL::Module *module, const CellTypes &ct)
 
 	if (!revisit_initwires.empty())
 	{
-		SigMap sm2(module);
+		const SigMap &sm2 = module->sigmap();
 
 		for (auto wire : revisit_initwires) {
 			SigSpec sig = sm2(wire);
@@ -2361,6 +2362,8 @@ struct OptExprPass : public Pass {
 		CellTypes ct(design);
 		for (auto module : design->selected_modules())
 		{
+			TraceSpan span("opt_expr", "module", module);
+
 			log("Optimizing module %s.\n", log_id(module));
 
 			if (undriven) {
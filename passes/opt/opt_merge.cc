@@ -22,6 +22,7 @@
 #include "kernel/sigtools.h"
 #include "kernel/log.h"
 #include "kernel/celltypes.h"
+#include "kernel/trace.h"
 #include "libs/sha1/sha1.h"
 #include <stdlib.h>
 #include <stdio.h>
@@ -394,6 +395,7 @@ struct OptMergePass : public Pass {
 
 		int total_count = 0;
 		for (auto module : design->selected_modules()) {
+			TraceSpan span("opt_merge", "module", module);
 			OptMergeWorker worker(design, module, mode_nomux, mode_share_all, mode_keepdc);
 			total_count += worker.total_count;
 		}
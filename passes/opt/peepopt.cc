@@ -99,16 +99,17 @@ struct PeepoptPass : public Pass {
 
 		for (auto module : design->selected_modules())
 		{
+			peepopt_pm pm(module);
+
+			pm.setup(module->selected_cells());
+			pm.track_changes([&](Cell *cell) { return design->selected(module, cell); });
+
 			did_something = true;
 
 			while (did_something)
 			{
 				did_something = false;
 
-				peepopt_pm pm(module);
-
-				pm.setup(module->selected_cells());
-
 				if (formalclk) {
 					pm.run_formal_clockgateff();
 				} else {
@@ -118,6 +119,8 @@ struct PeepoptPass : public Pass {
 					pm.run_muldiv();
 					pm.run_muldiv_c();
 				}
+
+				pm.update();
 			}
 		}
 	}
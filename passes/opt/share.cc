@@ -1039,6 +1039,38 @@ struct ShareWorker
 		return simplified;
 	}
 
+	// Decides without the SAT solver whether an activation pattern from the first
+	// set can be true at the same time as one from the second set, i.e. whether
+	// the patterns on their own are not mutually exclusive. Returns -1 if that
+	// can't be decided from the patterns alone (constant or undef bits).
+	int activation_patterns_overlap(const pool<ssc_pair_t> &activation_patterns, const pool<ssc_pair_t> &other_activation_patterns)
+	{
+		for (auto const &pattern : activation_patterns)
+		for (auto const &other_pattern : other_activation_patterns)
+		{
+			dict<SigBit, State> values;
+			bool conflict = false;
+
+			for (auto p : {&pattern, &other_pattern})
+				for (int i = 0; i < GetSize(p->second); ++i) {
+					SigBit bit = modwalker.sigmap(p->first[i]);
+					State val = p->second[i];
+					if (bit.wire == nullptr || (val != State::S0 && val != State::S1))
+						return -1;
+					auto it = values.find(bit);
+					if (it == values.end())
+						values[bit] = val;
+					else if (it->second != val)
+						conflict = true;
+				}
+
+			if (!conflict)
+				return 1;
+		}
+
+		return 0;
+	}
+
 	// Only valid if the patterns on their own (i.e. without considering their input cone) are mutually exclusive!
 	bool restrict_activation_patterns(pool<ssc_pair_t> &activation_patterns, pool<ssc_pair_t> &other_activation_patterns)
 	{
@@ -1313,6 +1345,16 @@ struct ShareWorker
 				log("      Found %d activation_patterns using ctrl signal %s.\n",
 						GetSize(other_cell_activation_patterns), log_signal(other_cell_activation_signals));
 
+				if (find_in_input_cone(cell, other_cell)) {
+					log("      Sharing not possible: %s is in input cone of %s.\n", log_id(other_cell), log_id(cell));
+					continue;
+				}
+
+				if (find_in_input_cone(other_cell, cell)) {
+					log("      Sharing not possible: %s is in input cone of %s.\n", log_id(cell), log_id(other_cell));
+					continue;
+				}
+
 				const pool<RTLIL::SigBit> &cell_forbidden_controls = find_forbidden_controls(cell);
 				const pool<RTLIL::SigBit> &other_cell_forbidden_controls = find_forbidden_controls(other_cell);
 
@@ -1357,7 +1399,8 @@ struct ShareWorker
 				int sub1 = qcsat.ez->expression(qcsat.ez->OpOr, cell_active);
 				int sub2 = qcsat.ez->expression(qcsat.ez->OpOr, other_cell_active);
 
-				bool pattern_only_solve = qcsat.ez->solve(qcsat.ez->AND(sub1, sub2));
+				int pattern_overlap = activation_patterns_overlap(filtered_cell_activation_patterns, filtered_other_cell_activation_patterns);
+				bool pattern_only_solve = pattern_overlap < 0 ? qcsat.ez->solve(qcsat.ez->AND(sub1, sub2)) : pattern_overlap > 0;
 				qcsat.prepare();
 
 				if (!qcsat.ez->solve(sub1)) {
@@ -1410,16 +1453,6 @@ struct ShareWorker
 					}
 				}
 
-				if (find_in_input_cone(cell, other_cell)) {
-					log("      Sharing not possible: %s is in input cone of %s.\n", log_id(other_cell), log_id(cell));
-					continue;
-				}
-
-				if (find_in_input_cone(other_cell, cell)) {
-					log("      Sharing not possible: %s is in input cone of %s.\n", log_id(cell), log_id(other_cell));
-					continue;
-				}
-
 				shareable_cells.erase(other_cell);
 
 				int cell_select_score = 0;
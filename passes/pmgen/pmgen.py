@@ -401,6 +401,38 @@ with open(outfile, "w") as f:
     print("  int rollback;", file=f)
     print("", file=f)
 
+    print("  struct monitor_t : RTLIL::Monitor {", file=f)
+    print("    {}_pm *pm;".format(prefix), file=f)
+    print("    monitor_t({}_pm *pm) : pm(pm) {{ }}".format(prefix), file=f)
+    print("    void notify_connect(Cell *cell, const IdString &portname, const SigSpec &old_sig, const SigSpec &sig) override {", file=f)
+    print("      pm->released_sigs[cell].append(old_sig);", file=f)
+    print("      pm->changed_sigs.append(old_sig);", file=f)
+    print("      pm->changed_sigs.append(sig);", file=f)
+    print("      // Module::remove() disconnects all ports before deleting the cell", file=f)
+    print("      if (sig.empty() && GetSize(cell->connections_) == 1 && cell->connections_.count(portname))", file=f)
+    print("        pm->forget_cell(cell);", file=f)
+    print("      else", file=f)
+    print("        pm->changed_cells.insert(cell);", file=f)
+    print("    }", file=f)
+    print("    void notify_connect(Module*, const SigSig &sigsig) override { pm->connected_sigs.push_back(sigsig); }", file=f)
+    print("    void notify_connect(Module*, const vector<SigSig>&) override { pm->rebuild_needed = true; }", file=f)
+    print("    void notify_blackout(Module*) override { pm->rebuild_needed = true; }", file=f)
+    print("  } monitor{this};", file=f)
+    print("", file=f)
+    print("  bool tracking = false;", file=f)
+    print("  bool rebuild_needed = false;", file=f)
+    print("  std::function<bool(Cell*)> track_filter;", file=f)
+    print("  pool<Cell*> changed_cells;", file=f)
+    print("  pool<Cell*, hashlib::hash_ptr_ops> removed_cells;", file=f)
+    print("  dict<Cell*, SigSpec> released_sigs;", file=f)
+    print("  vector<SigSig> connected_sigs;", file=f)
+    print("  SigSpec changed_sigs;", file=f)
+    for index in range(len(blocks)):
+        if blocks[index]["type"] == "match":
+            print("  dict<Cell*, vector<index_{}_key_type>> index_{}_keys;".format(index, index), file=f)
+            print("  vector<index_{}_key_type> index_{}_stale_keys;".format(index, index), file=f)
+    print("", file=f)
+
     for current_pattern in sorted(patterns.keys()):
         print("  struct state_{}_t {{".format(current_pattern), file=f)
         for s, t in sorted(state_types[current_pattern].items()):
@@ -503,53 +535,211 @@ with open(outfile, "w") as f:
     current_pattern = None
     print("    log_assert(!setup_done);", file=f)
     print("    setup_done = true;", file=f)
+    print("    init_sigusers();", file=f)
+    print("    for (auto cell : cells)", file=f)
+    print("      index_cell(cell);", file=f)
+    print("  }", file=f)
+    print("", file=f)
+
+    print("  void init_sigusers() {", file=f)
     print("    for (auto port : module->ports)", file=f)
     print("      add_siguser(module->wire(port), nullptr);", file=f)
     print("    for (auto cell : module->cells())", file=f)
     print("      for (auto &conn : cell->connections())", file=f)
     print("        add_siguser(conn.second, cell);", file=f)
-    print("    for (auto cell : cells) {", file=f)
+    print("  }", file=f)
+    print("", file=f)
 
+    print("  void index_cell(Cell *cell) {", file=f)
     for index in range(len(blocks)):
         block = blocks[index]
         if block["type"] == "match":
-            print("      do {", file=f)
-            print("        Cell *{} = cell;".format(block["cell"]), file=f)
-            print("        index_{}_value_type value;".format(index), file=f)
-            print("        std::get<0>(value) = cell;", file=f)
+            print("    do {", file=f)
+            print("      Cell *{} = cell;".format(block["cell"]), file=f)
+            print("      index_{}_value_type value;".format(index), file=f)
+            print("      std::get<0>(value) = cell;", file=f)
             loopcnt = 0
             valueidx = 1
             for item in block["setup"]:
                 if item[0] == "select":
-                    print("        if (!({})) continue;".format(item[1]), file=f)
+                    print("      if (!({})) continue;".format(item[1]), file=f)
                 if item[0] == "slice":
-                    print("        int &{} = std::get<{}>(value);".format(item[1], valueidx), file=f)
-                    print("        for ({} = 0; {} < {}; {}++) {{".format(item[1], item[1], item[2], item[1]), file=f)
+                    print("      int &{} = std::get<{}>(value);".format(item[1], valueidx), file=f)
+                    print("      for ({} = 0; {} < {}; {}++) {{".format(item[1], item[1], item[2], item[1]), file=f)
                     valueidx += 1
                     loopcnt += 1
                 if item[0] == "choice":
-                    print("        vector<{}> _pmg_choices_{} = {};".format(item[1], item[2], item[3]), file=f)
-                    print("        for (const {} &{} : _pmg_choices_{}) {{".format(item[1], item[2], item[2]), file=f)
-                    print("        std::get<{}>(value) = {};".format(valueidx, item[2]), file=f)
+                    print("      vector<{}> _pmg_choices_{} = {};".format(item[1], item[2], item[3]), file=f)
+                    print("      for (const {} &{} : _pmg_choices_{}) {{".format(item[1], item[2], item[2]), file=f)
+                    print("      std::get<{}>(value) = {};".format(valueidx, item[2]), file=f)
                     valueidx += 1
                     loopcnt += 1
                 if item[0] == "define":
-                    print("        {} &{} = std::get<{}>(value);".format(item[1], item[2], valueidx), file=f)
-                    print("        {} = {};".format(item[2], item[3]), file=f)
+                    print("      {} &{} = std::get<{}>(value);".format(item[1], item[2], valueidx), file=f)
+                    print("      {} = {};".format(item[2], item[3]), file=f)
                     valueidx += 1
-            print("        index_{}_key_type key;".format(index), file=f)
+            print("      index_{}_key_type key;".format(index), file=f)
             for field, entry in enumerate(block["index"]):
-                print("        std::get<{}>(key) = {};".format(field, entry[1]), file=f)
-            print("        index_{}[key].push_back(value);".format(index), file=f)
+                print("      std::get<{}>(key) = {};".format(field, entry[1]), file=f)
+            print("      index_{}[key].push_back(value);".format(index), file=f)
+            print("      if (tracking)", file=f)
+            print("        index_{}_keys[cell].push_back(key);".format(index), file=f)
             for i in range(loopcnt):
-                print("        }", file=f)
-            print("      } while (0);", file=f)
+                print("      }", file=f)
+            print("    } while (0);", file=f)
+    print("  }", file=f)
+    print("", file=f)
+
+    print("  // Keep the indices in sync with the changes made to the module, so that the", file=f)
+    print("  // same matcher can be run again after update() instead of being rebuilt.", file=f)
+    print("  // Cells created later are indexed if track_filter (if any) accepts them.", file=f)
+    print("  void track_changes(std::function<bool(Cell*)> filter = nullptr) {", file=f)
+    print("    log_assert(setup_done && !tracking);", file=f)
+    print("    tracking = true;", file=f)
+    print("    track_filter = filter;", file=f)
+    print("    module->monitors.insert(&monitor);", file=f)
+    for index in range(len(blocks)):
+        if blocks[index]["type"] == "match":
+            print("    for (auto &it : index_{})".format(index), file=f)
+            print("      for (auto &value : it.second)", file=f)
+            print("        index_{}_keys[std::get<0>(value)].push_back(it.first);".format(index), file=f)
+    print("  }", file=f)
+    print("", file=f)
+
+    print("  // Called while the cell still exists: the containers above hash cells by", file=f)
+    print("  // their hashidx_, so no reference to the cell may survive its deletion.", file=f)
+    print("  void forget_cell(Cell *cell) {", file=f)
+    print("    auto released = released_sigs.find(cell);", file=f)
+    print("    if (released != released_sigs.end()) {", file=f)
+    print("      release_siguser(released->second, cell);", file=f)
+    print("      released_sigs.erase(released);", file=f)
+    print("    }", file=f)
+    for index in range(len(blocks)):
+        if blocks[index]["type"] == "match":
+            print("    auto keys_{} = index_{}_keys.find(cell);".format(index, index), file=f)
+            print("    if (keys_{} != index_{}_keys.end()) {{".format(index, index), file=f)
+            print("      for (auto &key : keys_{}->second)".format(index), file=f)
+            print("        index_{}_stale_keys.push_back(key);".format(index), file=f)
+            print("      index_{}_keys.erase(keys_{});".format(index, index), file=f)
+            print("    }", file=f)
+    print("    changed_cells.erase(cell);", file=f)
+    print("    blacklist_cells.erase(cell);", file=f)
+    print("    autoremove_cells.erase(cell);", file=f)
+    print("    removed_cells.insert(cell);", file=f)
+    print("  }", file=f)
+    print("", file=f)
+
+    print("  void release_siguser(const SigSpec &sig, Cell *cell) {", file=f)
+    print("    for (auto bit : sigmap(sig)) {", file=f)
+    print("      auto users = sigusers.find(bit);", file=f)
+    print("      if (users != sigusers.end())", file=f)
+    print("        users->second.erase(cell);", file=f)
+    print("    }", file=f)
+    print("  }", file=f)
+    print("", file=f)
 
+    print("  // Removes the autoremove cells and re-indexes every cell that was created,", file=f)
+    print("  // reconnected, blacklisted or connected to a changed net since the last update().", file=f)
+    print("  void update() {", file=f)
+    print("    log_assert(tracking);", file=f)
+    print("    for (auto cell : blacklist_cells)", file=f)
+    print("      changed_cells.insert(cell);", file=f)
+    print("    blacklist_cells.clear();", file=f)
+    print("    pool<Cell*> cells;", file=f)
+    print("    cells.swap(autoremove_cells);", file=f)
+    print("    for (auto cell : cells)", file=f)
+    print("      module->remove(cell);", file=f)
+    print("", file=f)
+    print("    if (rebuild_needed) {", file=f)
+    print("      sigmap.set(module);", file=f)
+    print("      sigusers.clear();", file=f)
+    for index in range(len(blocks)):
+        if blocks[index]["type"] == "match":
+            print("      index_{}.clear();".format(index), file=f)
+            print("      index_{}_keys.clear();".format(index), file=f)
+            print("      index_{}_stale_keys.clear();".format(index), file=f)
+    print("      init_sigusers();", file=f)
+    print("      for (auto cell : module->cells())", file=f)
+    print("        if (!track_filter || track_filter(cell))", file=f)
+    print("          index_cell(cell);", file=f)
+    print("    } else {", file=f)
+    print("      for (auto &it : released_sigs)", file=f)
+    print("        release_siguser(it.second, it.first);", file=f)
+    print("      for (auto &conn : connected_sigs)", file=f)
+    print("        for (int i = 0; i < GetSize(conn.first); i++) {", file=f)
+    print("          SigBit a = sigmap(conn.first[i]), b = sigmap(conn.second[i]);", file=f)
+    print("          if (a == b) continue;", file=f)
+    print("          sigmap.add(conn.first[i], conn.second[i]);", file=f)
+    print("          SigBit rep = sigmap(a);", file=f)
+    print("          for (auto bit : {a, b}) {", file=f)
+    print("            auto users_it = sigusers.find(bit);", file=f)
+    print("            if (bit == rep || users_it == sigusers.end()) continue;", file=f)
+    print("            pool<Cell*> users;", file=f)
+    print("            users.swap(users_it->second);", file=f)
+    print("            sigusers.erase(users_it);", file=f)
+    print("            for (auto user : users) {", file=f)
+    print("              if (rep.wire != nullptr)", file=f)
+    print("                sigusers[rep].insert(user);", file=f)
+    print("              if (user != nullptr)", file=f)
+    print("                changed_cells.insert(user);", file=f)
+    print("            }", file=f)
+    print("          }", file=f)
+    print("        }", file=f)
+    print("      for (auto cell : changed_cells)", file=f)
+    print("        for (auto &conn : cell->connections())", file=f)
+    print("          add_siguser(conn.second, cell);", file=f)
+    print("      // select and filter expressions may look at the number of users of a net", file=f)
+    print("      vector<Cell*> neighbours;", file=f)
+    print("      for (auto bit : sigmap(changed_sigs)) {", file=f)
+    print("        auto users = sigusers.find(bit);", file=f)
+    print("        if (users != sigusers.end())", file=f)
+    print("          for (auto user : users->second)", file=f)
+    print("            if (user != nullptr && !changed_cells.count(user))", file=f)
+    print("              neighbours.push_back(user);", file=f)
+    print("      }", file=f)
+    print("      for (auto cell : neighbours)", file=f)
+    print("        changed_cells.insert(cell);", file=f)
+    print("", file=f)
+    for index in range(len(blocks)):
+        if blocks[index]["type"] == "match":
+            print("      {", file=f)
+            print("        pool<index_{}_key_type> keys(index_{}_stale_keys.begin(), index_{}_stale_keys.end());".format(index, index, index), file=f)
+            print("        index_{}_stale_keys.clear();".format(index), file=f)
+            print("        for (auto cell : changed_cells) {", file=f)
+            print("          auto cell_keys = index_{}_keys.find(cell);".format(index), file=f)
+            print("          if (cell_keys == index_{}_keys.end()) continue;".format(index), file=f)
+            print("          keys.insert(cell_keys->second.begin(), cell_keys->second.end());", file=f)
+            print("          index_{}_keys.erase(cell_keys);".format(index), file=f)
+            print("        }", file=f)
+            print("        for (auto &key : keys) {", file=f)
+            print("          auto values = index_{}.find(key);".format(index), file=f)
+            print("          if (values == index_{}.end()) continue;".format(index), file=f)
+            print("          auto &vec = values->second;", file=f)
+            print("          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_{}_value_type &value) {{".format(index), file=f)
+            print("            Cell *cell = std::get<0>(value);", file=f)
+            print("            return removed_cells.count(cell) || changed_cells.count(cell);", file=f)
+            print("          }), vec.end());", file=f)
+            print("          if (vec.empty())", file=f)
+            print("            index_{}.erase(values);".format(index), file=f)
+            print("        }", file=f)
+            print("      }", file=f)
+    print("      for (auto cell : changed_cells)", file=f)
+    print("        if (!track_filter || track_filter(cell))", file=f)
+    print("          index_cell(cell);", file=f)
     print("    }", file=f)
+    print("", file=f)
+    print("    rebuild_needed = false;", file=f)
+    print("    changed_cells.clear();", file=f)
+    print("    removed_cells.clear();", file=f)
+    print("    released_sigs.clear();", file=f)
+    print("    connected_sigs.clear();", file=f)
+    print("    changed_sigs = SigSpec();", file=f)
     print("  }", file=f)
     print("", file=f)
 
     print("  ~{}_pm() {{".format(prefix), file=f)
+    print("    if (tracking)", file=f)
+    print("      module->monitors.erase(&monitor);", file=f)
     print("    for (auto cell : autoremove_cells)", file=f)
     print("      module->remove(cell);", file=f)
     print("  }", file=f)
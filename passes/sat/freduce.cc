@@ -32,7 +32,7 @@
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
 
-bool inv_mode;
+bool inv_mode, sim_mode;
 int verbose_level, reduce_counter, reduce_stop_at;
 typedef std::map<RTLIL::SigBit, std::pair<RTLIL::Cell*, std::set<RTLIL::SigBit>>> drivers_t;
 std::string dump_prefix;
@@ -241,6 +241,34 @@ struct PerformReduction
 	std::vector<int> out_depth;
 	int cone_size;
 
+	// Bit-parallel simulation of the cone, used to split buckets before they
+	// are handed to the SAT solver. Every simulation word holds 64 complete
+	// input assignments: the first ones are random, the following ones collect
+	// the models returned by the SAT solver. This is only exact for cones made
+	// of simple gates without undef constants, for anything else sim_ok is
+	// cleared and all buckets go straight to SAT.
+
+	enum sim_op_t {
+		SIM_BUF, SIM_NOT, SIM_AND, SIM_NAND, SIM_OR, SIM_NOR, SIM_XOR, SIM_XNOR,
+		SIM_ANDNOT, SIM_ORNOT, SIM_MUX, SIM_NMUX, SIM_AOI3, SIM_OAI3, SIM_AOI4, SIM_OAI4
+	};
+
+	struct sim_cell_t {
+		sim_op_t op;
+		int a, b, c, d, y;
+	};
+
+	static const int sim_random_words = 8;
+
+	bool sim_ok;
+	std::vector<RTLIL::Cell*> cone_cells;
+	std::vector<sim_cell_t> sim_cells;
+	std::vector<int> sim_pi_slot, sim_out_slot;
+	std::vector<std::vector<uint64_t>> sim_pi_words, sim_out_sigs;
+	std::vector<uint64_t> sim_values;
+	int sim_cex_count;
+	uint64_t sim_rng;
+
 	int register_cone_worker(std::set<RTLIL::Cell*> &celldone, std::map<RTLIL::SigBit, int> &sigdepth, RTLIL::SigBit out)
 	{
 		if (out.wire == NULL)
@@ -259,7 +287,8 @@ struct PerformReduction
 
 		if (drivers.count(out) != 0) {
 			std::pair<RTLIL::Cell*, std::set<RTLIL::SigBit>> &drv = drivers.at(out);
-			if (celldone.count(drv.first) == 0) {
+			bool new_cell = celldone.count(drv.first) == 0;
+			if (new_cell) {
 				if (!satgen.importCell(drv.first))
 					log_error("Can't create SAT model for cell %s (%s)!\n", RTLIL::id2cstr(drv.first->name), RTLIL::id2cstr(drv.first->type));
 				celldone.insert(drv.first);
@@ -268,6 +297,8 @@ struct PerformReduction
 			for (auto &bit : drv.second)
 				max_child_depth = max(register_cone_worker(celldone, sigdepth, bit), max_child_depth);
 			sigdepth[out] = max_child_depth + 1;
+			if (new_cell)
+				cone_cells.push_back(drv.first);
 		} else {
 			pi_bits.push_back(out);
 			sat_pi.push_back(satgen.importSigSpec(out).front());
@@ -301,6 +332,158 @@ struct PerformReduction
 					sat_out[i] = ez->NOT(sat_out[i]);
 		} else
 			out_inverted = std::vector<bool>(sat_out.size(), false);
+
+		sim_ok = sim_mode && cone_size > 0;
+		if (sim_ok)
+			sim_setup();
+	}
+
+	int sim_slot(dict<RTLIL::SigBit, int> &slots, RTLIL::SigBit bit)
+	{
+		bit = sigmap(bit);
+		if (bit.wire == NULL) {
+			if (bit != RTLIL::State::S0 && bit != RTLIL::State::S1)
+				sim_ok = false;
+			return bit == RTLIL::State::S1 ? 1 : 0;
+		}
+		auto it = slots.find(bit);
+		if (it != slots.end())
+			return it->second;
+		int slot = GetSize(slots) + 2;
+		slots[bit] = slot;
+		return slot;
+	}
+
+	void sim_setup()
+	{
+		static const dict<RTLIL::IdString, sim_op_t> sim_ops = {
+			{ID($_BUF_), SIM_BUF}, {ID($_NOT_), SIM_NOT},
+			{ID($_AND_), SIM_AND}, {ID($_NAND_), SIM_NAND},
+			{ID($_OR_), SIM_OR}, {ID($_NOR_), SIM_NOR},
+			{ID($_XOR_), SIM_XOR}, {ID($_XNOR_), SIM_XNOR},
+			{ID($_ANDNOT_), SIM_ANDNOT}, {ID($_ORNOT_), SIM_ORNOT},
+			{ID($_MUX_), SIM_MUX}, {ID($_NMUX_), SIM_NMUX},
+			{ID($_AOI3_), SIM_AOI3}, {ID($_OAI3_), SIM_OAI3},
+			{ID($_AOI4_), SIM_AOI4}, {ID($_OAI4_), SIM_OAI4}
+		};
+
+		dict<RTLIL::SigBit, int> slots;
+
+		for (auto &bit : pi_bits)
+			sim_pi_slot.push_back(sim_slot(slots, bit));
+
+		for (auto cell : cone_cells) {
+			auto it = sim_ops.find(cell->type);
+			if (it == sim_ops.end()) {
+				sim_ok = false;
+				break;
+			}
+			sim_cell_t sc;
+			sc.op = it->second;
+			sc.a = sim_slot(slots, cell->getPort(ID::A));
+			sc.b = cell->hasPort(ID::B) ? sim_slot(slots, cell->getPort(ID::B)) : 0;
+			sc.c = cell->hasPort(ID::S) ? sim_slot(slots, cell->getPort(ID::S)) :
+					cell->hasPort(ID::C) ? sim_slot(slots, cell->getPort(ID::C)) : 0;
+			sc.d = cell->hasPort(ID::D) ? sim_slot(slots, cell->getPort(ID::D)) : 0;
+			sc.y = sim_slot(slots, cell->getPort(ID::Y));
+			sim_cells.push_back(sc);
+		}
+
+		for (auto &bit : out_bits)
+			sim_out_slot.push_back(sim_slot(slots, bit));
+
+		if (!sim_ok) {
+			if (verbose_level >= 1)
+				log("    Cone can't be simulated, using SAT solver only.\n");
+			return;
+		}
+
+		sim_values.resize(GetSize(slots) + 2);
+		sim_values[0] = 0;
+		sim_values[1] = ~uint64_t(0);
+		sim_out_sigs.resize(out_bits.size());
+		sim_cex_count = 0;
+		sim_rng = 88172645463325252ULL;
+
+		for (int i = 0; i < sim_random_words; i++) {
+			sim_pi_words.push_back(std::vector<uint64_t>(pi_bits.size()));
+			for (auto &v : sim_pi_words.back()) {
+				sim_rng ^= sim_rng << 13;
+				sim_rng ^= sim_rng >> 7;
+				sim_rng ^= sim_rng << 17;
+				v = sim_rng;
+			}
+			for (auto &sig : sim_out_sigs)
+				sig.push_back(0);
+			sim_word(i);
+		}
+	}
+
+	void sim_word(int word)
+	{
+		uint64_t *v = sim_values.data();
+
+		for (size_t i = 0; i < pi_bits.size(); i++)
+			v[sim_pi_slot[i]] = sim_pi_words[word][i];
+
+		for (auto &sc : sim_cells)
+			switch (sc.op) {
+			case SIM_BUF:    v[sc.y] = v[sc.a]; break;
+			case SIM_NOT:    v[sc.y] = ~v[sc.a]; break;
+			case SIM_AND:    v[sc.y] = v[sc.a] & v[sc.b]; break;
+			case SIM_NAND:   v[sc.y] = ~(v[sc.a] & v[sc.b]); break;
+			case SIM_OR:     v[sc.y] = v[sc.a] | v[sc.b]; break;
+			case SIM_NOR:    v[sc.y] = ~(v[sc.a] | v[sc.b]); break;
+			case SIM_XOR:    v[sc.y] = v[sc.a] ^ v[sc.b]; break;
+			case SIM_XNOR:   v[sc.y] = ~(v[sc.a] ^ v[sc.b]); break;
+			case SIM_ANDNOT: v[sc.y] = v[sc.a] & ~v[sc.b]; break;
+			case SIM_ORNOT:  v[sc.y] = v[sc.a] | ~v[sc.b]; break;
+			case SIM_MUX:    v[sc.y] = (v[sc.a] & ~v[sc.c]) | (v[sc.b] & v[sc.c]); break;
+			case SIM_NMUX:   v[sc.y] = ~((v[sc.a] & ~v[sc.c]) | (v[sc.b] & v[sc.c])); break;
+			case SIM_AOI3:   v[sc.y] = ~((v[sc.a] & v[sc.b]) | v[sc.c]); break;
+			case SIM_OAI3:   v[sc.y] = ~((v[sc.a] | v[sc.b]) & v[sc.c]); break;
+			case SIM_AOI4:   v[sc.y] = ~((v[sc.a] & v[sc.b]) | (v[sc.c] & v[sc.d])); break;
+			case SIM_OAI4:   v[sc.y] = ~((v[sc.a] | v[sc.b]) & (v[sc.c] | v[sc.d])); break;
+			}
+
+		for (size_t i = 0; i < out_bits.size(); i++)
+			sim_out_sigs[i][word] = out_inverted[i] ? ~v[sim_out_slot[i]] : v[sim_out_slot[i]];
+	}
+
+	// Record the input assignment of a SAT model as an additional simulation
+	// pattern, so that it also separates signals in buckets analyzed later.
+	void sim_add_model(const std::vector<bool> &model)
+	{
+		int bit = sim_cex_count++ % 64;
+		if (bit == 0) {
+			sim_pi_words.push_back(std::vector<uint64_t>(pi_bits.size()));
+			for (auto &sig : sim_out_sigs)
+				sig.push_back(0);
+		}
+
+		std::vector<uint64_t> &word = sim_pi_words.back();
+		for (size_t i = 0; i < pi_bits.size(); i++)
+			if (model[2*sat_out.size() + i])
+				word[i] |= uint64_t(1) << bit;
+
+		sim_word(GetSize(sim_pi_words) - 1);
+	}
+
+	bool sim_split(std::vector<std::set<int>> &results, std::map<int, int> &results_map, std::vector<int> &bucket, std::string indent1, std::string indent2)
+	{
+		std::map<std::vector<uint64_t>, std::vector<int>> sim_buckets;
+		for (int idx : bucket)
+			sim_buckets[sim_out_sigs[idx]].push_back(idx);
+
+		if (sim_buckets.size() == 1)
+			return false;
+
+		if (verbose_level >= 1)
+			log("%s  Simulation splits bucket with %d signals into %d buckets.\n", (indent1 + indent2).c_str(), int(bucket.size()), int(sim_buckets.size()));
+
+		for (auto &it : sim_buckets)
+			analyze(results, results_map, it.second, indent1 + "s", indent2 + "  ");
+		return true;
 	}
 
 	void analyze_const(std::vector<std::vector<equiv_bit_t>> &results, int idx)
@@ -355,6 +538,9 @@ struct PerformReduction
 		if (bucket.size() <= 1)
 			return;
 
+		if (sim_ok && sim_split(results, results_map, bucket, indent1, indent2))
+			return;
+
 		if (verbose_level == 1)
 			log("%s  Trying to shatter bucket with %d signals.\n", indt, int(bucket.size()));
 
@@ -375,7 +561,7 @@ struct PerformReduction
 		std::vector<bool> model;
 
 		modelVars.insert(modelVars.end(), sat_def.begin(), sat_def.end());
-		if (verbose_level >= 2)
+		if (verbose_level >= 2 || sim_ok)
 			modelVars.insert(modelVars.end(), sat_pi.begin(), sat_pi.end());
 
 		if (ez->solve(modelVars, model, ez->expression(ezSAT::OpOr, sat_set_list), ez->expression(ezSAT::OpOr, sat_clr_list)))
@@ -422,6 +608,9 @@ struct PerformReduction
 							out_inverted.at(idx) ? "~" : "", log_signal(out_bits[idx]));
 			}
 
+			if (sim_ok)
+				sim_add_model(model);
+
 			std::vector<int> buckets_a;
 			std::vector<int> buckets_b;
 
@@ -777,6 +966,11 @@ struct FreducePass : public Pass {
 		log("    -inv\n");
 		log("        enable explicit handling of inverted signals\n");
 		log("\n");
+		log("    -nosim\n");
+		log("        do not use bit-parallel simulation to split candidate groups before\n");
+		log("        calling the SAT solver. (simulation is only used for cones made of\n");
+		log("        simple gates, e.g. after 'techmap'.)\n");
+		log("\n");
 		log("    -stop <n>\n");
 		log("        stop after <n> reduction operations. this is mostly used for\n");
 		log("        debugging the freduce command itself.\n");
@@ -798,6 +992,7 @@ struct FreducePass : public Pass {
 		reduce_stop_at = 0;
 		verbose_level = 0;
 		inv_mode = false;
+		sim_mode = true;
 		dump_prefix = std::string();
 
 		log_header(design, "Executing FREDUCE pass (perform functional reduction).\n");
@@ -816,6 +1011,10 @@ struct FreducePass : public Pass {
 				inv_mode = true;
 				continue;
 			}
+			if (args[argidx] == "-nosim") {
+				sim_mode = false;
+				continue;
+			}
 			if (args[argidx] == "-stop" && argidx+1 < args.size()) {
 				reduce_stop_at = atoi(args[++argidx].c_str());
 				continue;
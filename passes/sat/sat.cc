@@ -64,6 +64,11 @@ struct SatHelper
 	SigSet<RTLIL::Cell*> show_drivers;
 	int max_timestep, timeout;
 	bool gotTimeout;
+	int64_t solve_ns;
+
+	// when set, the initial state constraints only hold when this literal is
+	// true, so that one solver can check both base case and induction step
+	int initstate_literal;
 
 	SatHelper(RTLIL::Design *design, RTLIL::Module *module, bool enable_undef, bool set_def_formal) :
 		design(design), module(module), sigmap(module), ct(design), satgen(ez.get(), &sigmap)
@@ -78,6 +83,8 @@ struct SatHelper
 		max_timestep = -1;
 		timeout = 0;
 		gotTimeout = false;
+		solve_ns = 0;
+		initstate_literal = 0;
 	}
 
 	void check_undef_enabled(const RTLIL::SigSpec &sig)
@@ -99,7 +106,7 @@ struct SatHelper
 			log ("\nSetting up SAT problem:\n");
 
 		if (initstate)
-			satgen.setInitState(timestep);
+			satgen.setInitState(timestep, initstate_literal ? initstate_literal : ezSAT::CONST_TRUE);
 
 		if (timestep > max_timestep)
 			max_timestep = timestep;
@@ -324,7 +331,7 @@ struct SatHelper
 			if (set_init_def) {
 				RTLIL::SigSpec rem = satgen.initial_state.export_all();
 				std::vector<int> undef_rem = satgen.importUndefSigSpec(rem, 1);
-				ez->assume(ez->NOT(ez->expression(ezSAT::OpOr, undef_rem)));
+				assume_init(ez->NOT(ez->expression(ezSAT::OpOr, undef_rem)));
 			}
 
 			if (set_init_undef) {
@@ -349,10 +356,17 @@ struct SatHelper
 
 			log("Final init constraint equation: %s = %s\n", log_signal(big_lhs), log_signal(big_rhs));
 			check_undef_enabled(big_lhs), check_undef_enabled(big_rhs);
-			ez->assume(satgen.signals_eq(big_lhs, big_rhs, timestep));
+			assume_init(satgen.signals_eq(big_lhs, big_rhs, timestep));
 		}
 	}
 
+	void assume_init(int expr)
+	{
+		if (initstate_literal)
+			expr = ez->OR(ez->NOT(initstate_literal), expr);
+		ez->assume(expr);
+	}
+
 	int setup_proof(int timestep = -1)
 	{
 		log_assert(prove.size() || prove_x.size() || prove_asserts);
@@ -445,7 +459,9 @@ struct SatHelper
 	{
 		log_assert(gotTimeout == false);
 		ez->setSolverTimeout(timeout);
+		int64_t begin_ns = PerformanceTimer::query();
 		bool success = ez->solve(modelExpressions, modelValues, assumptions);
+		solve_ns = PerformanceTimer::query() - begin_ns;
 		if (ez->getSolverTimoutStatus())
 			gotTimeout = true;
 		return success;
@@ -455,7 +471,9 @@ struct SatHelper
 	{
 		log_assert(gotTimeout == false);
 		ez->setSolverTimeout(timeout);
+		int64_t begin_ns = PerformanceTimer::query();
 		bool success = ez->solve(modelExpressions, modelValues, a, b, c, d, e, f);
+		solve_ns = PerformanceTimer::query() - begin_ns;
 		if (ez->getSolverTimoutStatus())
 			gotTimeout = true;
 		return success;
@@ -1012,6 +1030,10 @@ struct SatPass : public Pass {
 		log("        proven that the condition holds forever after the number of time steps\n");
 		log("        specified using -seq.\n");
 		log("\n");
+		log("        Without -seq and -set-at style options the base case and the\n");
+		log("        induction step are checked incrementally with one solver, adding one\n");
+		log("        time step per induction length.\n");
+		log("\n");
 		log("    -tempinduct-def\n");
 		log("        Perform a temporal induction proof. Assume an initial state with all\n");
 		log("        registers set to defined values for the induction step.\n");
@@ -1396,8 +1418,17 @@ struct SatPass : public Pass {
 			if (loopcount > 0 || max_undef)
 				log_cmd_error("The options -max, -all, and -max_undef are not supported for temporal induction proofs!\n");
 
+			// Without -seq and per-timestep constraints the base case for length N+1
+			// is the induction step for length N plus the initial state, so both
+			// are solved incrementally on one unrolling, with the initial state
+			// enabled by an activation literal.
+			bool shared_solver = seq_len == 0 && !tempinduct_baseonly && !tempinduct_inductonly &&
+					sets_at.empty() && unsets_at.empty() && sets_def_at.empty() &&
+					sets_any_undef_at.empty() && sets_all_undef_at.empty();
+
 			SatHelper basecase(design, module, enable_undef, set_def_formal);
-			SatHelper inductstep(design, module, enable_undef, set_def_formal);
+			SatHelper separate_inductstep(design, module, enable_undef, set_def_formal);
+			SatHelper &inductstep = shared_solver ? basecase : separate_inductstep;
 
 			basecase.sets = sets;
 			basecase.set_assumes = set_assumes;
@@ -1425,27 +1456,38 @@ struct SatPass : public Pass {
 				if (!tempinduct_inductonly)
 					basecase.setup(timestep, timestep == 1);
 
-			inductstep.sets = sets;
-			inductstep.set_assumes = set_assumes;
-			inductstep.prove = prove;
-			inductstep.prove_x = prove_x;
-			inductstep.prove_asserts = prove_asserts;
-			inductstep.shows = shows;
-			inductstep.timeout = timeout;
-			inductstep.sets_def = sets_def;
-			inductstep.sets_any_undef = sets_any_undef;
-			inductstep.sets_all_undef = sets_all_undef;
-			inductstep.satgen.ignore_div_by_zero = ignore_div_by_zero;
-			inductstep.ignore_unknown_cells = ignore_unknown_cells;
-
-			if (!tempinduct_baseonly) {
-				inductstep.setup(1);
-				inductstep.ez->assume(inductstep.setup_proof(1));
+			if (shared_solver)
+			{
+				basecase.initstate_literal = basecase.ez->frozen_literal();
+				basecase.setup(1, true);
+			}
+			else
+			{
+				inductstep.sets = sets;
+				inductstep.set_assumes = set_assumes;
+				inductstep.prove = prove;
+				inductstep.prove_x = prove_x;
+				inductstep.prove_asserts = prove_asserts;
+				inductstep.shows = shows;
+				inductstep.timeout = timeout;
+				inductstep.sets_def = sets_def;
+				inductstep.sets_any_undef = sets_any_undef;
+				inductstep.sets_all_undef = sets_all_undef;
+				inductstep.satgen.ignore_div_by_zero = ignore_div_by_zero;
+				inductstep.ignore_unknown_cells = ignore_unknown_cells;
+
+				if (!tempinduct_baseonly) {
+					inductstep.setup(1);
+					inductstep.ez->assume(inductstep.setup_proof(1));
+				}
 			}
 
 			if (tempinduct_def) {
 				std::vector<int> undef_state = inductstep.satgen.importUndefSigSpec(inductstep.satgen.initial_state.export_all(), 1);
-				inductstep.ez->assume(inductstep.ez->NOT(inductstep.ez->expression(ezSAT::OpOr, undef_state)));
+				int state_def = inductstep.ez->NOT(inductstep.ez->expression(ezSAT::OpOr, undef_state));
+				if (shared_solver)
+					state_def = inductstep.ez->OR(inductstep.initstate_literal, state_def);
+				inductstep.ez->assume(state_def);
 			}
 
 			for (int inductlen = 1; inductlen <= maxsteps || maxsteps == 0; inductlen++)
@@ -1456,7 +1498,9 @@ struct SatPass : public Pass {
 
 				if (!tempinduct_inductonly)
 				{
-					basecase.setup(seq_len + inductlen, seq_len + inductlen == 1);
+					// with a shared solver this time step was set up by the last induction step
+					if (seq_len + inductlen > basecase.max_timestep)
+						basecase.setup(seq_len + inductlen, seq_len + inductlen == 1);
 					int property = basecase.setup_proof(seq_len + inductlen);
 					basecase.generate_model();
 
@@ -1469,7 +1513,10 @@ struct SatPass : public Pass {
 								inductlen, basecase.ez->numCnfVariables(), basecase.ez->numCnfClauses());
 						log_flush();
 
-						if (basecase.solve(basecase.ez->NOT(property))) {
+						bool base_failed = basecase.solve(basecase.ez->NOT(property), basecase.initstate_literal);
+						log("[base case %d] Solver finished in %.2f seconds.\n", inductlen, basecase.solve_ns / 1e9);
+
+						if (base_failed) {
 							log("SAT temporal induction proof finished - model found for base case: FAIL!\n");
 							print_proof_failed();
 							basecase.print_model();
@@ -1519,7 +1566,9 @@ struct SatPass : public Pass {
 									inductlen, stepsize);
 						log("\n[induction step %d] Problem size so far: %d variables and %d clauses.\n",
 								inductlen, inductstep.ez->numCnfVariables(), inductstep.ez->numCnfClauses());
-						inductstep.ez->assume(property);
+						// with a shared solver the next base case still has to prove the property
+						if (!shared_solver)
+							inductstep.ez->assume(property);
 					}
 					else
 					{
@@ -1541,7 +1590,11 @@ struct SatPass : public Pass {
 								inductlen, inductstep.ez->numCnfVariables(), inductstep.ez->numCnfClauses());
 						log_flush();
 
-						if (!inductstep.solve(inductstep.ez->NOT(property))) {
+						bool induct_failed = inductstep.solve(inductstep.ez->NOT(property),
+								shared_solver ? inductstep.ez->NOT(inductstep.initstate_literal) : 0);
+						log("[induction step %d] Solver finished in %.2f seconds.\n", inductlen, inductstep.solve_ns / 1e9);
+
+						if (!induct_failed) {
 							if (inductstep.gotTimeout)
 								goto timeout;
 							log("Induction step proven: SUCCESS!\n");
@@ -1550,7 +1603,8 @@ struct SatPass : public Pass {
 						}
 
 						log("Induction step failed. Incrementing induction length.\n");
-						inductstep.ez->assume(property);
+						if (!shared_solver)
+							inductstep.ez->assume(property);
 						inductstep.print_model();
 					}
 				}
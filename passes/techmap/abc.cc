@@ -48,6 +48,7 @@
 #include "kernel/ff.h"
 #include "kernel/cost.h"
 #include "kernel/log.h"
+#include "kernel/trace.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -2049,6 +2050,8 @@ struct AbcPass : public Pass {
 				continue;
 			}
 
+			TraceSpan span("abc", "module", mod);
+
 			assign_map.set(mod);
 			initvals.set(&assign_map, mod);
 
@@ -30,7 +30,7 @@ pool<Cell*> get_other_cells(const RTLIL::SigSpec& port, ModIndex& index, Cell* s
 	pool<Cell*> rval;
 	for(auto b : port)
 	{
-		pool<ModIndex::PortInfo> ports = index.query_ports(b);
+		const auto &ports = index.query_ports(b);
 		for(auto x : ports)
 		{
 			if(x.cell == src)
@@ -54,7 +54,7 @@ bool is_full_bus(
 {
 	for(auto s : sig)
 	{
-		pool<ModIndex::PortInfo> ports = index.query_ports(s);
+		const auto &ports = index.query_ports(s);
 		bool found_a = false;
 		bool found_b = false;
 		for(auto x : ports)
@@ -79,7 +79,7 @@ bool is_unconnected(const RTLIL::SigSpec& port, ModIndex& index)
 {
 	for(auto b : port)
 	{
-		pool<ModIndex::PortInfo> ports = index.query_ports(b);
+		const auto &ports = index.query_ports(b);
 		if(ports.size() > 1)
 			return false;
 	}
@@ -427,7 +427,7 @@ int counter_tryextract(
 			//TODO: For what purpose do we actually need extract.pouts?
 			for(auto b : qport)
 			{
-				pool<ModIndex::PortInfo> ports = index.query_ports(b);
+				const auto &ports = index.query_ports(b);
 				for(auto x : ports)
 				{
 					if(x.cell != c)
@@ -94,6 +94,11 @@
 // constituent gates), `lut_edges_fw` and `lut_edges_bw` fields. The `inputs` and `outputs` fields are shared with the gate IR.
 //
 // We call this IR "LUT IR".
+//
+// 3. Labeling computes a max-flow for the fan-in cone of every node, which makes it by far the hottest part of the pass. For this reason,
+// the gate IR is also laid out as dense arrays indexed by node number (`node_list`, `preds` and `succs` in CSR form, and `node_labels`)
+// while labeling, and FlowGraph numbers its nodes and edges densely as well. The results are written back to `labels`, `lut_gates`,
+// `lut_edges_fw` and `lut_edges_bw` in the same order as the set-based implementation would produce them.
 
 #include "kernel/yosys.h"
 #include "kernel/sigtools.h"
@@ -190,35 +195,108 @@ static void dump_dot_graph(string filename,
 
 struct FlowGraph
 {
-	const RTLIL::SigBit source;
-	RTLIL::SigBit sink;
-	pool<RTLIL::SigBit> nodes = {source};
-	dict<RTLIL::SigBit, pool<RTLIL::SigBit>> edges_fw, edges_bw;
+	// Nodes are numbered densely in the order they were added, with the source always being node 0 and the sink being node 1.
+	// Edges are numbered densely as well, and adjacency is stored in CSR form as ranges of edge numbers, so that the flow of
+	// an edge can be found without a lookup from either of its endpoints.
+	const int source = 0;
+	const int sink = 1;
+	vector<RTLIL::SigBit> nodes = {RTLIL::SigBit()};
+	vector<int> edge_from, edge_to;
+	vector<int> fw_offsets, fw_edges;
+	vector<int> bw_offsets, bw_edges;
 
 	const int MAX_NODE_FLOW = 1;
-	dict<RTLIL::SigBit, int> node_flow;
-	dict<pair<RTLIL::SigBit, RTLIL::SigBit>, int> edge_flow;
+	vector<int> node_flow;
+	vector<int> edge_flow;
+
+	pool<RTLIL::SigBit> collapsed; // into the sink
+
+	int add_node(RTLIL::SigBit node)
+	{
+		nodes.push_back(node);
+		return GetSize(nodes) - 1;
+	}
+
+	void add_edge(int from, int to)
+	{
+		edge_from.push_back(from);
+		edge_to.push_back(to);
+	}
+
+	void finalize()
+	{
+		vector<pair<int, int>> edges;
+		for (int i = 0; i < GetSize(edge_from); i++)
+			edges.push_back({edge_from[i], edge_to[i]});
+		std::sort(edges.begin(), edges.end());
+		edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+		int num_nodes = GetSize(nodes), num_edges = GetSize(edges);
+		edge_from.resize(num_edges);
+		edge_to.resize(num_edges);
+		fw_offsets.assign(num_nodes + 1, 0);
+		bw_offsets.assign(num_nodes + 1, 0);
+		for (int i = 0; i < num_edges; i++)
+		{
+			edge_from[i] = edges[i].first;
+			edge_to[i] = edges[i].second;
+			fw_offsets[edge_from[i] + 1]++;
+			bw_offsets[edge_to[i] + 1]++;
+		}
+		for (int i = 0; i < num_nodes; i++)
+		{
+			fw_offsets[i + 1] += fw_offsets[i];
+			bw_offsets[i + 1] += bw_offsets[i];
+		}
 
-	dict<RTLIL::SigBit, pool<RTLIL::SigBit>> collapsed;
+		// Edges are sorted by their source node already, so only the backward edges need to be bucketed.
+		fw_edges.resize(num_edges);
+		bw_edges.resize(num_edges);
+		vector<int> bw_fill(bw_offsets.begin(), bw_offsets.end() - 1);
+		for (int i = 0; i < num_edges; i++)
+		{
+			fw_edges[i] = i;
+			bw_edges[bw_fill[edge_to[i]]++] = i;
+		}
+
+		node_flow.assign(num_nodes, 0);
+		edge_flow.assign(num_edges, 0);
+	}
 
 	void dump_dot_graph(string filename)
 	{
+		pool<RTLIL::SigBit> node_bits;
+		dict<RTLIL::SigBit, pool<RTLIL::SigBit>> edge_bits;
+		dict<RTLIL::SigBit, int> node_bit_flow;
+		dict<pair<RTLIL::SigBit, RTLIL::SigBit>, int> edge_bit_flow;
+		for (int node = 0; node < GetSize(nodes); node++)
+		{
+			node_bits.insert(nodes[node]);
+			node_bit_flow[nodes[node]] = node_flow[node];
+		}
+		for (int edge = 0; edge < GetSize(edge_from); edge++)
+		{
+			edge_bits[nodes[edge_from[edge]]].insert(nodes[edge_to[edge]]);
+			edge_bit_flow[{nodes[edge_from[edge]], nodes[edge_to[edge]]}] = edge_flow[edge];
+		}
+
 		auto node_style = [&](RTLIL::SigBit node) {
-			string label = (node == source) ? "(source)" : log_signal(node);
-			for (auto collapsed_node : collapsed[node])
-				label += stringf(" %s", log_signal(collapsed_node));
-			int flow = node_flow[node];
-			if (node != source && node != sink)
+			string label = (node == nodes[source]) ? "(source)" : log_signal(node);
+			if (node == nodes[sink])
+				for (auto collapsed_node : collapsed)
+					label += stringf(" %s", log_signal(collapsed_node));
+			int flow = node_bit_flow[node];
+			if (node != nodes[source] && node != nodes[sink])
 				label += stringf("\n%d/%d", flow, MAX_NODE_FLOW);
 			else
 				label += stringf("\n%d/∞", flow);
 			return GraphStyle{label, flow < MAX_NODE_FLOW ? "green" : "black"};
 		};
 		auto edge_style = [&](RTLIL::SigBit source, RTLIL::SigBit sink) {
-			int flow = edge_flow[{source, sink}];
+			int flow = edge_bit_flow[{source, sink}];
 			return GraphStyle{stringf("%d/∞", flow), flow > 0 ? "blue" : "black"};
 		};
-		::dump_dot_graph(filename, nodes, edges_fw, {source}, {sink}, node_style, edge_style);
+		::dump_dot_graph(filename, node_bits, edge_bits, {nodes[source]}, {nodes[sink]}, node_style, edge_style);
 	}
 
 	// Here, we are working on the Nt'' network, but our representation is the Nt' network.
@@ -232,81 +310,55 @@ struct FlowGraph
 	//
 	// To address this, we split each node v into two nodes, v't and v'b. This representation is virtual,
 	// in the sense that nodes v't and v'b are overlaid on top of the original node v, and only exist
-	// in paths and worklists.
+	// in paths and worklists, where node v't is numbered 2*v and node v'b is numbered 2*v+1.
 
-	struct NodePrime
+	static int top(int node)
 	{
-		RTLIL::SigBit node;
-		bool is_bottom;
-
-		NodePrime(RTLIL::SigBit node, bool is_bottom) :
-			node(node), is_bottom(is_bottom) {}
-
-		bool operator==(const NodePrime &other) const
-		{
-			return node == other.node && is_bottom == other.is_bottom;
-		}
-		bool operator!=(const NodePrime &other) const
-		{
-			return !(*this == other);
-		}
-		[[nodiscard]] Hasher hash_into(Hasher h) const
-		{
-			std::pair<RTLIL::SigBit, int> p = {node, is_bottom};
-			h.eat(p);
-			return h;
-		}
-
-		static NodePrime top(RTLIL::SigBit node)
-		{
-			return NodePrime(node, /*is_bottom=*/false);
-		}
-
-		static NodePrime bottom(RTLIL::SigBit node)
-		{
-			return NodePrime(node, /*is_bottom=*/true);
-		}
+		return node << 1;
+	}
 
-		NodePrime as_top() const
-		{
-			log_assert(is_bottom);
-			return top(node);
-		}
+	static int bottom(int node)
+	{
+		return (node << 1) | 1;
+	}
 
-		NodePrime as_bottom() const
-		{
-			log_assert(!is_bottom);
-			return bottom(node);
-		}
-	};
+	static bool is_bottom(int node_prime)
+	{
+		return node_prime & 1;
+	}
 
 	bool find_augmenting_path(bool commit)
 	{
-		NodePrime source_prime = {source, true};
-		NodePrime sink_prime = {sink, false};
-		vector<NodePrime> path = {source_prime};
-		pool<NodePrime> visited = {};
+		int source_prime = bottom(source);
+		int sink_prime = top(sink);
+		// For each node in the path, the edge that was traversed to reach it, or -1 if the path went through the node itself.
+		vector<int> path = {source_prime}, path_edges = {-1};
+		vector<bool> visited(2 * nodes.size());
 		bool found;
 		do {
 			found = false;
 
-			auto node_prime = path.back();
-			visited.insert(node_prime);
+			int node_prime = path.back();
+			int node = node_prime >> 1;
+			visited[node_prime] = true;
 
-			if (!node_prime.is_bottom) // vt
+			if (!is_bottom(node_prime)) // vt
 			{
-				if (!visited[node_prime.as_bottom()] && node_flow[node_prime.node] < MAX_NODE_FLOW)
+				if (!visited[bottom(node)] && node_flow[node] < MAX_NODE_FLOW)
 				{
-					path.push_back(node_prime.as_bottom());
+					path.push_back(bottom(node));
+					path_edges.push_back(-1);
 					found = true;
 				}
 				else
 				{
-					for (auto node_pred : edges_bw[node_prime.node])
+					for (int i = bw_offsets[node]; i < bw_offsets[node + 1]; i++)
 					{
-						if (!visited[NodePrime::bottom(node_pred)] && edge_flow[{node_pred, node_prime.node}] > 0)
+						int edge = bw_edges[i];
+						if (!visited[bottom(edge_from[edge])] && edge_flow[edge] > 0)
 						{
-							path.push_back(NodePrime::bottom(node_pred));
+							path.push_back(bottom(edge_from[edge]));
+							path_edges.push_back(edge);
 							found = true;
 							break;
 						}
@@ -315,18 +367,21 @@ struct FlowGraph
 			}
 			else // vb
 			{
-				if (!visited[node_prime.as_top()] && node_flow[node_prime.node] > 0)
+				if (!visited[top(node)] && node_flow[node] > 0)
 				{
-					path.push_back(node_prime.as_top());
+					path.push_back(top(node));
+					path_edges.push_back(-1);
 					found = true;
 				}
 				else
 				{
-					for (auto node_succ : edges_fw[node_prime.node])
+					for (int i = fw_offsets[node]; i < fw_offsets[node + 1]; i++)
 					{
-						if (!visited[NodePrime::top(node_succ)] /* && edge_flow[...] < ∞ */)
+						int edge = fw_edges[i];
+						if (!visited[top(edge_to[edge])] /* && edge_flow[...] < ∞ */)
 						{
-							path.push_back(NodePrime::top(node_succ));
+							path.push_back(top(edge_to[edge]));
+							path_edges.push_back(edge);
 							found = true;
 							break;
 						}
@@ -337,23 +392,21 @@ struct FlowGraph
 			if (!found && path.size() > 1)
 			{
 				path.pop_back();
+				path_edges.pop_back();
 				found = true;
 			}
 		} while(path.back() != sink_prime && found);
 
 		if (commit && path.back() == sink_prime)
 		{
-			auto prev_prime = path.front();
-			for (auto node_prime : path)
+			for (int i = 1; i < GetSize(path); i++)
 			{
-				if (node_prime == source_prime)
-					continue;
-
-				log_assert(prev_prime.is_bottom ^ node_prime.is_bottom);
-				if (prev_prime.node == node_prime.node)
+				int prev_prime = path[i - 1], node_prime = path[i];
+				log_assert(is_bottom(prev_prime) ^ is_bottom(node_prime));
+				if (path_edges[i] == -1)
 				{
-					auto node = node_prime.node;
-					if (!prev_prime.is_bottom && node_prime.is_bottom)
+					int node = node_prime >> 1;
+					if (!is_bottom(prev_prime) && is_bottom(node_prime))
 					{
 						log_assert(node_flow[node] == 0);
 						node_flow[node]++;
@@ -366,18 +419,18 @@ struct FlowGraph
 				}
 				else
 				{
-					if (prev_prime.is_bottom && !node_prime.is_bottom)
+					int edge = path_edges[i];
+					if (is_bottom(prev_prime) && !is_bottom(node_prime))
 					{
 						log_assert(true /* edge_flow[...] < ∞ */);
-						edge_flow[{prev_prime.node, node_prime.node}]++;
+						edge_flow[edge]++;
 					}
 					else
 					{
-						log_assert((edge_flow[{node_prime.node, prev_prime.node}] > 0));
-						edge_flow[{node_prime.node, prev_prime.node}]--;
+						log_assert(edge_flow[edge] > 0);
+						edge_flow[edge]--;
 					}
 				}
-				prev_prime = node_prime;
 			}
 
 			node_flow[source]++;
@@ -394,53 +447,54 @@ struct FlowGraph
 		return flow + find_augmenting_path(/*commit=*/false);
 	}
 
-	pair<pool<RTLIL::SigBit>, pool<RTLIL::SigBit>> edge_cut()
+	// Returns X as a node mask and X̅ as a set of wire bits, which includes all of the nodes collapsed into the sink.
+	pair<vector<bool>, pool<RTLIL::SigBit>> edge_cut()
 	{
-		pool<RTLIL::SigBit> x = {source}, xi; // X and X̅ in the paper
+		vector<bool> x(nodes.size()); // X in the paper
+		pool<RTLIL::SigBit> xi;       // X̅ in the paper
+		x[source] = true;
 
-		NodePrime source_prime = {source, true};
-		pool<NodePrime> visited;
-		vector<NodePrime> worklist = {source_prime};
+		vector<bool> visited(2 * nodes.size());
+		vector<int> worklist = {bottom(source)};
 		while (!worklist.empty())
 		{
-			auto node_prime = worklist.back();
+			int node_prime = worklist.back();
+			int node = node_prime >> 1;
 			worklist.pop_back();
 			if (visited[node_prime])
 				continue;
-			visited.insert(node_prime);
-
-			if (!node_prime.is_bottom)
-				x.insert(node_prime.node);
+			visited[node_prime] = true;
 
 			// Mincut is constructed by traversing a graph in an undirected way along forward edges that aren't full, or backward edges
 			// that aren't empty.
-			if (!node_prime.is_bottom) // top
+			if (!is_bottom(node_prime)) // top
 			{
-				if (node_flow[node_prime.node] < MAX_NODE_FLOW)
-					worklist.push_back(node_prime.as_bottom());
-				for (auto node_pred : edges_bw[node_prime.node])
-					if (edge_flow[{node_pred, node_prime.node}] > 0)
-						worklist.push_back(NodePrime::bottom(node_pred));
+				x[node] = true;
+				if (node_flow[node] < MAX_NODE_FLOW)
+					worklist.push_back(bottom(node));
+				for (int i = bw_offsets[node]; i < bw_offsets[node + 1]; i++)
+					if (edge_flow[bw_edges[i]] > 0)
+						worklist.push_back(bottom(edge_from[bw_edges[i]]));
 			}
 			else // bottom
 			{
-				if (node_flow[node_prime.node] > 0)
-					worklist.push_back(node_prime.as_top());
-				for (auto node_succ : edges_fw[node_prime.node])
+				if (node_flow[node] > 0)
+					worklist.push_back(top(node));
+				for (int i = fw_offsets[node]; i < fw_offsets[node + 1]; i++)
 					if (true /* edge_flow[...] < ∞ */)
-						worklist.push_back(NodePrime::top(node_succ));
+						worklist.push_back(top(edge_to[fw_edges[i]]));
 			}
 		}
 
-		for (auto node : nodes)
+		for (int node = GetSize(nodes) - 1; node >= 0; node--)
 			if (!x[node])
-				xi.insert(node);
+				xi.insert(nodes[node]);
 
-		for (auto collapsed_node : collapsed[sink])
+		for (auto collapsed_node : collapsed)
 			xi.insert(collapsed_node);
 
-		log_assert(x[source] && !xi[source]);
-		log_assert(!x[sink] && xi[sink]);
+		log_assert(x[source] && !xi[nodes[source]]);
+		log_assert(!x[sink] && xi[nodes[sink]]);
 		return {x, xi};
 	}
 };
@@ -462,6 +516,15 @@ struct FlowmapWorker
 	dict<RTLIL::SigBit, pool<RTLIL::SigBit>> edges_fw, edges_bw;
 	dict<RTLIL::SigBit, int> labels;
 
+	// Dense view of the gate IR, used for labeling
+	vector<RTLIL::SigBit> node_list;
+	dict<RTLIL::SigBit, int> node_ids;
+	vector<int> preds_offsets, preds, succs_offsets, succs;
+	vector<int> node_labels;
+	vector<bool> node_is_input;
+	vector<int> visit_marks, flow_marks, flow_ids;
+	int flow_stamp = 0;
+
 	// LUT IR
 	pool<RTLIL::SigBit> lut_nodes;
 	dict<RTLIL::SigBit, pool<RTLIL::SigBit>> lut_gates;
@@ -551,42 +614,53 @@ struct FlowmapWorker
 		return subgraph;
 	}
 
-	FlowGraph build_flow_graph(RTLIL::SigBit sink, int p)
+	FlowGraph build_flow_graph(int sink, int p)
 	{
 		FlowGraph flow_graph;
-		flow_graph.sink = sink;
+		flow_stamp++;
 
-		pool<RTLIL::SigBit> worklist = {sink}, visited;
+		// Nodes labeled p are collapsed into the sink. Edges are recorded in terms of gate IR node ids (with -1 standing for
+		// the source) until every node of the cone has been added to the flow graph, which happens when it is visited.
+		auto collapse = [&](int node) {
+			return node_labels[node] == p ? sink : node;
+		};
+		vector<pair<int, int>> edges;
+
+		pool<int> worklist = {sink};
 		while (!worklist.empty())
 		{
-			auto node = worklist.pop();
-			visited.insert(node);
+			int node = worklist.pop();
+			visit_marks[node] = flow_stamp;
 
-			auto collapsed_node = labels[node] == p ? sink : node;
+			int collapsed_node = collapse(node);
 			if (node != collapsed_node)
-				flow_graph.collapsed[collapsed_node].insert(node);
-			flow_graph.nodes.insert(collapsed_node);
+				flow_graph.collapsed.insert(node_list[node]);
+			if (flow_marks[collapsed_node] != flow_stamp)
+			{
+				flow_marks[collapsed_node] = flow_stamp;
+				flow_ids[collapsed_node] = flow_graph.add_node(node_list[collapsed_node]);
+			}
 
-			for (auto node_pred : edges_bw[node])
+			for (int i = preds_offsets[node]; i < preds_offsets[node + 1]; i++)
 			{
-				auto collapsed_node_pred = labels[node_pred] == p ? sink : node_pred;
+				int node_pred = preds[i];
+				int collapsed_node_pred = collapse(node_pred);
 				if (node_pred != collapsed_node_pred)
-					flow_graph.collapsed[collapsed_node_pred].insert(node_pred);
+					flow_graph.collapsed.insert(node_list[node_pred]);
 				if (collapsed_node != collapsed_node_pred)
-				{
-					flow_graph.edges_bw[collapsed_node].insert(collapsed_node_pred);
-					flow_graph.edges_fw[collapsed_node_pred].insert(collapsed_node);
-				}
-				if (inputs[node_pred])
-				{
-					flow_graph.edges_bw[collapsed_node_pred].insert(flow_graph.source);
-					flow_graph.edges_fw[flow_graph.source].insert(collapsed_node_pred);
-				}
+					edges.push_back({collapsed_node_pred, collapsed_node});
+				if (node_is_input[node_pred])
+					edges.push_back({-1, collapsed_node_pred});
 
-				if (!visited[node_pred])
+				if (visit_marks[node_pred] != flow_stamp)
 					worklist.insert(node_pred);
 			}
 		}
+
+		log_assert(flow_ids[sink] == flow_graph.sink);
+		for (auto edge : edges)
+			flow_graph.add_edge(edge.first == -1 ? flow_graph.source : flow_ids[edge.first], flow_ids[edge.second]);
+		flow_graph.finalize();
 		return flow_graph;
 	}
 
@@ -671,82 +745,121 @@ struct FlowmapWorker
 	void label_nodes()
 	{
 		for (auto node : nodes)
-			labels[node] = -1;
+		{
+			node_ids[node] = GetSize(node_list);
+			node_list.push_back(node);
+		}
+
+		int num_nodes = GetSize(node_list);
+		preds_offsets = {0};
+		succs_offsets = {0};
+		for (auto node : node_list)
+		{
+			for (auto node_pred : edges_bw[node])
+				preds.push_back(node_ids.at(node_pred));
+			preds_offsets.push_back(GetSize(preds));
+			for (auto node_succ : edges_fw[node])
+				succs.push_back(node_ids.at(node_succ));
+			succs_offsets.push_back(GetSize(succs));
+		}
+
+		node_labels.assign(num_nodes, -1);
+		node_is_input.assign(num_nodes, false);
 		for (auto input : inputs)
 		{
+			int input_id = node_ids.at(input);
+			node_is_input[input_id] = true;
 			if (input.wire->attributes.count(ID($flowmap_level)))
-				labels[input] = input.wire->attributes[ID($flowmap_level)].as_int();
+				node_labels[input_id] = input.wire->attributes[ID($flowmap_level)].as_int();
 			else
-				labels[input] = 0;
+				node_labels[input_id] = 0;
 		}
 
-		pool<RTLIL::SigBit> worklist = nodes;
+		visit_marks.assign(num_nodes, 0);
+		flow_marks.assign(num_nodes, 0);
+		flow_ids.assign(num_nodes, -1);
+
+		// Visit the nodes in the same order as the `nodes` pool would be popped in.
+		pool<int> worklist;
+		for (int node = num_nodes - 1; node >= 0; node--)
+			worklist.insert(node);
 		int debug_num = 0;
 		while (!worklist.empty())
 		{
-			auto sink = worklist.pop();
-			if (labels[sink] != -1)
+			int sink = worklist.pop();
+			if (node_labels[sink] != -1)
 				continue;
 
+			// Labels never decrease along edges, so the maximum label in the fan-in cone of the sink is the maximum label
+			// among its immediate predecessors, and there is no need to walk the whole cone.
 			bool inputs_have_labels = true;
-			for (auto sink_input : edges_bw[sink])
+			int p = 1;
+			for (int i = preds_offsets[sink]; i < preds_offsets[sink + 1]; i++)
 			{
-				if (labels[sink_input] == -1)
+				if (node_labels[preds[i]] == -1)
 				{
 					inputs_have_labels = false;
 					break;
 				}
+				p = max(p, node_labels[preds[i]]);
 			}
 			if (!inputs_have_labels)
 				continue;
 
+			RTLIL::SigBit sink_bit = node_list[sink];
 			if (debug)
 			{
 				debug_num++;
-				log("Examining subgraph %d rooted in %s.\n", debug_num, log_signal(sink));
+				log("Examining subgraph %d rooted in %s.\n", debug_num, log_signal(sink_bit));
 			}
 
-			pool<RTLIL::SigBit> subgraph = find_subgraph(sink);
-
-			int p = 1;
-			for (auto subgraph_node : subgraph)
-				p = max(p, labels[subgraph_node]);
-
 			FlowGraph flow_graph = build_flow_graph(sink, p);
 			int flow = flow_graph.maximum_flow(order);
-			pool<RTLIL::SigBit> x, xi;
+			vector<bool> x;
+			pool<RTLIL::SigBit> xi;
 			if (flow <= order)
 			{
-				labels[sink] = p;
+				node_labels[sink] = p;
 				auto cut = flow_graph.edge_cut();
 				x = cut.first;
 				xi = cut.second;
 			}
 			else
 			{
-				labels[sink] = p + 1;
-				x = subgraph;
-				x.erase(sink);
-				xi.insert(sink);
+				node_labels[sink] = p + 1;
+				xi.insert(sink_bit);
 			}
-			lut_gates[sink] = xi;
+			lut_gates[sink_bit] = xi;
+
+			// When the cone is not K-feasible, X is the whole cone except for the sink, and so the LUT inputs are exactly
+			// the predecessors of the sink.
+			auto in_x = [&](int node) {
+				if (flow > order)
+					return node != sink;
+				return flow_marks[node] == flow_stamp && x[flow_ids[node]];
+			};
 
 			pool<RTLIL::SigBit> k;
 			for (auto xi_node : xi)
 			{
-				for (auto xi_node_pred : edges_bw[xi_node])
-					if (x[xi_node_pred])
-						k.insert(xi_node_pred);
+				int xi_node_id = node_ids.at(xi_node);
+				for (int i = preds_offsets[xi_node_id]; i < preds_offsets[xi_node_id + 1]; i++)
+					if (in_x(preds[i]))
+						k.insert(node_list[preds[i]]);
 			}
 			log_assert((int)k.size() <= order);
-			lut_edges_bw[sink] = k;
+			lut_edges_bw[sink_bit] = k;
 			for (auto k_node : k)
-				lut_edges_fw[k_node].insert(sink);
+				lut_edges_fw[k_node].insert(sink_bit);
 
 			if (debug)
 			{
-				log("  Maximum flow: %d. Assigned label %d.\n", flow, labels[sink]);
-				dump_dot_graph(stringf("flowmap-%d-sub.dot", debug_num), GraphMode::Cut, subgraph, {}, {}, {x, xi});
+				pool<RTLIL::SigBit> subgraph = find_subgraph(sink_bit), x_bits;
+				for (auto subgraph_node : subgraph)
+					if (in_x(node_ids.at(subgraph_node)))
+						x_bits.insert(subgraph_node);
+				log("  Maximum flow: %d. Assigned label %d.\n", flow, node_labels[sink]);
+				dump_dot_graph(stringf("flowmap-%d-sub.dot", debug_num), GraphMode::Cut, subgraph, {}, {}, {x_bits, xi});
 				log("  Dumped subgraph to `flowmap-%d-sub.dot`.\n", debug_num);
 				flow_graph.dump_dot_graph(stringf("flowmap-%d-flow.dot", debug_num));
 				log("  Dumped flow graph to `flowmap-%d-flow.dot`.\n", debug_num);
@@ -760,10 +873,13 @@ struct FlowmapWorker
 				log(".\n");
 			}
 
-			for (auto sink_succ : edges_fw[sink])
-				worklist.insert(sink_succ);
+			for (int i = succs_offsets[sink]; i < succs_offsets[sink + 1]; i++)
+				worklist.insert(succs[i]);
 		}
 
+		for (int node = 0; node < num_nodes; node++)
+			labels[node_list[node]] = node_labels[node];
+
 		if (debug)
 		{
 			dump_dot_graph("flowmap-labeled.dot", GraphMode::Label);
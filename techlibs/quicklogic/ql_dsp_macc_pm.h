@@ -34,6 +34,41 @@ struct ql_dsp_macc_pm {
   dict<Cell*,int> rollback_cache;
   int rollback;
 
+  struct monitor_t : RTLIL::Monitor {
+    ql_dsp_macc_pm *pm;
+    monitor_t(ql_dsp_macc_pm *pm) : pm(pm) { }
+    void notify_connect(Cell *cell, const IdString &portname, const SigSpec &old_sig, const SigSpec &sig) override {
+      pm->released_sigs[cell].append(old_sig);
+      pm->changed_sigs.append(old_sig);
+      pm->changed_sigs.append(sig);
+      // Module::remove() disconnects all ports before deleting the cell
+      if (sig.empty() && GetSize(cell->connections_) == 1 && cell->connections_.count(portname))
+        pm->forget_cell(cell);
+      else
+        pm->changed_cells.insert(cell);
+    }
+    void notify_connect(Module*, const SigSig &sigsig) override { pm->connected_sigs.push_back(sigsig); }
+    void notify_connect(Module*, const vector<SigSig>&) override { pm->rebuild_needed = true; }
+    void notify_blackout(Module*) override { pm->rebuild_needed = true; }
+  } monitor{this};
+
+  bool tracking = false;
+  bool rebuild_needed = false;
+  std::function<bool(Cell*)> track_filter;
+  pool<Cell*> changed_cells;
+  pool<Cell*, hashlib::hash_ptr_ops> removed_cells;
+  dict<Cell*, SigSpec> released_sigs;
+  vector<SigSig> connected_sigs;
+  SigSpec changed_sigs;
+  dict<Cell*, vector<index_1_key_type>> index_1_keys;
+  vector<index_1_key_type> index_1_stale_keys;
+  dict<Cell*, vector<index_3_key_type>> index_3_keys;
+  vector<index_3_key_type> index_3_stale_keys;
+  dict<Cell*, vector<index_4_key_type>> index_4_keys;
+  vector<index_4_key_type> index_4_stale_keys;
+  dict<Cell*, vector<index_5_key_type>> index_5_keys;
+  vector<index_5_key_type> index_5_stale_keys;
+
   struct state_ql_dsp_macc_t {
     Cell* add;
     IdString add_ba;
@@ -127,67 +162,318 @@ struct ql_dsp_macc_pm {
   void setup(const vector<Cell*> &cells) {
     log_assert(!setup_done);
     setup_done = true;
+    init_sigusers();
+    for (auto cell : cells)
+      index_cell(cell);
+  }
+
+  void init_sigusers() {
     for (auto port : module->ports)
       add_siguser(module->wire(port), nullptr);
     for (auto cell : module->cells())
       for (auto &conn : cell->connections())
         add_siguser(conn.second, cell);
-    for (auto cell : cells) {
-      do {
-        Cell *mul = cell;
-        index_1_value_type value;
-        std::get<0>(value) = cell;
-        if (!(mul->type.in(id_d_mul))) continue;
-        if (!(nusers(port(mul, id_b_Y)) <= 3)) continue;
-        index_1_key_type key;
-        index_1[key].push_back(value);
-      } while (0);
-      do {
-        Cell *add = cell;
-        index_3_value_type value;
-        std::get<0>(value) = cell;
-        if (!(add->type.in(id_d_add, id_d_sub))) continue;
-        vector<IdString> _pmg_choices_AB = {id_b_A, id_b_B};
-        for (const IdString &AB : _pmg_choices_AB) {
-        std::get<1>(value) = AB;
-        IdString &BA = std::get<2>(value);
-        BA = (AB == id_b_A ? id_b_B : id_b_A);
-        index_3_key_type key;
-        std::get<0>(key) = port(add, AB);
-        index_3[key].push_back(value);
+  }
+
+  void index_cell(Cell *cell) {
+    do {
+      Cell *mul = cell;
+      index_1_value_type value;
+      std::get<0>(value) = cell;
+      if (!(mul->type.in(id_d_mul))) continue;
+      if (!(nusers(port(mul, id_b_Y)) <= 3)) continue;
+      index_1_key_type key;
+      index_1[key].push_back(value);
+      if (tracking)
+        index_1_keys[cell].push_back(key);
+    } while (0);
+    do {
+      Cell *add = cell;
+      index_3_value_type value;
+      std::get<0>(value) = cell;
+      if (!(add->type.in(id_d_add, id_d_sub))) continue;
+      vector<IdString> _pmg_choices_AB = {id_b_A, id_b_B};
+      for (const IdString &AB : _pmg_choices_AB) {
+      std::get<1>(value) = AB;
+      IdString &BA = std::get<2>(value);
+      BA = (AB == id_b_A ? id_b_B : id_b_A);
+      index_3_key_type key;
+      std::get<0>(key) = port(add, AB);
+      index_3[key].push_back(value);
+      if (tracking)
+        index_3_keys[cell].push_back(key);
+      }
+    } while (0);
+    do {
+      Cell *mux = cell;
+      index_4_value_type value;
+      std::get<0>(value) = cell;
+      if (!(mux->type.in(id_d_mux))) continue;
+      vector<IdString> _pmg_choices_AB = {id_b_A, id_b_B};
+      for (const IdString &AB : _pmg_choices_AB) {
+      std::get<1>(value) = AB;
+      IdString &BA = std::get<2>(value);
+      BA = (AB == id_b_A ? id_b_B : id_b_A);
+      index_4_key_type key;
+      std::get<0>(key) = port(mux, AB);
+      std::get<1>(key) = port(mux, BA);
+      index_4[key].push_back(value);
+      if (tracking)
+        index_4_keys[cell].push_back(key);
+      }
+    } while (0);
+    do {
+      Cell *ff = cell;
+      index_5_value_type value;
+      std::get<0>(value) = cell;
+      if (!(ff->type.in(id_d_dff, id_d_adff, id_d_dffe, id_d_adffe))) continue;
+      if (!(param(ff, id_b_CLK_POLARITY).as_bool())) continue;
+      index_5_key_type key;
+      std::get<0>(key) = port(ff, id_b_D);
+      std::get<1>(key) = port(ff, id_b_Q);
+      index_5[key].push_back(value);
+      if (tracking)
+        index_5_keys[cell].push_back(key);
+    } while (0);
+  }
+
+  // Keep the indices in sync with the changes made to the module, so that the
+  // same matcher can be run again after update() instead of being rebuilt.
+  // Cells created later are indexed if track_filter (if any) accepts them.
+  void track_changes(std::function<bool(Cell*)> filter = nullptr) {
+    log_assert(setup_done && !tracking);
+    tracking = true;
+    track_filter = filter;
+    module->monitors.insert(&monitor);
+    for (auto &it : index_1)
+      for (auto &value : it.second)
+        index_1_keys[std::get<0>(value)].push_back(it.first);
+    for (auto &it : index_3)
+      for (auto &value : it.second)
+        index_3_keys[std::get<0>(value)].push_back(it.first);
+    for (auto &it : index_4)
+      for (auto &value : it.second)
+        index_4_keys[std::get<0>(value)].push_back(it.first);
+    for (auto &it : index_5)
+      for (auto &value : it.second)
+        index_5_keys[std::get<0>(value)].push_back(it.first);
+  }
+
+  // Called while the cell still exists: the containers above hash cells by
+  // their hashidx_, so no reference to the cell may survive its deletion.
+  void forget_cell(Cell *cell) {
+    auto released = released_sigs.find(cell);
+    if (released != released_sigs.end()) {
+      release_siguser(released->second, cell);
+      released_sigs.erase(released);
+    }
+    auto keys_1 = index_1_keys.find(cell);
+    if (keys_1 != index_1_keys.end()) {
+      for (auto &key : keys_1->second)
+        index_1_stale_keys.push_back(key);
+      index_1_keys.erase(keys_1);
+    }
+    auto keys_3 = index_3_keys.find(cell);
+    if (keys_3 != index_3_keys.end()) {
+      for (auto &key : keys_3->second)
+        index_3_stale_keys.push_back(key);
+      index_3_keys.erase(keys_3);
+    }
+    auto keys_4 = index_4_keys.find(cell);
+    if (keys_4 != index_4_keys.end()) {
+      for (auto &key : keys_4->second)
+        index_4_stale_keys.push_back(key);
+      index_4_keys.erase(keys_4);
+    }
+    auto keys_5 = index_5_keys.find(cell);
+    if (keys_5 != index_5_keys.end()) {
+      for (auto &key : keys_5->second)
+        index_5_stale_keys.push_back(key);
+      index_5_keys.erase(keys_5);
+    }
+    changed_cells.erase(cell);
+    blacklist_cells.erase(cell);
+    autoremove_cells.erase(cell);
+    removed_cells.insert(cell);
+  }
+
+  void release_siguser(const SigSpec &sig, Cell *cell) {
+    for (auto bit : sigmap(sig)) {
+      auto users = sigusers.find(bit);
+      if (users != sigusers.end())
+        users->second.erase(cell);
+    }
+  }
+
+  // Removes the autoremove cells and re-indexes every cell that was created,
+  // reconnected, blacklisted or connected to a changed net since the last update().
+  void update() {
+    log_assert(tracking);
+    for (auto cell : blacklist_cells)
+      changed_cells.insert(cell);
+    blacklist_cells.clear();
+    pool<Cell*> cells;
+    cells.swap(autoremove_cells);
+    for (auto cell : cells)
+      module->remove(cell);
+
+    if (rebuild_needed) {
+      sigmap.set(module);
+      sigusers.clear();
+      index_1.clear();
+      index_1_keys.clear();
+      index_1_stale_keys.clear();
+      index_3.clear();
+      index_3_keys.clear();
+      index_3_stale_keys.clear();
+      index_4.clear();
+      index_4_keys.clear();
+      index_4_stale_keys.clear();
+      index_5.clear();
+      index_5_keys.clear();
+      index_5_stale_keys.clear();
+      init_sigusers();
+      for (auto cell : module->cells())
+        if (!track_filter || track_filter(cell))
+          index_cell(cell);
+    } else {
+      for (auto &it : released_sigs)
+        release_siguser(it.second, it.first);
+      for (auto &conn : connected_sigs)
+        for (int i = 0; i < GetSize(conn.first); i++) {
+          SigBit a = sigmap(conn.first[i]), b = sigmap(conn.second[i]);
+          if (a == b) continue;
+          sigmap.add(conn.first[i], conn.second[i]);
+          SigBit rep = sigmap(a);
+          for (auto bit : {a, b}) {
+            auto users_it = sigusers.find(bit);
+            if (bit == rep || users_it == sigusers.end()) continue;
+            pool<Cell*> users;
+            users.swap(users_it->second);
+            sigusers.erase(users_it);
+            for (auto user : users) {
+              if (rep.wire != nullptr)
+                sigusers[rep].insert(user);
+              if (user != nullptr)
+                changed_cells.insert(user);
+            }
+          }
+        }
+      for (auto cell : changed_cells)
+        for (auto &conn : cell->connections())
+          add_siguser(conn.second, cell);
+      // select and filter expressions may look at the number of users of a net
+      vector<Cell*> neighbours;
+      for (auto bit : sigmap(changed_sigs)) {
+        auto users = sigusers.find(bit);
+        if (users != sigusers.end())
+          for (auto user : users->second)
+            if (user != nullptr && !changed_cells.count(user))
+              neighbours.push_back(user);
+      }
+      for (auto cell : neighbours)
+        changed_cells.insert(cell);
+
+      {
+        pool<index_1_key_type> keys(index_1_stale_keys.begin(), index_1_stale_keys.end());
+        index_1_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_1_keys.find(cell);
+          if (cell_keys == index_1_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_1_keys.erase(cell_keys);
         }
-      } while (0);
-      do {
-        Cell *mux = cell;
-        index_4_value_type value;
-        std::get<0>(value) = cell;
-        if (!(mux->type.in(id_d_mux))) continue;
-        vector<IdString> _pmg_choices_AB = {id_b_A, id_b_B};
-        for (const IdString &AB : _pmg_choices_AB) {
-        std::get<1>(value) = AB;
-        IdString &BA = std::get<2>(value);
-        BA = (AB == id_b_A ? id_b_B : id_b_A);
-        index_4_key_type key;
-        std::get<0>(key) = port(mux, AB);
-        std::get<1>(key) = port(mux, BA);
-        index_4[key].push_back(value);
+        for (auto &key : keys) {
+          auto values = index_1.find(key);
+          if (values == index_1.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_1_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_1.erase(values);
+        }
+      }
+      {
+        pool<index_3_key_type> keys(index_3_stale_keys.begin(), index_3_stale_keys.end());
+        index_3_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_3_keys.find(cell);
+          if (cell_keys == index_3_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_3_keys.erase(cell_keys);
         }
-      } while (0);
-      do {
-        Cell *ff = cell;
-        index_5_value_type value;
-        std::get<0>(value) = cell;
-        if (!(ff->type.in(id_d_dff, id_d_adff, id_d_dffe, id_d_adffe))) continue;
-        if (!(param(ff, id_b_CLK_POLARITY).as_bool())) continue;
-        index_5_key_type key;
-        std::get<0>(key) = port(ff, id_b_D);
-        std::get<1>(key) = port(ff, id_b_Q);
-        index_5[key].push_back(value);
-      } while (0);
+        for (auto &key : keys) {
+          auto values = index_3.find(key);
+          if (values == index_3.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_3_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_3.erase(values);
+        }
+      }
+      {
+        pool<index_4_key_type> keys(index_4_stale_keys.begin(), index_4_stale_keys.end());
+        index_4_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_4_keys.find(cell);
+          if (cell_keys == index_4_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_4_keys.erase(cell_keys);
+        }
+        for (auto &key : keys) {
+          auto values = index_4.find(key);
+          if (values == index_4.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_4_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_4.erase(values);
+        }
+      }
+      {
+        pool<index_5_key_type> keys(index_5_stale_keys.begin(), index_5_stale_keys.end());
+        index_5_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_5_keys.find(cell);
+          if (cell_keys == index_5_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_5_keys.erase(cell_keys);
+        }
+        for (auto &key : keys) {
+          auto values = index_5.find(key);
+          if (values == index_5.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_5_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_5.erase(values);
+        }
+      }
+      for (auto cell : changed_cells)
+        if (!track_filter || track_filter(cell))
+          index_cell(cell);
     }
+
+    rebuild_needed = false;
+    changed_cells.clear();
+    removed_cells.clear();
+    released_sigs.clear();
+    connected_sigs.clear();
+    changed_sigs = SigSpec();
   }
 
   ~ql_dsp_macc_pm() {
+    if (tracking)
+      module->monitors.erase(&monitor);
     for (auto cell : autoremove_cells)
       module->remove(cell);
   }
@@ -40,6 +40,45 @@ struct xilinx_dsp48a_pm {
   dict<Cell*,int> rollback_cache;
   int rollback;
 
+  struct monitor_t : RTLIL::Monitor {
+    xilinx_dsp48a_pm *pm;
+    monitor_t(xilinx_dsp48a_pm *pm) : pm(pm) { }
+    void notify_connect(Cell *cell, const IdString &portname, const SigSpec &old_sig, const SigSpec &sig) override {
+      pm->released_sigs[cell].append(old_sig);
+      pm->changed_sigs.append(old_sig);
+      pm->changed_sigs.append(sig);
+      // Module::remove() disconnects all ports before deleting the cell
+      if (sig.empty() && GetSize(cell->connections_) == 1 && cell->connections_.count(portname))
+        pm->forget_cell(cell);
+      else
+        pm->changed_cells.insert(cell);
+    }
+    void notify_connect(Module*, const SigSig &sigsig) override { pm->connected_sigs.push_back(sigsig); }
+    void notify_connect(Module*, const vector<SigSig>&) override { pm->rebuild_needed = true; }
+    void notify_blackout(Module*) override { pm->rebuild_needed = true; }
+  } monitor{this};
+
+  bool tracking = false;
+  bool rebuild_needed = false;
+  std::function<bool(Cell*)> track_filter;
+  pool<Cell*> changed_cells;
+  pool<Cell*, hashlib::hash_ptr_ops> removed_cells;
+  dict<Cell*, SigSpec> released_sigs;
+  vector<SigSig> connected_sigs;
+  SigSpec changed_sigs;
+  dict<Cell*, vector<index_0_key_type>> index_0_keys;
+  vector<index_0_key_type> index_0_stale_keys;
+  dict<Cell*, vector<index_3_key_type>> index_3_keys;
+  vector<index_3_key_type> index_3_stale_keys;
+  dict<Cell*, vector<index_9_key_type>> index_9_keys;
+  vector<index_9_key_type> index_9_stale_keys;
+  dict<Cell*, vector<index_12_key_type>> index_12_keys;
+  vector<index_12_key_type> index_12_stale_keys;
+  dict<Cell*, vector<index_17_key_type>> index_17_keys;
+  vector<index_17_key_type> index_17_stale_keys;
+  dict<Cell*, vector<index_21_key_type>> index_21_keys;
+  vector<index_21_key_type> index_21_stale_keys;
+
   struct state_xilinx_dsp48a_pack_t {
     SigSpec argD;
     SigSpec argQ;
@@ -177,93 +216,414 @@ struct xilinx_dsp48a_pm {
     ud_xilinx_dsp48a_pack.dffclock = SigBit();
     log_assert(!setup_done);
     setup_done = true;
+    init_sigusers();
+    for (auto cell : cells)
+      index_cell(cell);
+  }
+
+  void init_sigusers() {
     for (auto port : module->ports)
       add_siguser(module->wire(port), nullptr);
     for (auto cell : module->cells())
       for (auto &conn : cell->connections())
         add_siguser(conn.second, cell);
-    for (auto cell : cells) {
-      do {
-        Cell *dsp = cell;
-        index_0_value_type value;
-        std::get<0>(value) = cell;
-        if (!(dsp->type.in(id_b_DSP48A, id_b_DSP48A1))) continue;
-        index_0_key_type key;
-        index_0[key].push_back(value);
-      } while (0);
-      do {
-        Cell *preAdd = cell;
-        index_3_value_type value;
-        std::get<0>(value) = cell;
-        if (!(preAdd->type.in(id_d_add, id_d_sub))) continue;
-        if (!(GetSize(port(preAdd, id_b_Y)) <= 18)) continue;
-        if (!(nusers(port(preAdd, id_b_Y)) == 2)) continue;
-        if (!(GetSize(port(preAdd, id_b_A)) <= 18)) continue;
-        if (!(GetSize(port(preAdd, id_b_B)) <= 18)) continue;
-        index_3_key_type key;
-        std::get<0>(key) = port(preAdd, id_b_Y);
-        index_3[key].push_back(value);
-      } while (0);
-      do {
-        Cell *postAdd = cell;
-        index_9_value_type value;
-        std::get<0>(value) = cell;
-        if (!(postAdd->type.in(id_d_add))) continue;
-        if (!(GetSize(port(postAdd, id_b_Y)) <= 48)) continue;
-        vector<IdString> _pmg_choices_AB = {id_b_A, id_b_B};
-        for (const IdString &AB : _pmg_choices_AB) {
-        std::get<1>(value) = AB;
-        if (!(nusers(port(postAdd, AB)) == 2)) continue;
-        index_9_key_type key;
-        std::get<0>(key) = port(postAdd, AB)[0];
-        index_9[key].push_back(value);
+  }
+
+  void index_cell(Cell *cell) {
+    do {
+      Cell *dsp = cell;
+      index_0_value_type value;
+      std::get<0>(value) = cell;
+      if (!(dsp->type.in(id_b_DSP48A, id_b_DSP48A1))) continue;
+      index_0_key_type key;
+      index_0[key].push_back(value);
+      if (tracking)
+        index_0_keys[cell].push_back(key);
+    } while (0);
+    do {
+      Cell *preAdd = cell;
+      index_3_value_type value;
+      std::get<0>(value) = cell;
+      if (!(preAdd->type.in(id_d_add, id_d_sub))) continue;
+      if (!(GetSize(port(preAdd, id_b_Y)) <= 18)) continue;
+      if (!(nusers(port(preAdd, id_b_Y)) == 2)) continue;
+      if (!(GetSize(port(preAdd, id_b_A)) <= 18)) continue;
+      if (!(GetSize(port(preAdd, id_b_B)) <= 18)) continue;
+      index_3_key_type key;
+      std::get<0>(key) = port(preAdd, id_b_Y);
+      index_3[key].push_back(value);
+      if (tracking)
+        index_3_keys[cell].push_back(key);
+    } while (0);
+    do {
+      Cell *postAdd = cell;
+      index_9_value_type value;
+      std::get<0>(value) = cell;
+      if (!(postAdd->type.in(id_d_add))) continue;
+      if (!(GetSize(port(postAdd, id_b_Y)) <= 48)) continue;
+      vector<IdString> _pmg_choices_AB = {id_b_A, id_b_B};
+      for (const IdString &AB : _pmg_choices_AB) {
+      std::get<1>(value) = AB;
+      if (!(nusers(port(postAdd, AB)) == 2)) continue;
+      index_9_key_type key;
+      std::get<0>(key) = port(postAdd, AB)[0];
+      index_9[key].push_back(value);
+      if (tracking)
+        index_9_keys[cell].push_back(key);
+      }
+    } while (0);
+    do {
+      Cell *postAddMux = cell;
+      index_12_value_type value;
+      std::get<0>(value) = cell;
+      if (!(postAddMux->type.in(id_d_mux))) continue;
+      if (!(nusers(port(postAddMux, id_b_Y)) == 2)) continue;
+      vector<IdString> _pmg_choices_AB = {id_b_A, id_b_B};
+      for (const IdString &AB : _pmg_choices_AB) {
+      std::get<1>(value) = AB;
+      index_12_key_type key;
+      std::get<0>(key) = port(postAddMux, AB);
+      std::get<1>(key) = port(postAddMux, id_b_Y);
+      index_12[key].push_back(value);
+      if (tracking)
+        index_12_keys[cell].push_back(key);
+      }
+    } while (0);
+    do {
+      Cell *ff = cell;
+      index_17_value_type value;
+      std::get<0>(value) = cell;
+      if (!(ff->type.in(id_d_dff, id_d_dffe, id_d_sdff, id_d_sdffe))) continue;
+      if (!(param(ff, id_b_CLK_POLARITY).as_bool())) continue;
+      int &offset = std::get<1>(value);
+      for (offset = 0; offset < GetSize(port(ff, id_b_D)); offset++) {
+      index_17_key_type key;
+      std::get<0>(key) = port(ff, id_b_Q)[offset];
+      index_17[key].push_back(value);
+      if (tracking)
+        index_17_keys[cell].push_back(key);
+      }
+    } while (0);
+    do {
+      Cell *ff = cell;
+      index_21_value_type value;
+      std::get<0>(value) = cell;
+      if (!(ff->type.in(id_d_dff, id_d_dffe, id_d_sdff, id_d_sdffe))) continue;
+      if (!(param(ff, id_b_CLK_POLARITY).as_bool())) continue;
+      int &offset = std::get<1>(value);
+      for (offset = 0; offset < GetSize(port(ff, id_b_D)); offset++) {
+      index_21_key_type key;
+      std::get<0>(key) = port(ff, id_b_D)[offset];
+      index_21[key].push_back(value);
+      if (tracking)
+        index_21_keys[cell].push_back(key);
+      }
+    } while (0);
+  }
+
+  // Keep the indices in sync with the changes made to the module, so that the
+  // same matcher can be run again after update() instead of being rebuilt.
+  // Cells created later are indexed if track_filter (if any) accepts them.
+  void track_changes(std::function<bool(Cell*)> filter = nullptr) {
+    log_assert(setup_done && !tracking);
+    tracking = true;
+    track_filter = filter;
+    module->monitors.insert(&monitor);
+    for (auto &it : index_0)
+      for (auto &value : it.second)
+        index_0_keys[std::get<0>(value)].push_back(it.first);
+    for (auto &it : index_3)
+      for (auto &value : it.second)
+        index_3_keys[std::get<0>(value)].push_back(it.first);
+    for (auto &it : index_9)
+      for (auto &value : it.second)
+        index_9_keys[std::get<0>(value)].push_back(it.first);
+    for (auto &it : index_12)
+      for (auto &value : it.second)
+        index_12_keys[std::get<0>(value)].push_back(it.first);
+    for (auto &it : index_17)
+      for (auto &value : it.second)
+        index_17_keys[std::get<0>(value)].push_back(it.first);
+    for (auto &it : index_21)
+      for (auto &value : it.second)
+        index_21_keys[std::get<0>(value)].push_back(it.first);
+  }
+
+  // Called while the cell still exists: the containers above hash cells by
+  // their hashidx_, so no reference to the cell may survive its deletion.
+  void forget_cell(Cell *cell) {
+    auto released = released_sigs.find(cell);
+    if (released != released_sigs.end()) {
+      release_siguser(released->second, cell);
+      released_sigs.erase(released);
+    }
+    auto keys_0 = index_0_keys.find(cell);
+    if (keys_0 != index_0_keys.end()) {
+      for (auto &key : keys_0->second)
+        index_0_stale_keys.push_back(key);
+      index_0_keys.erase(keys_0);
+    }
+    auto keys_3 = index_3_keys.find(cell);
+    if (keys_3 != index_3_keys.end()) {
+      for (auto &key : keys_3->second)
+        index_3_stale_keys.push_back(key);
+      index_3_keys.erase(keys_3);
+    }
+    auto keys_9 = index_9_keys.find(cell);
+    if (keys_9 != index_9_keys.end()) {
+      for (auto &key : keys_9->second)
+        index_9_stale_keys.push_back(key);
+      index_9_keys.erase(keys_9);
+    }
+    auto keys_12 = index_12_keys.find(cell);
+    if (keys_12 != index_12_keys.end()) {
+      for (auto &key : keys_12->second)
+        index_12_stale_keys.push_back(key);
+      index_12_keys.erase(keys_12);
+    }
+    auto keys_17 = index_17_keys.find(cell);
+    if (keys_17 != index_17_keys.end()) {
+      for (auto &key : keys_17->second)
+        index_17_stale_keys.push_back(key);
+      index_17_keys.erase(keys_17);
+    }
+    auto keys_21 = index_21_keys.find(cell);
+    if (keys_21 != index_21_keys.end()) {
+      for (auto &key : keys_21->second)
+        index_21_stale_keys.push_back(key);
+      index_21_keys.erase(keys_21);
+    }
+    changed_cells.erase(cell);
+    blacklist_cells.erase(cell);
+    autoremove_cells.erase(cell);
+    removed_cells.insert(cell);
+  }
+
+  void release_siguser(const SigSpec &sig, Cell *cell) {
+    for (auto bit : sigmap(sig)) {
+      auto users = sigusers.find(bit);
+      if (users != sigusers.end())
+        users->second.erase(cell);
+    }
+  }
+
+  // Removes the autoremove cells and re-indexes every cell that was created,
+  // reconnected, blacklisted or connected to a changed net since the last update().
+  void update() {
+    log_assert(tracking);
+    for (auto cell : blacklist_cells)
+      changed_cells.insert(cell);
+    blacklist_cells.clear();
+    pool<Cell*> cells;
+    cells.swap(autoremove_cells);
+    for (auto cell : cells)
+      module->remove(cell);
+
+    if (rebuild_needed) {
+      sigmap.set(module);
+      sigusers.clear();
+      index_0.clear();
+      index_0_keys.clear();
+      index_0_stale_keys.clear();
+      index_3.clear();
+      index_3_keys.clear();
+      index_3_stale_keys.clear();
+      index_9.clear();
+      index_9_keys.clear();
+      index_9_stale_keys.clear();
+      index_12.clear();
+      index_12_keys.clear();
+      index_12_stale_keys.clear();
+      index_17.clear();
+      index_17_keys.clear();
+      index_17_stale_keys.clear();
+      index_21.clear();
+      index_21_keys.clear();
+      index_21_stale_keys.clear();
+      init_sigusers();
+      for (auto cell : module->cells())
+        if (!track_filter || track_filter(cell))
+          index_cell(cell);
+    } else {
+      for (auto &it : released_sigs)
+        release_siguser(it.second, it.first);
+      for (auto &conn : connected_sigs)
+        for (int i = 0; i < GetSize(conn.first); i++) {
+          SigBit a = sigmap(conn.first[i]), b = sigmap(conn.second[i]);
+          if (a == b) continue;
+          sigmap.add(conn.first[i], conn.second[i]);
+          SigBit rep = sigmap(a);
+          for (auto bit : {a, b}) {
+            auto users_it = sigusers.find(bit);
+            if (bit == rep || users_it == sigusers.end()) continue;
+            pool<Cell*> users;
+            users.swap(users_it->second);
+            sigusers.erase(users_it);
+            for (auto user : users) {
+              if (rep.wire != nullptr)
+                sigusers[rep].insert(user);
+              if (user != nullptr)
+                changed_cells.insert(user);
+            }
+          }
+        }
+      for (auto cell : changed_cells)
+        for (auto &conn : cell->connections())
+          add_siguser(conn.second, cell);
+      // select and filter expressions may look at the number of users of a net
+      vector<Cell*> neighbours;
+      for (auto bit : sigmap(changed_sigs)) {
+        auto users = sigusers.find(bit);
+        if (users != sigusers.end())
+          for (auto user : users->second)
+            if (user != nullptr && !changed_cells.count(user))
+              neighbours.push_back(user);
+      }
+      for (auto cell : neighbours)
+        changed_cells.insert(cell);
+
+      {
+        pool<index_0_key_type> keys(index_0_stale_keys.begin(), index_0_stale_keys.end());
+        index_0_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_0_keys.find(cell);
+          if (cell_keys == index_0_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_0_keys.erase(cell_keys);
+        }
+        for (auto &key : keys) {
+          auto values = index_0.find(key);
+          if (values == index_0.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_0_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_0.erase(values);
+        }
+      }
+      {
+        pool<index_3_key_type> keys(index_3_stale_keys.begin(), index_3_stale_keys.end());
+        index_3_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_3_keys.find(cell);
+          if (cell_keys == index_3_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_3_keys.erase(cell_keys);
         }
-      } while (0);
-      do {
-        Cell *postAddMux = cell;
-        index_12_value_type value;
-        std::get<0>(value) = cell;
-        if (!(postAddMux->type.in(id_d_mux))) continue;
-        if (!(nusers(port(postAddMux, id_b_Y)) == 2)) continue;
-        vector<IdString> _pmg_choices_AB = {id_b_A, id_b_B};
-        for (const IdString &AB : _pmg_choices_AB) {
-        std::get<1>(value) = AB;
-        index_12_key_type key;
-        std::get<0>(key) = port(postAddMux, AB);
-        std::get<1>(key) = port(postAddMux, id_b_Y);
-        index_12[key].push_back(value);
+        for (auto &key : keys) {
+          auto values = index_3.find(key);
+          if (values == index_3.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_3_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_3.erase(values);
         }
-      } while (0);
-      do {
-        Cell *ff = cell;
-        index_17_value_type value;
-        std::get<0>(value) = cell;
-        if (!(ff->type.in(id_d_dff, id_d_dffe, id_d_sdff, id_d_sdffe))) continue;
-        if (!(param(ff, id_b_CLK_POLARITY).as_bool())) continue;
-        int &offset = std::get<1>(value);
-        for (offset = 0; offset < GetSize(port(ff, id_b_D)); offset++) {
-        index_17_key_type key;
-        std::get<0>(key) = port(ff, id_b_Q)[offset];
-        index_17[key].push_back(value);
+      }
+      {
+        pool<index_9_key_type> keys(index_9_stale_keys.begin(), index_9_stale_keys.end());
+        index_9_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_9_keys.find(cell);
+          if (cell_keys == index_9_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_9_keys.erase(cell_keys);
+        }
+        for (auto &key : keys) {
+          auto values = index_9.find(key);
+          if (values == index_9.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_9_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_9.erase(values);
+        }
+      }
+      {
+        pool<index_12_key_type> keys(index_12_stale_keys.begin(), index_12_stale_keys.end());
+        index_12_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_12_keys.find(cell);
+          if (cell_keys == index_12_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_12_keys.erase(cell_keys);
+        }
+        for (auto &key : keys) {
+          auto values = index_12.find(key);
+          if (values == index_12.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_12_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_12.erase(values);
+        }
+      }
+      {
+        pool<index_17_key_type> keys(index_17_stale_keys.begin(), index_17_stale_keys.end());
+        index_17_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_17_keys.find(cell);
+          if (cell_keys == index_17_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_17_keys.erase(cell_keys);
+        }
+        for (auto &key : keys) {
+          auto values = index_17.find(key);
+          if (values == index_17.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_17_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_17.erase(values);
+        }
+      }
+      {
+        pool<index_21_key_type> keys(index_21_stale_keys.begin(), index_21_stale_keys.end());
+        index_21_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_21_keys.find(cell);
+          if (cell_keys == index_21_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_21_keys.erase(cell_keys);
         }
-      } while (0);
-      do {
-        Cell *ff = cell;
-        index_21_value_type value;
-        std::get<0>(value) = cell;
-        if (!(ff->type.in(id_d_dff, id_d_dffe, id_d_sdff, id_d_sdffe))) continue;
-        if (!(param(ff, id_b_CLK_POLARITY).as_bool())) continue;
-        int &offset = std::get<1>(value);
-        for (offset = 0; offset < GetSize(port(ff, id_b_D)); offset++) {
-        index_21_key_type key;
-        std::get<0>(key) = port(ff, id_b_D)[offset];
-        index_21[key].push_back(value);
+        for (auto &key : keys) {
+          auto values = index_21.find(key);
+          if (values == index_21.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_21_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_21.erase(values);
         }
-      } while (0);
+      }
+      for (auto cell : changed_cells)
+        if (!track_filter || track_filter(cell))
+          index_cell(cell);
     }
+
+    rebuild_needed = false;
+    changed_cells.clear();
+    removed_cells.clear();
+    released_sigs.clear();
+    connected_sigs.clear();
+    changed_sigs = SigSpec();
   }
 
   ~xilinx_dsp48a_pm() {
+    if (tracking)
+      module->monitors.erase(&monitor);
     for (auto cell : autoremove_cells)
       module->remove(cell);
   }
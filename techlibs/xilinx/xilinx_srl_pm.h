@@ -43,6 +43,47 @@ struct xilinx_srl_pm {
   dict<Cell*,int> rollback_cache;
   int rollback;
 
+  struct monitor_t : RTLIL::Monitor {
+    xilinx_srl_pm *pm;
+    monitor_t(xilinx_srl_pm *pm) : pm(pm) { }
+    void notify_connect(Cell *cell, const IdString &portname, const SigSpec &old_sig, const SigSpec &sig) override {
+      pm->released_sigs[cell].append(old_sig);
+      pm->changed_sigs.append(old_sig);
+      pm->changed_sigs.append(sig);
+      // Module::remove() disconnects all ports before deleting the cell
+      if (sig.empty() && GetSize(cell->connections_) == 1 && cell->connections_.count(portname))
+        pm->forget_cell(cell);
+      else
+        pm->changed_cells.insert(cell);
+    }
+    void notify_connect(Module*, const SigSig &sigsig) override { pm->connected_sigs.push_back(sigsig); }
+    void notify_connect(Module*, const vector<SigSig>&) override { pm->rebuild_needed = true; }
+    void notify_blackout(Module*) override { pm->rebuild_needed = true; }
+  } monitor{this};
+
+  bool tracking = false;
+  bool rebuild_needed = false;
+  std::function<bool(Cell*)> track_filter;
+  pool<Cell*> changed_cells;
+  pool<Cell*, hashlib::hash_ptr_ops> removed_cells;
+  dict<Cell*, SigSpec> released_sigs;
+  vector<SigSig> connected_sigs;
+  SigSpec changed_sigs;
+  dict<Cell*, vector<index_1_key_type>> index_1_keys;
+  vector<index_1_key_type> index_1_stale_keys;
+  dict<Cell*, vector<index_4_key_type>> index_4_keys;
+  vector<index_4_key_type> index_4_stale_keys;
+  dict<Cell*, vector<index_6_key_type>> index_6_keys;
+  vector<index_6_key_type> index_6_stale_keys;
+  dict<Cell*, vector<index_9_key_type>> index_9_keys;
+  vector<index_9_key_type> index_9_stale_keys;
+  dict<Cell*, vector<index_13_key_type>> index_13_keys;
+  vector<index_13_key_type> index_13_stale_keys;
+  dict<Cell*, vector<index_15_key_type>> index_15_keys;
+  vector<index_15_key_type> index_15_stale_keys;
+  dict<Cell*, vector<index_18_key_type>> index_18_keys;
+  vector<index_18_key_type> index_18_stale_keys;
+
   struct state_fixed_t {
     IdString clk_port;
     IdString en_port;
@@ -173,108 +214,464 @@ struct xilinx_srl_pm {
     ud_variable.minlen = int();
     log_assert(!setup_done);
     setup_done = true;
+    init_sigusers();
+    for (auto cell : cells)
+      index_cell(cell);
+  }
+
+  void init_sigusers() {
     for (auto port : module->ports)
       add_siguser(module->wire(port), nullptr);
     for (auto cell : module->cells())
       for (auto &conn : cell->connections())
         add_siguser(conn.second, cell);
-    for (auto cell : cells) {
-      do {
-        Cell *first = cell;
-        index_1_value_type value;
-        std::get<0>(value) = cell;
-        if (!(first->type.in(id_d__DFF_N_, id_d__DFF_P_, id_d__DFFE_NN_, id_d__DFFE_NP_, id_d__DFFE_PN_, id_d__DFFE_PP_, id_b_FDRE, id_b_FDRE_1))) continue;
-        if (!(!first->has_keep_attr())) continue;
-        if (!(!first->type.in(id_b_FDRE) || !param(first, id_b_IS_R_INVERTED).as_bool())) continue;
-        if (!(!first->type.in(id_b_FDRE) || !param(first, id_b_IS_D_INVERTED).as_bool())) continue;
-        if (!(!first->type.in(id_b_FDRE, id_b_FDRE_1) || port(first, id_b_R, State::S0).is_fully_zero())) continue;
-        index_1_key_type key;
-        index_1[key].push_back(value);
-      } while (0);
-      do {
-        Cell *first = cell;
-        index_4_value_type value;
-        std::get<0>(value) = cell;
-        if (!(first->type.in(id_d__DFF_N_, id_d__DFF_P_, id_d__DFFE_NN_, id_d__DFFE_NP_, id_d__DFFE_PN_, id_d__DFFE_PP_, id_b_FDRE, id_b_FDRE_1))) continue;
-        if (!(!first->has_keep_attr())) continue;
-        if (!(!first->type.in(id_b_FDRE) || !param(first, id_b_IS_R_INVERTED).as_bool())) continue;
-        if (!(!first->type.in(id_b_FDRE) || !param(first, id_b_IS_D_INVERTED).as_bool())) continue;
-        if (!(!first->type.in(id_b_FDRE, id_b_FDRE_1) || port(first, id_b_R, State::S0).is_fully_zero())) continue;
-        index_4_key_type key;
-        index_4[key].push_back(value);
-      } while (0);
-      do {
-        Cell *next = cell;
-        index_6_value_type value;
-        std::get<0>(value) = cell;
-        if (!(next->type.in(id_d__DFF_N_, id_d__DFF_P_, id_d__DFFE_NN_, id_d__DFFE_NP_, id_d__DFFE_PN_, id_d__DFFE_PP_, id_b_FDRE, id_b_FDRE_1))) continue;
-        if (!(!next->has_keep_attr())) continue;
-        if (!(port(next, id_b_D)[0].wire && !port(next, id_b_D)[0].wire->get_bool_attribute(id_b_keep))) continue;
-        if (!(nusers(port(next, id_b_Q)) == 2)) continue;
-        index_6_key_type key;
-        std::get<0>(key) = next->type;
-        std::get<1>(key) = port(next, id_b_Q);
-        index_6[key].push_back(value);
-      } while (0);
-      do {
-        Cell *next = cell;
-        index_9_value_type value;
-        std::get<0>(value) = cell;
-        if (!(next->type.in(id_d__DFF_N_, id_d__DFF_P_, id_d__DFFE_NN_, id_d__DFFE_NP_, id_d__DFFE_PN_, id_d__DFFE_PP_, id_b_FDRE, id_b_FDRE_1))) continue;
-        if (!(!next->has_keep_attr())) continue;
-        if (!(port(next, id_b_D)[0].wire && !port(next, id_b_D)[0].wire->get_bool_attribute(id_b_keep))) continue;
-        if (!(nusers(port(next, id_b_Q)) == 2)) continue;
-        index_9_key_type key;
-        std::get<0>(key) = next->type;
-        std::get<1>(key) = port(next, id_b_Q);
-        index_9[key].push_back(value);
-      } while (0);
-      do {
-        Cell *shiftx = cell;
-        index_13_value_type value;
-        std::get<0>(value) = cell;
-        if (!(shiftx->type.in(id_d_shiftx))) continue;
-        if (!(!shiftx->has_keep_attr())) continue;
-        if (!(param(shiftx, id_b_Y_WIDTH).as_int() == 1)) continue;
-        index_13_key_type key;
-        index_13[key].push_back(value);
-      } while (0);
-      do {
-        Cell *first = cell;
-        index_15_value_type value;
-        std::get<0>(value) = cell;
-        if (!(first->type.in(id_d__DFF_N_, id_d__DFF_P_, id_d__DFFE_NN_, id_d__DFFE_NP_, id_d__DFFE_PN_, id_d__DFFE_PP_, id_d_dff, id_d_dffe))) continue;
-        if (!(!first->has_keep_attr())) continue;
-        if (!(port(first, id_b_Q)[0].wire && !port(first, id_b_Q)[0].wire->get_bool_attribute(id_b_keep))) continue;
-        int &idx = std::get<1>(value);
-        for (idx = 0; idx < GetSize(port(first, id_b_Q)); idx++) {
-        if (!(nusers(port(first, id_b_Q)[idx]) <= 2)) continue;
-        index_15_key_type key;
-        std::get<0>(key) = port(first, id_b_Q)[idx];
-        index_15[key].push_back(value);
+  }
+
+  void index_cell(Cell *cell) {
+    do {
+      Cell *first = cell;
+      index_1_value_type value;
+      std::get<0>(value) = cell;
+      if (!(first->type.in(id_d__DFF_N_, id_d__DFF_P_, id_d__DFFE_NN_, id_d__DFFE_NP_, id_d__DFFE_PN_, id_d__DFFE_PP_, id_b_FDRE, id_b_FDRE_1))) continue;
+      if (!(!first->has_keep_attr())) continue;
+      if (!(!first->type.in(id_b_FDRE) || !param(first, id_b_IS_R_INVERTED).as_bool())) continue;
+      if (!(!first->type.in(id_b_FDRE) || !param(first, id_b_IS_D_INVERTED).as_bool())) continue;
+      if (!(!first->type.in(id_b_FDRE, id_b_FDRE_1) || port(first, id_b_R, State::S0).is_fully_zero())) continue;
+      index_1_key_type key;
+      index_1[key].push_back(value);
+      if (tracking)
+        index_1_keys[cell].push_back(key);
+    } while (0);
+    do {
+      Cell *first = cell;
+      index_4_value_type value;
+      std::get<0>(value) = cell;
+      if (!(first->type.in(id_d__DFF_N_, id_d__DFF_P_, id_d__DFFE_NN_, id_d__DFFE_NP_, id_d__DFFE_PN_, id_d__DFFE_PP_, id_b_FDRE, id_b_FDRE_1))) continue;
+      if (!(!first->has_keep_attr())) continue;
+      if (!(!first->type.in(id_b_FDRE) || !param(first, id_b_IS_R_INVERTED).as_bool())) continue;
+      if (!(!first->type.in(id_b_FDRE) || !param(first, id_b_IS_D_INVERTED).as_bool())) continue;
+      if (!(!first->type.in(id_b_FDRE, id_b_FDRE_1) || port(first, id_b_R, State::S0).is_fully_zero())) continue;
+      index_4_key_type key;
+      index_4[key].push_back(value);
+      if (tracking)
+        index_4_keys[cell].push_back(key);
+    } while (0);
+    do {
+      Cell *next = cell;
+      index_6_value_type value;
+      std::get<0>(value) = cell;
+      if (!(next->type.in(id_d__DFF_N_, id_d__DFF_P_, id_d__DFFE_NN_, id_d__DFFE_NP_, id_d__DFFE_PN_, id_d__DFFE_PP_, id_b_FDRE, id_b_FDRE_1))) continue;
+      if (!(!next->has_keep_attr())) continue;
+      if (!(port(next, id_b_D)[0].wire && !port(next, id_b_D)[0].wire->get_bool_attribute(id_b_keep))) continue;
+      if (!(nusers(port(next, id_b_Q)) == 2)) continue;
+      index_6_key_type key;
+      std::get<0>(key) = next->type;
+      std::get<1>(key) = port(next, id_b_Q);
+      index_6[key].push_back(value);
+      if (tracking)
+        index_6_keys[cell].push_back(key);
+    } while (0);
+    do {
+      Cell *next = cell;
+      index_9_value_type value;
+      std::get<0>(value) = cell;
+      if (!(next->type.in(id_d__DFF_N_, id_d__DFF_P_, id_d__DFFE_NN_, id_d__DFFE_NP_, id_d__DFFE_PN_, id_d__DFFE_PP_, id_b_FDRE, id_b_FDRE_1))) continue;
+      if (!(!next->has_keep_attr())) continue;
+      if (!(port(next, id_b_D)[0].wire && !port(next, id_b_D)[0].wire->get_bool_attribute(id_b_keep))) continue;
+      if (!(nusers(port(next, id_b_Q)) == 2)) continue;
+      index_9_key_type key;
+      std::get<0>(key) = next->type;
+      std::get<1>(key) = port(next, id_b_Q);
+      index_9[key].push_back(value);
+      if (tracking)
+        index_9_keys[cell].push_back(key);
+    } while (0);
+    do {
+      Cell *shiftx = cell;
+      index_13_value_type value;
+      std::get<0>(value) = cell;
+      if (!(shiftx->type.in(id_d_shiftx))) continue;
+      if (!(!shiftx->has_keep_attr())) continue;
+      if (!(param(shiftx, id_b_Y_WIDTH).as_int() == 1)) continue;
+      index_13_key_type key;
+      index_13[key].push_back(value);
+      if (tracking)
+        index_13_keys[cell].push_back(key);
+    } while (0);
+    do {
+      Cell *first = cell;
+      index_15_value_type value;
+      std::get<0>(value) = cell;
+      if (!(first->type.in(id_d__DFF_N_, id_d__DFF_P_, id_d__DFFE_NN_, id_d__DFFE_NP_, id_d__DFFE_PN_, id_d__DFFE_PP_, id_d_dff, id_d_dffe))) continue;
+      if (!(!first->has_keep_attr())) continue;
+      if (!(port(first, id_b_Q)[0].wire && !port(first, id_b_Q)[0].wire->get_bool_attribute(id_b_keep))) continue;
+      int &idx = std::get<1>(value);
+      for (idx = 0; idx < GetSize(port(first, id_b_Q)); idx++) {
+      if (!(nusers(port(first, id_b_Q)[idx]) <= 2)) continue;
+      index_15_key_type key;
+      std::get<0>(key) = port(first, id_b_Q)[idx];
+      index_15[key].push_back(value);
+      if (tracking)
+        index_15_keys[cell].push_back(key);
+      }
+    } while (0);
+    do {
+      Cell *next = cell;
+      index_18_value_type value;
+      std::get<0>(value) = cell;
+      if (!(next->type.in(id_d__DFF_N_, id_d__DFF_P_, id_d__DFFE_NN_, id_d__DFFE_NP_, id_d__DFFE_PN_, id_d__DFFE_PP_, id_d_dff, id_d_dffe))) continue;
+      if (!(!next->has_keep_attr())) continue;
+      if (!(port(next, id_b_D)[0].wire && !port(next, id_b_D)[0].wire->get_bool_attribute(id_b_keep))) continue;
+      int &idx = std::get<1>(value);
+      for (idx = 0; idx < GetSize(port(next, id_b_Q)); idx++) {
+      if (!(nusers(port(next, id_b_Q)[idx]) <= 3)) continue;
+      index_18_key_type key;
+      std::get<0>(key) = next->type;
+      std::get<1>(key) = port(next, id_b_Q)[idx];
+      std::get<2>(key) = port(next, id_b_Q)[idx];
+      index_18[key].push_back(value);
+      if (tracking)
+        index_18_keys[cell].push_back(key);
+      }
+    } while (0);
+  }
+
+  // Keep the indices in sync with the changes made to the module, so that the
+  // same matcher can be run again after update() instead of being rebuilt.
+  // Cells created later are indexed if track_filter (if any) accepts them.
+  void track_changes(std::function<bool(Cell*)> filter = nullptr) {
+    log_assert(setup_done && !tracking);
+    tracking = true;
+    track_filter = filter;
+    module->monitors.insert(&monitor);
+    for (auto &it : index_1)
+      for (auto &value : it.second)
+        index_1_keys[std::get<0>(value)].push_back(it.first);
+    for (auto &it : index_4)
+      for (auto &value : it.second)
+        index_4_keys[std::get<0>(value)].push_back(it.first);
+    for (auto &it : index_6)
+      for (auto &value : it.second)
+        index_6_keys[std::get<0>(value)].push_back(it.first);
+    for (auto &it : index_9)
+      for (auto &value : it.second)
+        index_9_keys[std::get<0>(value)].push_back(it.first);
+    for (auto &it : index_13)
+      for (auto &value : it.second)
+        index_13_keys[std::get<0>(value)].push_back(it.first);
+    for (auto &it : index_15)
+      for (auto &value : it.second)
+        index_15_keys[std::get<0>(value)].push_back(it.first);
+    for (auto &it : index_18)
+      for (auto &value : it.second)
+        index_18_keys[std::get<0>(value)].push_back(it.first);
+  }
+
+  // Called while the cell still exists: the containers above hash cells by
+  // their hashidx_, so no reference to the cell may survive its deletion.
+  void forget_cell(Cell *cell) {
+    auto released = released_sigs.find(cell);
+    if (released != released_sigs.end()) {
+      release_siguser(released->second, cell);
+      released_sigs.erase(released);
+    }
+    auto keys_1 = index_1_keys.find(cell);
+    if (keys_1 != index_1_keys.end()) {
+      for (auto &key : keys_1->second)
+        index_1_stale_keys.push_back(key);
+      index_1_keys.erase(keys_1);
+    }
+    auto keys_4 = index_4_keys.find(cell);
+    if (keys_4 != index_4_keys.end()) {
+      for (auto &key : keys_4->second)
+        index_4_stale_keys.push_back(key);
+      index_4_keys.erase(keys_4);
+    }
+    auto keys_6 = index_6_keys.find(cell);
+    if (keys_6 != index_6_keys.end()) {
+      for (auto &key : keys_6->second)
+        index_6_stale_keys.push_back(key);
+      index_6_keys.erase(keys_6);
+    }
+    auto keys_9 = index_9_keys.find(cell);
+    if (keys_9 != index_9_keys.end()) {
+      for (auto &key : keys_9->second)
+        index_9_stale_keys.push_back(key);
+      index_9_keys.erase(keys_9);
+    }
+    auto keys_13 = index_13_keys.find(cell);
+    if (keys_13 != index_13_keys.end()) {
+      for (auto &key : keys_13->second)
+        index_13_stale_keys.push_back(key);
+      index_13_keys.erase(keys_13);
+    }
+    auto keys_15 = index_15_keys.find(cell);
+    if (keys_15 != index_15_keys.end()) {
+      for (auto &key : keys_15->second)
+        index_15_stale_keys.push_back(key);
+      index_15_keys.erase(keys_15);
+    }
+    auto keys_18 = index_18_keys.find(cell);
+    if (keys_18 != index_18_keys.end()) {
+      for (auto &key : keys_18->second)
+        index_18_stale_keys.push_back(key);
+      index_18_keys.erase(keys_18);
+    }
+    changed_cells.erase(cell);
+    blacklist_cells.erase(cell);
+    autoremove_cells.erase(cell);
+    removed_cells.insert(cell);
+  }
+
+  void release_siguser(const SigSpec &sig, Cell *cell) {
+    for (auto bit : sigmap(sig)) {
+      auto users = sigusers.find(bit);
+      if (users != sigusers.end())
+        users->second.erase(cell);
+    }
+  }
+
+  // Removes the autoremove cells and re-indexes every cell that was created,
+  // reconnected, blacklisted or connected to a changed net since the last update().
+  void update() {
+    log_assert(tracking);
+    for (auto cell : blacklist_cells)
+      changed_cells.insert(cell);
+    blacklist_cells.clear();
+    pool<Cell*> cells;
+    cells.swap(autoremove_cells);
+    for (auto cell : cells)
+      module->remove(cell);
+
+    if (rebuild_needed) {
+      sigmap.set(module);
+      sigusers.clear();
+      index_1.clear();
+      index_1_keys.clear();
+      index_1_stale_keys.clear();
+      index_4.clear();
+      index_4_keys.clear();
+      index_4_stale_keys.clear();
+      index_6.clear();
+      index_6_keys.clear();
+      index_6_stale_keys.clear();
+      index_9.clear();
+      index_9_keys.clear();
+      index_9_stale_keys.clear();
+      index_13.clear();
+      index_13_keys.clear();
+      index_13_stale_keys.clear();
+      index_15.clear();
+      index_15_keys.clear();
+      index_15_stale_keys.clear();
+      index_18.clear();
+      index_18_keys.clear();
+      index_18_stale_keys.clear();
+      init_sigusers();
+      for (auto cell : module->cells())
+        if (!track_filter || track_filter(cell))
+          index_cell(cell);
+    } else {
+      for (auto &it : released_sigs)
+        release_siguser(it.second, it.first);
+      for (auto &conn : connected_sigs)
+        for (int i = 0; i < GetSize(conn.first); i++) {
+          SigBit a = sigmap(conn.first[i]), b = sigmap(conn.second[i]);
+          if (a == b) continue;
+          sigmap.add(conn.first[i], conn.second[i]);
+          SigBit rep = sigmap(a);
+          for (auto bit : {a, b}) {
+            auto users_it = sigusers.find(bit);
+            if (bit == rep || users_it == sigusers.end()) continue;
+            pool<Cell*> users;
+            users.swap(users_it->second);
+            sigusers.erase(users_it);
+            for (auto user : users) {
+              if (rep.wire != nullptr)
+                sigusers[rep].insert(user);
+              if (user != nullptr)
+                changed_cells.insert(user);
+            }
+          }
+        }
+      for (auto cell : changed_cells)
+        for (auto &conn : cell->connections())
+          add_siguser(conn.second, cell);
+      // select and filter expressions may look at the number of users of a net
+      vector<Cell*> neighbours;
+      for (auto bit : sigmap(changed_sigs)) {
+        auto users = sigusers.find(bit);
+        if (users != sigusers.end())
+          for (auto user : users->second)
+            if (user != nullptr && !changed_cells.count(user))
+              neighbours.push_back(user);
+      }
+      for (auto cell : neighbours)
+        changed_cells.insert(cell);
+
+      {
+        pool<index_1_key_type> keys(index_1_stale_keys.begin(), index_1_stale_keys.end());
+        index_1_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_1_keys.find(cell);
+          if (cell_keys == index_1_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_1_keys.erase(cell_keys);
+        }
+        for (auto &key : keys) {
+          auto values = index_1.find(key);
+          if (values == index_1.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_1_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_1.erase(values);
+        }
+      }
+      {
+        pool<index_4_key_type> keys(index_4_stale_keys.begin(), index_4_stale_keys.end());
+        index_4_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_4_keys.find(cell);
+          if (cell_keys == index_4_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_4_keys.erase(cell_keys);
+        }
+        for (auto &key : keys) {
+          auto values = index_4.find(key);
+          if (values == index_4.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_4_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_4.erase(values);
+        }
+      }
+      {
+        pool<index_6_key_type> keys(index_6_stale_keys.begin(), index_6_stale_keys.end());
+        index_6_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_6_keys.find(cell);
+          if (cell_keys == index_6_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_6_keys.erase(cell_keys);
+        }
+        for (auto &key : keys) {
+          auto values = index_6.find(key);
+          if (values == index_6.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_6_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_6.erase(values);
         }
-      } while (0);
-      do {
-        Cell *next = cell;
-        index_18_value_type value;
-        std::get<0>(value) = cell;
-        if (!(next->type.in(id_d__DFF_N_, id_d__DFF_P_, id_d__DFFE_NN_, id_d__DFFE_NP_, id_d__DFFE_PN_, id_d__DFFE_PP_, id_d_dff, id_d_dffe))) continue;
-        if (!(!next->has_keep_attr())) continue;
-        if (!(port(next, id_b_D)[0].wire && !port(next, id_b_D)[0].wire->get_bool_attribute(id_b_keep))) continue;
-        int &idx = std::get<1>(value);
-        for (idx = 0; idx < GetSize(port(next, id_b_Q)); idx++) {
-        if (!(nusers(port(next, id_b_Q)[idx]) <= 3)) continue;
-        index_18_key_type key;
-        std::get<0>(key) = next->type;
-        std::get<1>(key) = port(next, id_b_Q)[idx];
-        std::get<2>(key) = port(next, id_b_Q)[idx];
-        index_18[key].push_back(value);
+      }
+      {
+        pool<index_9_key_type> keys(index_9_stale_keys.begin(), index_9_stale_keys.end());
+        index_9_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_9_keys.find(cell);
+          if (cell_keys == index_9_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_9_keys.erase(cell_keys);
+        }
+        for (auto &key : keys) {
+          auto values = index_9.find(key);
+          if (values == index_9.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_9_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_9.erase(values);
+        }
+      }
+      {
+        pool<index_13_key_type> keys(index_13_stale_keys.begin(), index_13_stale_keys.end());
+        index_13_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_13_keys.find(cell);
+          if (cell_keys == index_13_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_13_keys.erase(cell_keys);
+        }
+        for (auto &key : keys) {
+          auto values = index_13.find(key);
+          if (values == index_13.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_13_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_13.erase(values);
+        }
+      }
+      {
+        pool<index_15_key_type> keys(index_15_stale_keys.begin(), index_15_stale_keys.end());
+        index_15_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_15_keys.find(cell);
+          if (cell_keys == index_15_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_15_keys.erase(cell_keys);
         }
-      } while (0);
+        for (auto &key : keys) {
+          auto values = index_15.find(key);
+          if (values == index_15.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_15_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_15.erase(values);
+        }
+      }
+      {
+        pool<index_18_key_type> keys(index_18_stale_keys.begin(), index_18_stale_keys.end());
+        index_18_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_18_keys.find(cell);
+          if (cell_keys == index_18_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_18_keys.erase(cell_keys);
+        }
+        for (auto &key : keys) {
+          auto values = index_18.find(key);
+          if (values == index_18.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_18_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_18.erase(values);
+        }
+      }
+      for (auto cell : changed_cells)
+        if (!track_filter || track_filter(cell))
+          index_cell(cell);
     }
+
+    rebuild_needed = false;
+    changed_cells.clear();
+    removed_cells.clear();
+    released_sigs.clear();
+    connected_sigs.clear();
+    changed_sigs = SigSpec();
   }
 
   ~xilinx_srl_pm() {
+    if (tracking)
+      module->monitors.erase(&monitor);
     for (auto cell : autoremove_cells)
       module->remove(cell);
   }
@@ -34,6 +34,41 @@ struct dsp_cascade_pm {
   dict<Cell*,int> rollback_cache;
   int rollback;
 
+  struct monitor_t : RTLIL::Monitor {
+    dsp_cascade_pm *pm;
+    monitor_t(dsp_cascade_pm *pm) : pm(pm) { }
+    void notify_connect(Cell *cell, const IdString &portname, const SigSpec &old_sig, const SigSpec &sig) override {
+      pm->released_sigs[cell].append(old_sig);
+      pm->changed_sigs.append(old_sig);
+      pm->changed_sigs.append(sig);
+      // Module::remove() disconnects all ports before deleting the cell
+      if (sig.empty() && GetSize(cell->connections_) == 1 && cell->connections_.count(portname))
+        pm->forget_cell(cell);
+      else
+        pm->changed_cells.insert(cell);
+    }
+    void notify_connect(Module*, const SigSig &sigsig) override { pm->connected_sigs.push_back(sigsig); }
+    void notify_connect(Module*, const vector<SigSig>&) override { pm->rebuild_needed = true; }
+    void notify_blackout(Module*) override { pm->rebuild_needed = true; }
+  } monitor{this};
+
+  bool tracking = false;
+  bool rebuild_needed = false;
+  std::function<bool(Cell*)> track_filter;
+  pool<Cell*> changed_cells;
+  pool<Cell*, hashlib::hash_ptr_ops> removed_cells;
+  dict<Cell*, SigSpec> released_sigs;
+  vector<SigSig> connected_sigs;
+  SigSpec changed_sigs;
+  dict<Cell*, vector<index_1_key_type>> index_1_keys;
+  vector<index_1_key_type> index_1_stale_keys;
+  dict<Cell*, vector<index_4_key_type>> index_4_keys;
+  vector<index_4_key_type> index_4_stale_keys;
+  dict<Cell*, vector<index_5_key_type>> index_5_keys;
+  vector<index_5_key_type> index_5_stale_keys;
+  dict<Cell*, vector<index_12_key_type>> index_12_keys;
+  vector<index_12_key_type> index_12_stale_keys;
+
   struct state_dsp_cascade_t {
     int AREG;
     int BREG;
@@ -173,63 +208,314 @@ struct dsp_cascade_pm {
     ud_dsp_cascade.unextend = std::function<SigSpec(const SigSpec&)>();
     log_assert(!setup_done);
     setup_done = true;
+    init_sigusers();
+    for (auto cell : cells)
+      index_cell(cell);
+  }
+
+  void init_sigusers() {
     for (auto port : module->ports)
       add_siguser(module->wire(port), nullptr);
     for (auto cell : module->cells())
       for (auto &conn : cell->connections())
         add_siguser(conn.second, cell);
-    for (auto cell : cells) {
-      do {
-        Cell *first = cell;
-        index_1_value_type value;
-        std::get<0>(value) = cell;
-        if (!((first->type.in(id_b_DSP48A, id_b_DSP48A1) && port(first, id_b_OPMODE, Const(0, 8)).extract(2,2) == Const::from_string("00")) || (first->type.in(id_b_DSP48E1) && port(first, id_b_OPMODE, Const(0, 7)).extract(4,3) == Const::from_string("000")))) continue;
-        if (!(nusers(port(first, id_b_PCOUT, SigSpec())) <= 1)) continue;
-        index_1_key_type key;
-        index_1[key].push_back(value);
-      } while (0);
-      do {
-        Cell *nextP = cell;
-        index_4_value_type value;
-        std::get<0>(value) = cell;
-        if (!(!nextP->type.in(id_b_DSP48E1) || !param(nextP, id_b_CREG).as_bool())) continue;
-        if (!((nextP->type.in(id_b_DSP48A, id_b_DSP48A1) && port(nextP, id_b_OPMODE, Const(0, 8)).extract(2,2) == Const::from_string("11")) || (nextP->type.in(id_b_DSP48E1) && port(nextP, id_b_OPMODE, Const(0, 7)).extract(4,3) == Const::from_string("011")))) continue;
-        if (!(nusers(port(nextP, id_b_C, SigSpec())) > 1)) continue;
-        if (!(nusers(port(nextP, id_b_PCIN, SigSpec())) == 0)) continue;
-        index_4_key_type key;
-        std::get<0>(key) = port(nextP, id_b_C)[0];
-        index_4[key].push_back(value);
-      } while (0);
-      do {
-        Cell *nextP_shift17 = cell;
-        index_5_value_type value;
-        std::get<0>(value) = cell;
-        if (!(nextP_shift17->type.in(id_b_DSP48E1))) continue;
-        if (!(!param(nextP_shift17, id_b_CREG).as_bool())) continue;
-        if (!(port(nextP_shift17, id_b_OPMODE, Const(0, 7)).extract(4,3) == Const::from_string("011"))) continue;
-        if (!(nusers(port(nextP_shift17, id_b_C, SigSpec())) > 1)) continue;
-        if (!(nusers(port(nextP_shift17, id_b_PCIN, SigSpec())) == 0)) continue;
-        index_5_key_type key;
-        std::get<0>(key) = port(nextP_shift17, id_b_C)[0];
-        index_5[key].push_back(value);
-      } while (0);
-      do {
-        Cell *ff = cell;
-        index_12_value_type value;
-        std::get<0>(value) = cell;
-        if (!(ff->type.in(id_d_dff, id_d_dffe, id_d_sdff, id_d_sdffe))) continue;
-        if (!(param(ff, id_b_CLK_POLARITY).as_bool())) continue;
-        int &offset = std::get<1>(value);
-        for (offset = 0; offset < GetSize(port(ff, id_b_D)); offset++) {
-        index_12_key_type key;
-        std::get<0>(key) = port(ff, id_b_Q)[offset];
-        index_12[key].push_back(value);
+  }
+
+  void index_cell(Cell *cell) {
+    do {
+      Cell *first = cell;
+      index_1_value_type value;
+      std::get<0>(value) = cell;
+      if (!((first->type.in(id_b_DSP48A, id_b_DSP48A1) && port(first, id_b_OPMODE, Const(0, 8)).extract(2,2) == Const::from_string("00")) || (first->type.in(id_b_DSP48E1) && port(first, id_b_OPMODE, Const(0, 7)).extract(4,3) == Const::from_string("000")))) continue;
+      if (!(nusers(port(first, id_b_PCOUT, SigSpec())) <= 1)) continue;
+      index_1_key_type key;
+      index_1[key].push_back(value);
+      if (tracking)
+        index_1_keys[cell].push_back(key);
+    } while (0);
+    do {
+      Cell *nextP = cell;
+      index_4_value_type value;
+      std::get<0>(value) = cell;
+      if (!(!nextP->type.in(id_b_DSP48E1) || !param(nextP, id_b_CREG).as_bool())) continue;
+      if (!((nextP->type.in(id_b_DSP48A, id_b_DSP48A1) && port(nextP, id_b_OPMODE, Const(0, 8)).extract(2,2) == Const::from_string("11")) || (nextP->type.in(id_b_DSP48E1) && port(nextP, id_b_OPMODE, Const(0, 7)).extract(4,3) == Const::from_string("011")))) continue;
+      if (!(nusers(port(nextP, id_b_C, SigSpec())) > 1)) continue;
+      if (!(nusers(port(nextP, id_b_PCIN, SigSpec())) == 0)) continue;
+      index_4_key_type key;
+      std::get<0>(key) = port(nextP, id_b_C)[0];
+      index_4[key].push_back(value);
+      if (tracking)
+        index_4_keys[cell].push_back(key);
+    } while (0);
+    do {
+      Cell *nextP_shift17 = cell;
+      index_5_value_type value;
+      std::get<0>(value) = cell;
+      if (!(nextP_shift17->type.in(id_b_DSP48E1))) continue;
+      if (!(!param(nextP_shift17, id_b_CREG).as_bool())) continue;
+      if (!(port(nextP_shift17, id_b_OPMODE, Const(0, 7)).extract(4,3) == Const::from_string("011"))) continue;
+      if (!(nusers(port(nextP_shift17, id_b_C, SigSpec())) > 1)) continue;
+      if (!(nusers(port(nextP_shift17, id_b_PCIN, SigSpec())) == 0)) continue;
+      index_5_key_type key;
+      std::get<0>(key) = port(nextP_shift17, id_b_C)[0];
+      index_5[key].push_back(value);
+      if (tracking)
+        index_5_keys[cell].push_back(key);
+    } while (0);
+    do {
+      Cell *ff = cell;
+      index_12_value_type value;
+      std::get<0>(value) = cell;
+      if (!(ff->type.in(id_d_dff, id_d_dffe, id_d_sdff, id_d_sdffe))) continue;
+      if (!(param(ff, id_b_CLK_POLARITY).as_bool())) continue;
+      int &offset = std::get<1>(value);
+      for (offset = 0; offset < GetSize(port(ff, id_b_D)); offset++) {
+      index_12_key_type key;
+      std::get<0>(key) = port(ff, id_b_Q)[offset];
+      index_12[key].push_back(value);
+      if (tracking)
+        index_12_keys[cell].push_back(key);
+      }
+    } while (0);
+  }
+
+  // Keep the indices in sync with the changes made to the module, so that the
+  // same matcher can be run again after update() instead of being rebuilt.
+  // Cells created later are indexed if track_filter (if any) accepts them.
+  void track_changes(std::function<bool(Cell*)> filter = nullptr) {
+    log_assert(setup_done && !tracking);
+    tracking = true;
+    track_filter = filter;
+    module->monitors.insert(&monitor);
+    for (auto &it : index_1)
+      for (auto &value : it.second)
+        index_1_keys[std::get<0>(value)].push_back(it.first);
+    for (auto &it : index_4)
+      for (auto &value : it.second)
+        index_4_keys[std::get<0>(value)].push_back(it.first);
+    for (auto &it : index_5)
+      for (auto &value : it.second)
+        index_5_keys[std::get<0>(value)].push_back(it.first);
+    for (auto &it : index_12)
+      for (auto &value : it.second)
+        index_12_keys[std::get<0>(value)].push_back(it.first);
+  }
+
+  // Called while the cell still exists: the containers above hash cells by
+  // their hashidx_, so no reference to the cell may survive its deletion.
+  void forget_cell(Cell *cell) {
+    auto released = released_sigs.find(cell);
+    if (released != released_sigs.end()) {
+      release_siguser(released->second, cell);
+      released_sigs.erase(released);
+    }
+    auto keys_1 = index_1_keys.find(cell);
+    if (keys_1 != index_1_keys.end()) {
+      for (auto &key : keys_1->second)
+        index_1_stale_keys.push_back(key);
+      index_1_keys.erase(keys_1);
+    }
+    auto keys_4 = index_4_keys.find(cell);
+    if (keys_4 != index_4_keys.end()) {
+      for (auto &key : keys_4->second)
+        index_4_stale_keys.push_back(key);
+      index_4_keys.erase(keys_4);
+    }
+    auto keys_5 = index_5_keys.find(cell);
+    if (keys_5 != index_5_keys.end()) {
+      for (auto &key : keys_5->second)
+        index_5_stale_keys.push_back(key);
+      index_5_keys.erase(keys_5);
+    }
+    auto keys_12 = index_12_keys.find(cell);
+    if (keys_12 != index_12_keys.end()) {
+      for (auto &key : keys_12->second)
+        index_12_stale_keys.push_back(key);
+      index_12_keys.erase(keys_12);
+    }
+    changed_cells.erase(cell);
+    blacklist_cells.erase(cell);
+    autoremove_cells.erase(cell);
+    removed_cells.insert(cell);
+  }
+
+  void release_siguser(const SigSpec &sig, Cell *cell) {
+    for (auto bit : sigmap(sig)) {
+      auto users = sigusers.find(bit);
+      if (users != sigusers.end())
+        users->second.erase(cell);
+    }
+  }
+
+  // Removes the autoremove cells and re-indexes every cell that was created,
+  // reconnected, blacklisted or connected to a changed net since the last update().
+  void update() {
+    log_assert(tracking);
+    for (auto cell : blacklist_cells)
+      changed_cells.insert(cell);
+    blacklist_cells.clear();
+    pool<Cell*> cells;
+    cells.swap(autoremove_cells);
+    for (auto cell : cells)
+      module->remove(cell);
+
+    if (rebuild_needed) {
+      sigmap.set(module);
+      sigusers.clear();
+      index_1.clear();
+      index_1_keys.clear();
+      index_1_stale_keys.clear();
+      index_4.clear();
+      index_4_keys.clear();
+      index_4_stale_keys.clear();
+      index_5.clear();
+      index_5_keys.clear();
+      index_5_stale_keys.clear();
+      index_12.clear();
+      index_12_keys.clear();
+      index_12_stale_keys.clear();
+      init_sigusers();
+      for (auto cell : module->cells())
+        if (!track_filter || track_filter(cell))
+          index_cell(cell);
+    } else {
+      for (auto &it : released_sigs)
+        release_siguser(it.second, it.first);
+      for (auto &conn : connected_sigs)
+        for (int i = 0; i < GetSize(conn.first); i++) {
+          SigBit a = sigmap(conn.first[i]), b = sigmap(conn.second[i]);
+          if (a == b) continue;
+          sigmap.add(conn.first[i], conn.second[i]);
+          SigBit rep = sigmap(a);
+          for (auto bit : {a, b}) {
+            auto users_it = sigusers.find(bit);
+            if (bit == rep || users_it == sigusers.end()) continue;
+            pool<Cell*> users;
+            users.swap(users_it->second);
+            sigusers.erase(users_it);
+            for (auto user : users) {
+              if (rep.wire != nullptr)
+                sigusers[rep].insert(user);
+              if (user != nullptr)
+                changed_cells.insert(user);
+            }
+          }
+        }
+      for (auto cell : changed_cells)
+        for (auto &conn : cell->connections())
+          add_siguser(conn.second, cell);
+      // select and filter expressions may look at the number of users of a net
+      vector<Cell*> neighbours;
+      for (auto bit : sigmap(changed_sigs)) {
+        auto users = sigusers.find(bit);
+        if (users != sigusers.end())
+          for (auto user : users->second)
+            if (user != nullptr && !changed_cells.count(user))
+              neighbours.push_back(user);
+      }
+      for (auto cell : neighbours)
+        changed_cells.insert(cell);
+
+      {
+        pool<index_1_key_type> keys(index_1_stale_keys.begin(), index_1_stale_keys.end());
+        index_1_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_1_keys.find(cell);
+          if (cell_keys == index_1_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_1_keys.erase(cell_keys);
+        }
+        for (auto &key : keys) {
+          auto values = index_1.find(key);
+          if (values == index_1.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_1_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_1.erase(values);
+        }
+      }
+      {
+        pool<index_4_key_type> keys(index_4_stale_keys.begin(), index_4_stale_keys.end());
+        index_4_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_4_keys.find(cell);
+          if (cell_keys == index_4_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_4_keys.erase(cell_keys);
+        }
+        for (auto &key : keys) {
+          auto values = index_4.find(key);
+          if (values == index_4.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_4_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_4.erase(values);
+        }
+      }
+      {
+        pool<index_5_key_type> keys(index_5_stale_keys.begin(), index_5_stale_keys.end());
+        index_5_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_5_keys.find(cell);
+          if (cell_keys == index_5_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_5_keys.erase(cell_keys);
+        }
+        for (auto &key : keys) {
+          auto values = index_5.find(key);
+          if (values == index_5.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_5_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_5.erase(values);
         }
-      } while (0);
+      }
+      {
+        pool<index_12_key_type> keys(index_12_stale_keys.begin(), index_12_stale_keys.end());
+        index_12_stale_keys.clear();
+        for (auto cell : changed_cells) {
+          auto cell_keys = index_12_keys.find(cell);
+          if (cell_keys == index_12_keys.end()) continue;
+          keys.insert(cell_keys->second.begin(), cell_keys->second.end());
+          index_12_keys.erase(cell_keys);
+        }
+        for (auto &key : keys) {
+          auto values = index_12.find(key);
+          if (values == index_12.end()) continue;
+          auto &vec = values->second;
+          vec.erase(std::remove_if(vec.begin(), vec.end(), [&](const index_12_value_type &value) {
+            Cell *cell = std::get<0>(value);
+            return removed_cells.count(cell) || changed_cells.count(cell);
+          }), vec.end());
+          if (vec.empty())
+            index_12.erase(values);
+        }
+      }
+      for (auto cell : changed_cells)
+        if (!track_filter || track_filter(cell))
+          index_cell(cell);
     }
+
+    rebuild_needed = false;
+    changed_cells.clear();
+    removed_cells.clear();
+    released_sigs.clear();
+    connected_sigs.clear();
+    changed_sigs = SigSpec();
   }
 
   ~dsp_cascade_pm() {
+    if (tracking)
+      module->monitors.erase(&monitor);
     for (auto cell : autoremove_cells)
       module->remove(cell);
   }
@@ -267,7 +553,7 @@ struct dsp_cascade_pm {
   void block_subpattern_dsp_cascade_in_dffe(int recursion) { block_11(recursion); }
   void block_subpattern_dsp_cascade_tail(int recursion) { block_4(recursion); }
 
-  // techlibs/yosys-syn/SRC/Z1010/DSP/dsp_cascade.pmg:59
+  // techlibs/yosys-syn/ARCHITECTURE/Z1010/DSP/dsp_cascade.pmg:59
   void block_0(int recursion YS_MAYBE_UNUSED) {
     vector<std::tuple<Cell*,int,int,int>> &chain YS_MAYBE_UNUSED = ud_dsp_cascade.chain;
     Cell* &dff YS_MAYBE_UNUSED = ud_dsp_cascade.dff;
@@ -295,7 +581,7 @@ rollback_label:
     YS_MAYBE_UNUSED;
   }
 
-  // techlibs/yosys-syn/SRC/Z1010/DSP/dsp_cascade.pmg:66
+  // techlibs/yosys-syn/ARCHITECTURE/Z1010/DSP/dsp_cascade.pmg:66
   void block_1(int recursion YS_MAYBE_UNUSED) {
     Cell* &first YS_MAYBE_UNUSED = st_dsp_cascade.first;
     vector<std::tuple<Cell*,int,int,int>> &chain YS_MAYBE_UNUSED = ud_dsp_cascade.chain;
@@ -333,7 +619,7 @@ rollback_label:
     first = _pmg_backup_first;
   }
 
-  // techlibs/yosys-syn/SRC/Z1010/DSP/dsp_cascade.pmg:75
+  // techlibs/yosys-syn/ARCHITECTURE/Z1010/DSP/dsp_cascade.pmg:75
   void block_2(int recursion YS_MAYBE_UNUSED) {
     Cell* const &first YS_MAYBE_UNUSED = st_dsp_cascade.first;
     vector<std::tuple<Cell*,int,int,int>> &chain YS_MAYBE_UNUSED = ud_dsp_cascade.chain;
@@ -458,7 +744,7 @@ finish_label:
   void block_3(int recursion YS_MAYBE_UNUSED) {
   }
 
-  // techlibs/yosys-syn/SRC/Z1010/DSP/dsp_cascade.pmg:188
+  // techlibs/yosys-syn/ARCHITECTURE/Z1010/DSP/dsp_cascade.pmg:188
   void block_4(int recursion YS_MAYBE_UNUSED) {
     Cell* const &first YS_MAYBE_UNUSED = st_dsp_cascade.first;
     Cell* const &next YS_MAYBE_UNUSED = st_dsp_cascade.next;
@@ -502,7 +788,7 @@ finish_label:
     nextP = _pmg_backup_nextP;
   }
 
-  // techlibs/yosys-syn/SRC/Z1010/DSP/dsp_cascade.pmg:199
+  // techlibs/yosys-syn/ARCHITECTURE/Z1010/DSP/dsp_cascade.pmg:199
   void block_5(int recursion YS_MAYBE_UNUSED) {
     Cell* const &first YS_MAYBE_UNUSED = st_dsp_cascade.first;
     Cell* const &next YS_MAYBE_UNUSED = st_dsp_cascade.next;
@@ -554,7 +840,7 @@ finish_label:
     nextP_shift17 = _pmg_backup_nextP_shift17;
   }
 
-  // techlibs/yosys-syn/SRC/Z1010/DSP/dsp_cascade.pmg:210
+  // techlibs/yosys-syn/ARCHITECTURE/Z1010/DSP/dsp_cascade.pmg:210
   void block_6(int recursion YS_MAYBE_UNUSED) {
     Cell* const &first YS_MAYBE_UNUSED = st_dsp_cascade.first;
     Cell* const &nextP YS_MAYBE_UNUSED = st_dsp_cascade.nextP;
@@ -606,7 +892,7 @@ rollback_label:
     next = _pmg_backup_next;
   }
 
-  // techlibs/yosys-syn/SRC/Z1010/DSP/dsp_cascade.pmg:238
+  // techlibs/yosys-syn/ARCHITECTURE/Z1010/DSP/dsp_cascade.pmg:238
   void block_7(int recursion YS_MAYBE_UNUSED) {
     Cell* const &first YS_MAYBE_UNUSED = st_dsp_cascade.first;
     Cell* const &next YS_MAYBE_UNUSED = st_dsp_cascade.next;
@@ -680,7 +966,7 @@ rollback_label:
     clock = SigBit();
   }
 
-  // techlibs/yosys-syn/SRC/Z1010/DSP/dsp_cascade.pmg:279
+  // techlibs/yosys-syn/ARCHITECTURE/Z1010/DSP/dsp_cascade.pmg:279
   void block_8(int recursion YS_MAYBE_UNUSED) {
     const int &AREG YS_MAYBE_UNUSED = st_dsp_cascade.AREG;
     Cell* const &first YS_MAYBE_UNUSED = st_dsp_cascade.first;
@@ -767,7 +1053,7 @@ rollback_label:
     BREG = int();
   }
 
-  // techlibs/yosys-syn/SRC/Z1010/DSP/dsp_cascade.pmg:329
+  // techlibs/yosys-syn/ARCHITECTURE/Z1010/DSP/dsp_cascade.pmg:329
   void block_9(int recursion YS_MAYBE_UNUSED) {
     const int &AREG YS_MAYBE_UNUSED = st_dsp_cascade.AREG;
     const int &BREG YS_MAYBE_UNUSED = st_dsp_cascade.BREG;
@@ -830,7 +1116,7 @@ finish_label:
   void block_10(int recursion YS_MAYBE_UNUSED) {
   }
 
-  // techlibs/yosys-syn/SRC/Z1010/DSP/dsp_cascade.pmg:362
+  // techlibs/yosys-syn/ARCHITECTURE/Z1010/DSP/dsp_cascade.pmg:362
   void block_11(int recursion YS_MAYBE_UNUSED) {
     const SigSpec &argQ YS_MAYBE_UNUSED = st_dsp_cascade.argQ;
     const SigBit &clock YS_MAYBE_UNUSED = st_dsp_cascade.clock;
@@ -877,7 +1163,7 @@ rollback_label:
     YS_MAYBE_UNUSED;
   }
 
-  // techlibs/yosys-syn/SRC/Z1010/DSP/dsp_cascade.pmg:383
+  // techlibs/yosys-syn/ARCHITECTURE/Z1010/DSP/dsp_cascade.pmg:383
   void block_12(int recursion YS_MAYBE_UNUSED) {
     const SigSpec &argQ YS_MAYBE_UNUSED = st_dsp_cascade.argQ;
     const SigBit &clock YS_MAYBE_UNUSED = st_dsp_cascade.clock;
@@ -923,7 +1209,7 @@ rollback_label:
     ff = _pmg_backup_ff;
   }
 
-  // techlibs/yosys-syn/SRC/Z1010/DSP/dsp_cascade.pmg:401
+  // techlibs/yosys-syn/ARCHITECTURE/Z1010/DSP/dsp_cascade.pmg:401
   void block_13(int recursion YS_MAYBE_UNUSED) {
     const SigBit &clock YS_MAYBE_UNUSED = st_dsp_cascade.clock;
     Cell* const &ff YS_MAYBE_UNUSED = st_dsp_cascade.ff;
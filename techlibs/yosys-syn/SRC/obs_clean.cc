@@ -193,6 +193,7 @@ void observabilityClean(RTLIL::Module *module, SigMap &sigmap, dict<RTLIL::SigSp
 		}
 
 		module->connections_.clear();
+		module->invalidate_sigmap();
 		for (auto conn : newConnections) {
 			module->connect(conn);
 		}
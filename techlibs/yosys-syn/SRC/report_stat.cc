@@ -38,6 +38,11 @@ struct ReportStatPass : public ScriptPass
   string csv_stat_file;
   bool dot;
 
+  // Number of cells per type in the top module, collected in a single walk
+  // and shared by all the getNumberOf*() counters below.
+  //
+  dict<RTLIL::IdString, int> cellTypeCount;
+
   // Methods
   //
   ReportStatPass() : ScriptPass("report_stat", "Dump flattened netlist stats in file 'stat.csv'") { }
@@ -49,68 +54,68 @@ struct ReportStatPass : public ScriptPass
 
      int nb = 0;
 
-     for (auto cell : G_design->top_module()->cells()) {
+     for (auto &it : cellTypeCount) {
 
          // Generic Luts like for Zero Asic Z1000
          //
-         if (cell->type.in(ID($lut))) {
-             nb++;
+         if (it.first.in(ID($lut))) {
+             nb += it.second;
 	     continue;
          }
 
          // Xilinx 'xc4v' Luts
          //
-         if (cell->type.in(ID(LUT1), ID(LUT2), ID(LUT3), ID(LUT4), ID(INV))) {
-             nb++;
+         if (it.first.in(ID(LUT1), ID(LUT2), ID(LUT3), ID(LUT4), ID(INV))) {
+             nb += it.second;
 	     continue;
          }
 	 
          // Lattice 'Mach xo2' Luts
          //
-         if (cell->type.in(ID(LUT1), ID(LUT2), ID(LUT3), ID(LUT4))) {
-             nb++;
+         if (it.first.in(ID(LUT1), ID(LUT2), ID(LUT3), ID(LUT4))) {
+             nb += it.second;
 	     continue;
          }
 	 
          // ice40 'hx' Luts
          //
-         if (cell->type.in(ID(SB_LUT4))) {
-             nb++;
+         if (it.first.in(ID(SB_LUT4))) {
+             nb += it.second;
 	     continue;
          }
 	 
          // Quicklogic 'pp3' Luts
          //
-         if (cell->type.in(ID(LUT1), ID(LUT2), ID(LUT3), ID(LUT4))) {
-             nb++;
+         if (it.first.in(ID(LUT1), ID(LUT2), ID(LUT3), ID(LUT4))) {
+             nb += it.second;
 	     continue;
          }
 	 
          // Quicklogic 'pp3' mux4x0
          //
-         if (cell->type.in(ID(mux4x0))) {
-             nb += 3;  // equivalent to 3 LUT3 (Mux)
+         if (it.first.in(ID(mux4x0))) {
+             nb += 3 * it.second;  // equivalent to 3 LUT3 (Mux)
 	     continue;
          }
 	 
          // Quicklogic 'pp3' mux8x0
          //
-         if (cell->type.in(ID(mux8x0))) {
-             nb += 7;  // equivalent to 7 LUT3 (Mux)
+         if (it.first.in(ID(mux8x0))) {
+             nb += 7 * it.second;  // equivalent to 7 LUT3 (Mux)
 	     continue;
          }
 	 
          // Microchip 'polarfire' Luts
          //
-         if (cell->type.in(ID(CFG1), ID(CFG2), ID(CFG3), ID(CFG4))) {
-             nb++;
+         if (it.first.in(ID(CFG1), ID(CFG2), ID(CFG3), ID(CFG4))) {
+             nb += it.second;
 	     continue;
          }
 	 
          // Intel 'cycloneiv' Luts
          //
-         if (cell->type.in(ID($not), ID(cycloneiv_lcell_comb))) {
-             nb++;
+         if (it.first.in(ID($not), ID(cycloneiv_lcell_comb))) {
+             nb += it.second;
 	     continue;
          }
      }
@@ -125,59 +130,59 @@ struct ReportStatPass : public ScriptPass
 
     int nb = 0;
 
-    for (auto cell : G_design->top_module()->cells()) {
+    for (auto &it : cellTypeCount) {
 
         // Zero Asic Z1000 DFFs
         //
-        if (cell->type.in(ID(dff), ID(dffe), ID(dffr), ID(dffer),
+        if (it.first.in(ID(dff), ID(dffe), ID(dffr), ID(dffer),
                           ID(dffs), ID(dffrs), ID(dffes), ID(dffers))) {
-             nb++;
+             nb += it.second;
 	     continue;
         }
 
         // Xilinx 'xc4v' DFFs
         //
-        if (cell->type.in(ID(FDCE), ID(FDPE), ID(FDRE), ID(FDRE_1),
+        if (it.first.in(ID(FDCE), ID(FDPE), ID(FDRE), ID(FDRE_1),
                           ID(FDSE),
 			  ID(LDCE))) { // LATCH !!!
-             nb++;
+             nb += it.second;
 	     continue;
         }
 	
         // Lattice 'Mach ox2' DFFs
         //
-        if (cell->type.in(ID(TRELLIS_FF))) {
-             nb++;
+        if (it.first.in(ID(TRELLIS_FF))) {
+             nb += it.second;
 	     continue;
         }
 	
         // ice40 'hx' DFFs
         //
-        if (cell->type.in(ID(SB_DFF), ID(SB_DFFE), ID(SB_DFFER), ID(SB_DFFESR), 
+        if (it.first.in(ID(SB_DFF), ID(SB_DFFE), ID(SB_DFFER), ID(SB_DFFESR), 
                           ID(SB_DFFESS), ID(SB_DFFN), ID(SB_DFFR), ID(SB_DFFS), 
 			  ID(SB_DFFSR), ID(SB_DFFES))) {
-            nb++;
+            nb += it.second;
             continue;
         }
 	
         // Quicklogic 'pp3' DFFs
         //
-        if (cell->type.in(ID(dffepc))) { 
-            nb++;
+        if (it.first.in(ID(dffepc))) { 
+            nb += it.second;
             continue;
         }
 	
         // Microchip 'polarfire' Luts
         //
-        if (cell->type.in(ID(SLE))) {
-            nb++;
+        if (it.first.in(ID(SLE))) {
+            nb += it.second;
 	    continue;
         }
 
         // Intel 'cycloneiv' DFFs
         //
-        if (cell->type.in(ID(dffeas))) { 
-            nb++;
+        if (it.first.in(ID(dffeas))) { 
+            nb += it.second;
             continue;
         }
     }
@@ -193,26 +198,26 @@ struct ReportStatPass : public ScriptPass
 
     int nb = 0;
 
-    for (auto cell : G_design->top_module()->cells()) {
+    for (auto &it : cellTypeCount) {
 
 	// Xilinx xc4v
 	//
-        if (cell->type.in(ID(DSP48))) {
-             nb++;
+        if (it.first.in(ID(DSP48))) {
+             nb += it.second;
              continue;
         }
 	
 	// Xilinx xc5v
 	//
-        if (cell->type.in(ID(DSP48E))) {
-             nb++;
+        if (it.first.in(ID(DSP48E))) {
+             nb += it.second;
              continue;
         }
 
 	// Ice40
 	//
-        if (cell->type.in(ID(SB_MAC16))) {
-             nb++;
+        if (it.first.in(ID(SB_MAC16))) {
+             nb += it.second;
              continue;
         }
     }
@@ -227,40 +232,40 @@ struct ReportStatPass : public ScriptPass
 
     int nb = 0;
 
-    for (auto cell : G_design->top_module()->cells()) {
+    for (auto &it : cellTypeCount) {
 
         // Xilinx xc4v
         //
-        if (cell->type.in(ID(RAMB16))) {
-             nb++;
+        if (it.first.in(ID(RAMB16))) {
+             nb += it.second;
              continue;
         }
 
         // Ice40
         //
-        if (cell->type.in(ID(SB_RAM40_4K))) {
-             nb++;
+        if (it.first.in(ID(SB_RAM40_4K))) {
+             nb += it.second;
              continue;
         }
 	
         // Lattice xo2
         //
-        if (cell->type.in(ID(DP8KC))) {
-             nb++;
+        if (it.first.in(ID(DP8KC))) {
+             nb += it.second;
              continue;
         }
 	
         // Intel cycloneiv
         //
-        if (cell->type.in(ID(altsyncram))) {
-             nb++;
+        if (it.first.in(ID(altsyncram))) {
+             nb += it.second;
              continue;
         }
 	
         // Microchip polarfire
         //
-        if (cell->type.in(ID(RAM1K20))) {
-             nb++;
+        if (it.first.in(ID(RAM1K20))) {
+             nb += it.second;
              continue;
         }
     }
@@ -348,6 +353,10 @@ struct ReportStatPass : public ScriptPass
 
     string topName = log_id(topModule->name);
 
+    cellTypeCount.clear();
+    for (auto cell : topModule->cells())
+        cellTypeCount[cell->type]++;
+
     int nbLuts = getNumberOfLuts();
 
     int nbDffs = getNumberOfDffs();
@@ -0,0 +1,35 @@
+// Runs the design in bench_parallel_eval.v for a number of clock cycles and
+// prints the simulation speed and a checksum of the outputs, which must be the
+// same for the single-threaded and the parallel build.
+// The generated design is included with `-include` when compiling.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+
+int main(int argc, char **argv)
+{
+    long cycles = argc > 1 ? atol(argv[1]) : 100000;
+#ifdef CXXRTL_THREADS_H
+    if (argc > 2)
+        cxxrtl::worker_pool::shared().resize(atoi(argv[2]));
+#endif
+
+    cxxrtl_design::p_top top;
+
+    uint64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long cycle = 0; cycle < cycles; cycle++) {
+        top.p_in.set<uint64_t>(cycle * 0x9e3779b97f4a7c15ull);
+        top.p_clk.set(false);
+        top.step();
+        top.p_clk.set(true);
+        top.step();
+        checksum ^= top.p_out__first.get<uint64_t>() + top.p_out__last.get<uint64_t>();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    printf("%.0f cycles/s, checksum %016llx\n", cycles / elapsed.count(), (unsigned long long)checksum);
+    return 0;
+}
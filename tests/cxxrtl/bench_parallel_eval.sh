@@ -0,0 +1,27 @@
+#!/bin/bash
+#
+# Compares the simulation speed of a design made of independent blocks when it
+# is built with `write_cxxrtl -O6` and with `write_cxxrtl -O6 -parallel`. This
+# is a benchmark and not a part of `make test`.
+#
+# usage: ./bench_parallel_eval.sh [lanes [rounds [cycles [threads]]]]
+#
+# The parallel build uses one worker per CPU unless `threads` (the number of
+# worker threads, not counting the thread that runs the simulation) is given.
+
+set -e
+
+lanes=${1:-8}
+rounds=${2:-64}
+cycles=${3:-100000}
+threads=$4
+
+../../yosys -q -p "read_verilog bench_parallel_eval.v; hierarchy -top top -chparam LANES $lanes -chparam ROUNDS $rounds; write_cxxrtl -O6 cxxrtl-bench-parallel_eval-single.cc"
+../../yosys -q -p "read_verilog bench_parallel_eval.v; hierarchy -top top -chparam LANES $lanes -chparam ROUNDS $rounds; write_cxxrtl -O6 -parallel 1 cxxrtl-bench-parallel_eval-parallel.cc"
+for variant in single parallel; do
+    ${CC:-gcc} -std=c++11 -O3 -pthread -o cxxrtl-bench-parallel_eval-${variant} -I../../backends/cxxrtl/runtime -include cxxrtl-bench-parallel_eval-${variant}.cc bench_parallel_eval.cc -lstdc++
+done
+
+echo "$lanes lanes of $rounds rounds, $cycles cycles:"
+echo "  -O6:             $(./cxxrtl-bench-parallel_eval-single $cycles)"
+echo "  -O6 -parallel 1: $(./cxxrtl-bench-parallel_eval-parallel $cycles $threads)"
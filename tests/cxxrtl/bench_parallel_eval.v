@@ -0,0 +1,55 @@
+// A design made of LANES independent blocks, each with a deep combinational
+// datapath, used by bench_parallel_eval.sh.
+
+module lane #(
+    parameter [63:0] SEED = 1,
+    parameter ROUNDS = 64
+) (
+    input             clk,
+    input      [63:0] in,
+    output reg [63:0] out
+);
+    // Nothing reads the state of most lanes; keep it from being removed.
+    (* keep *)
+    reg [63:0] state = SEED;
+
+    wire [63:0] mix [0:ROUNDS];
+    assign mix[0] = state ^ in;
+
+    genvar i;
+    generate
+        for (i = 0; i < ROUNDS; i = i + 1) begin : round
+            assign mix[i + 1] = (mix[i] ^ (mix[i] >> 31)) * 64'hbf58476d1ce4e5b9 + i;
+        end
+    endgenerate
+
+    always @(posedge clk) begin
+        state <= mix[ROUNDS];
+        out <= state;
+    end
+endmodule
+
+module top #(
+    parameter LANES = 8,
+    parameter ROUNDS = 64
+) (
+    input         clk,
+    input  [63:0] in,
+    output [63:0] out_first,
+    output [63:0] out_last
+);
+    genvar i;
+    generate
+        for (i = 0; i < LANES; i = i + 1) begin : lanes
+            wire [63:0] out;
+            lane #(.SEED(i + 1), .ROUNDS(ROUNDS)) u_lane (
+                .clk (clk),
+                .in  (in),
+                .out (out)
+            );
+        end
+    endgenerate
+
+    assign out_first = lanes[0].out;
+    assign out_last  = lanes[LANES - 1].out;
+endmodule
@@ -15,3 +15,12 @@ run_subtest value_fuzz
 # Compile-only test.
 ../../yosys -p "read_verilog test_unconnected_output.v; select =*; proc; clean; write_cxxrtl cxxrtl-test-unconnected_output.cc"
 ${CC:-gcc} -std=c++11 -c -o cxxrtl-test-unconnected_output -I../../backends/cxxrtl/runtime cxxrtl-test-unconnected_output.cc
+
+# -parallel must not change the behavior of the design.
+../../yosys -p "read_rtlil test_parallel_eval.il; write_cxxrtl cxxrtl-test-parallel_eval-single.cc"
+../../yosys -p "read_rtlil test_parallel_eval.il; logger -expect log \"evaluates 6 independent regions in 4 parallel tasks\" 1; write_cxxrtl -parallel 4 cxxrtl-test-parallel_eval-parallel.cc"
+for variant in single parallel; do
+    ${CC:-gcc} -std=c++11 -O1 -pthread -o cxxrtl-test-parallel_eval-${variant} -I../../backends/cxxrtl/runtime -include cxxrtl-test-parallel_eval-${variant}.cc test_parallel_eval.cc -lstdc++
+    ./cxxrtl-test-parallel_eval-${variant} > cxxrtl-test-parallel_eval-${variant}.out
+done
+cmp cxxrtl-test-parallel_eval-single.out cxxrtl-test-parallel_eval-parallel.out
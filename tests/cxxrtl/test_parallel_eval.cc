@@ -0,0 +1,33 @@
+// Drives the design in test_parallel_eval.il with a fixed pseudo-random sequence
+// and prints its outputs after every clock cycle, so that the outputs of the
+// builds with and without `write_cxxrtl -parallel` can be compared.
+// The generated design is included with `-include` when compiling.
+
+#include <cstdio>
+#include <cstdint>
+
+int main()
+{
+#ifdef CXXRTL_THREADS_H
+    // Use several workers even on a machine with a single CPU.
+    cxxrtl::worker_pool::shared().resize(3);
+#endif
+
+    cxxrtl_design::p_top top;
+
+    uint32_t state = 1;
+    for (int cycle = 0; cycle < 1000; cycle++) {
+        state = state * 1103515245 + 12345;
+        top.p_a.set<uint8_t>(state >> 8);
+        top.p_b.set<uint8_t>(state >> 16);
+        top.p_clk.set(false);
+        top.step();
+        top.p_clk.set(true);
+        top.step();
+        printf("%02x %02x %02x %02x %02x %02x %02x\n",
+            top.p_o0.get<uint8_t>(), top.p_o1.get<uint8_t>(), top.p_o2.get<uint8_t>(),
+            top.p_o3.get<uint8_t>(), top.p_c.get<uint8_t>(),
+            top.p_s0.get<uint8_t>(), top.p_s1.get<uint8_t>());
+    }
+    return 0;
+}
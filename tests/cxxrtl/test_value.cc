@@ -50,6 +50,15 @@ int main()
         assert(val.template bmux<4>(sel).get<uint64_t>() == 0xfu);
     }
 
+    {
+        // mul of wide values should propagate carries across all chunks
+        cxxrtl::value<256> a(0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu);
+        cxxrtl::value<256> c = a.mul<256>(a);
+        assert(c == cxxrtl::value<256>(1u, 0u, 0u, 0u, 0xfffffffeu, 0xffffffffu, 0xffffffffu, 0xffffffffu));
+        cxxrtl::value<160> d = a.trunc<160>().mul<160>(a.trunc<160>());
+        assert(d == cxxrtl::value<160>(1u, 0u, 0u, 0u, 0xfffffffeu));
+    }
+
     {
         // stream operator smoke test
         cxxrtl::value<8> val(0x1fu);
@@ -229,6 +229,26 @@ struct SubTest : BinaryOperationBase
 	}
 } sub;
 
+struct MulTest : BinaryOperationBase 
+{
+	MulTest()
+	{
+		std::printf("Randomized tests for value::mul:\n");
+		test_binary_operation(*this);
+	}
+
+	uint64_t reference_impl(size_t bits, uint64_t a, uint64_t b)
+	{
+		return a * b;
+	}
+
+	template<size_t Bits>
+	cxxrtl::value<Bits> testing_impl(cxxrtl::value<Bits> a, cxxrtl::value<Bits> b)
+	{
+		return a.template mul<Bits>(b);
+	}
+} mul;
+
 struct CtlzTest
 {
 	CtlzTest()
@@ -0,0 +1,102 @@
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "my_module_functional_cxx.cc"
+
+// Checks that the batched eval() of `write_functional_cxx -batch` agrees with the scalar eval() in every lane.
+
+template <size_t n> Signal<n> random_signal(std::mt19937 &gen)
+{
+	std::uniform_int_distribution<uint32_t> dist;
+	std::array<uint32_t, (n + 31) / 32> words;
+	for (auto &w : words)
+		w = dist(gen);
+	return Signal<n>::from_array(words);
+}
+
+struct Randomize {
+	std::mt19937 &gen;
+	Randomize(std::mt19937 &gen) : gen(gen) {}
+
+	template <size_t n> void operator()(const char *, Signal<n> &signal) { signal = random_signal<n>(gen); }
+};
+
+// Calls `fn` with each pair of fields of the same name in a batched and a scalar struct.
+template<typename Batch, typename Scalar, typename Fn> void zip(Batch &batch, Scalar &scalar, Fn &&fn)
+{
+	batch.visit([&](const char *batch_name, auto &batch_field) {
+		scalar.visit([&](const char *scalar_name, auto &scalar_field) {
+			if (!strcmp(batch_name, scalar_name))
+				fn(batch_name, batch_field, scalar_field);
+		});
+	});
+}
+
+struct SetLane {
+	size_t lane;
+	template <size_t n> void operator()(const char *, BatchSignal<n> &batch, Signal<n> &scalar) { batch.set_lane(lane, scalar); }
+	template <typename Batch, typename Scalar> void operator()(const char *, Batch &, Scalar &) {}
+};
+
+struct CheckLane {
+	size_t lane;
+	int step;
+	bool &ok;
+	template <size_t n> void operator()(const char *name, BatchSignal<n> &batch, Signal<n> &scalar)
+	{
+		if (batch.lane(lane) != scalar) {
+			std::cerr << "Mismatch in `" << name << "' of lane " << lane << " at step " << step << ": "
+			          << batch.lane(lane) << " != " << scalar << "\n";
+			ok = false;
+		}
+	}
+	template <typename Batch, typename Scalar> void operator()(const char *, Batch &, Scalar &) {}
+};
+
+int main(int argc, char **argv)
+{
+	if (argc != 3) {
+		std::cerr << "Usage: " << argv[0] << " <steps> <seed>\n";
+		return 1;
+	}
+
+	const int steps = atoi(argv[1]);
+	const uint32_t seed = atoi(argv[2]);
+
+	std::vector<gold::Inputs> inputs(batch_lanes);
+	std::vector<gold::Outputs> outputs(batch_lanes);
+	std::vector<gold::State> state(batch_lanes);
+	std::vector<gold::State> next_state(batch_lanes);
+	gold::BatchInputs batch_inputs;
+	gold::BatchOutputs batch_outputs;
+	gold::BatchState batch_state;
+	gold::BatchState batch_next_state;
+
+	std::mt19937 gen(seed);
+
+	for (auto &lane_state : state)
+		gold::initialize(lane_state);
+	gold::initialize(batch_state);
+
+	bool ok = true;
+	for (int step = 0; step < steps && ok; ++step) {
+		for (size_t lane = 0; lane < batch_lanes; lane++) {
+			inputs[lane].visit(Randomize(gen));
+			zip(batch_inputs, inputs[lane], SetLane{lane});
+			gold::eval(inputs[lane], outputs[lane], state[lane], next_state[lane]);
+		}
+		gold::eval(batch_inputs, batch_outputs, batch_state, batch_next_state);
+
+		for (size_t lane = 0; lane < batch_lanes; lane++) {
+			zip(batch_outputs, outputs[lane], CheckLane{lane, step, ok});
+			zip(batch_next_state, next_state[lane], CheckLane{lane, step, ok});
+			state[lane] = next_state[lane];
+		}
+		batch_state = batch_next_state;
+	}
+
+	return ok ? 0 : 1;
+}
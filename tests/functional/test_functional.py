@@ -55,6 +55,18 @@ def test_cxx(cell, parameters, tmp_path, num_steps, rnd):
     run([str(vcdharness_exe_file.resolve()), str(vcd_functional_file), str(num_steps), str(seed)])
     yosys_sim(rtlil_file, vcd_functional_file, vcd_yosys_sim_file, getattr(cell, 'sim_preprocessing', ''))
 
+def test_cxx_batch(cell, parameters, tmp_path, num_steps, rnd):
+    rtlil_file = tmp_path / 'rtlil.il'
+    batchharness_cc_file = base_path / 'tests/functional/batch_harness.cc'
+    cc_file = tmp_path / 'my_module_functional_cxx.cc'
+    batchharness_exe_file = tmp_path / 'a.out'
+
+    cell.write_rtlil_file(rtlil_file, parameters)
+    yosys(f"read_rtlil {quote(rtlil_file)} ; clk2fflogic ; write_functional_cxx -batch {quote(cc_file)}")
+    compile_cpp(batchharness_cc_file, batchharness_exe_file, ['-I', tmp_path, '-I', str(base_path / 'backends/functional/cxx_runtime')])
+    seed = str(rnd(cell.name + "-cxx-batch").getrandbits(32))
+    run([str(batchharness_exe_file.resolve()), str(num_steps), str(seed)])
+
 @pytest.mark.smt
 def test_smt(cell, parameters, tmp_path, num_steps, rnd):
     import smt_vcd
@@ -0,0 +1,62 @@
+#!/usr/bin/env bash
+
+fail() {
+	echo "$1" >&2
+	exit 1
+}
+
+mkdir -p temp
+
+runTest() {
+	desc="$1"
+	want="$2"
+	printf "$3" > temp/errors.il
+	echo "running '$desc'"
+	output=`../../yosys -q -p "read_rtlil temp/errors.il" 2>&1`
+	if [ $? -ne 1 ]; then
+		fail "exit code for '$desc' was not 1"
+	fi
+	if [ "$output" != "$want" ]; then
+		fail "output for '$desc' did not match: $output"
+	fi
+}
+
+runTest "unterminated module" \
+	"ERROR: Parser error in line 2: syntax error" \
+	'module \\m\n  wire \\a\n'
+
+runTest "unterminated cell" \
+	"ERROR: Parser error in line 4: syntax error" \
+	'module \\m\n  wire \\a\n  cell $not \\n\n    connect \\A \\a\n'
+
+runTest "unterminated switch" \
+	"ERROR: Parser error in line 5: syntax error" \
+	"module \\\\m\n  wire \\\\a\n  process \\\\p\n    switch \\\\a\n      case 1'1\n"
+
+runTest "unterminated string" \
+	"ERROR: Parser error in line 2: unterminated string" \
+	'module \\m\n  attribute \\s "abc\n  wire \\a\nend\n'
+
+runTest "duplicate module" \
+	"ERROR: Parser error in line 4: RTLIL error: redefinition of module \\m." \
+	'module \\m\nend\n\nmodule \\m\nend\n'
+
+runTest "duplicate wire" \
+	"ERROR: Parser error in line 3: RTLIL error: redefinition of wire \\a." \
+	'module \\m\n  wire \\a\n  wire width 2 \\a\nend\n'
+
+runTest "unexpected token" \
+	"ERROR: Parser error in line 3: syntax error" \
+	'module \\m\n  wire \\a\n  bogus \\a\nend\n'
+
+runTest "missing connect rhs" \
+	"ERROR: Parser error in line 3: syntax error" \
+	'module \\m\n  wire \\a\n  connect \\a\nend\n'
+
+runTest "unknown wire after blank lines" \
+	"ERROR: Parser error in line 6: RTLIL error: wire \\b not found" \
+	'module \\m\n\n  # comment\n\n  wire \\a\n  connect \\a \\b\nend\n'
+
+runTest "dangling attribute" \
+	"ERROR: Parser error in line 3: dangling attribute" \
+	'module \\m\n  attribute \\x 1\nend\n'
@@ -0,0 +1,91 @@
+#!/usr/bin/env bash
+set -ex
+mkdir -p temp
+
+cat > temp/tracefile.il <<'EOT'
+module \top
+  wire input 1 \a
+  wire input 2 \b
+  wire output 3 \y
+  wire \x1
+  wire \x2
+  cell $and \g1
+    parameter \A_SIGNED 0
+    parameter \A_WIDTH 1
+    parameter \B_SIGNED 0
+    parameter \B_WIDTH 1
+    parameter \Y_WIDTH 1
+    connect \A \a
+    connect \B \b
+    connect \Y \x1
+  end
+  cell $and \g2
+    parameter \A_SIGNED 0
+    parameter \A_WIDTH 1
+    parameter \B_SIGNED 0
+    parameter \B_WIDTH 1
+    parameter \Y_WIDTH 1
+    connect \A \a
+    connect \B \b
+    connect \Y \x2
+  end
+  cell $or \g3
+    parameter \A_SIGNED 0
+    parameter \A_WIDTH 1
+    parameter \B_SIGNED 0
+    parameter \B_WIDTH 1
+    parameter \Y_WIDTH 1
+    connect \A \x1
+    connect \B \x2
+    connect \Y \y
+  end
+end
+EOT
+
+rm -f temp/tracefile.json
+../../yosys -q --tracefile temp/tracefile.json -p "read_rtlil temp/tracefile.il; opt; opt_clean"
+
+# the trace must be valid Chrome trace JSON whose spans nest properly, with
+# per-module spans inside the pass that opened them
+python3 - temp/tracefile.json <<'EOT'
+import json, sys
+
+with open(sys.argv[1]) as f:
+    trace = json.load(f)
+
+events = trace["traceEvents"]
+assert events, "no trace events"
+for event in events:
+    assert event["ph"] == "X", event
+    assert event["dur"] >= 0, event
+    for key in ("name", "cat", "ts", "pid", "tid", "args"):
+        assert key in event, (key, event)
+
+# spans are written when they end, so a span comes after all the spans
+# nested in it, and any two spans are either disjoint or nested
+eps = 1e-3
+def end(e):
+    return e["ts"] + e["dur"]
+def contains(p, c):
+    return p["ts"] <= c["ts"] + eps and end(c) <= end(p) + eps
+
+parents = {}
+for i, event in enumerate(events):
+    for j, other in enumerate(events[i+1:], i+1):
+        assert end(event) <= other["ts"] + eps or end(other) <= event["ts"] + eps or \
+                contains(event, other) or contains(other, event), (event, other)
+        if id(event) not in parents and contains(other, event):
+            parents[id(event)] = other
+
+def find(name, cat):
+    return [e for e in events if e["name"] == name and e["cat"] == cat]
+
+assert len(find("opt", "pass")) == 1
+assert len(find("opt_clean", "pass")) >= 2
+for span in find("opt_expr", "module"):
+    assert span["args"]["module"] == "top", span
+    parent = parents[id(span)]
+    assert (parent["name"], parent["cat"]) == ("opt_expr", "pass"), parent
+    assert (parents[id(parent)]["name"], parents[id(parent)]["cat"]) == ("opt", "pass")
+assert find("opt_expr", "module")
+EOT
@@ -0,0 +1,31 @@
+#!/usr/bin/env bash
+set -ex
+
+# the comparison needs yosys-smtbmc and its default solver, which are not always installed
+if [ ! -x ../../yosys-smtbmc ] || ! command -v yices-smt2 > /dev/null; then
+	echo "yosys-smtbmc or yices-smt2 not found, skipping"
+	exit 0
+fi
+
+mkdir -p temp
+
+# each property must prove or fail the same way with and without -coi
+check() {
+	prop=$1
+	expect=$2
+	for coi in "" "-coi"; do
+		smt2=temp/write_coi_$prop$coi.smt2
+		../../yosys -q -p "read_rtlil write_coi.il; delete t:\$assert c:$prop %d; write_smt2 $coi $smt2"
+		if ../../yosys-smtbmc -t 5 $smt2 && ../../yosys-smtbmc -i -t 5 $smt2; then
+			result=pass
+		else
+			result=fail
+		fi
+		test $result = $expect
+	done
+}
+
+check holds pass
+check fails fail
+check anyseq_differ fail
+check anyconst_differ fail